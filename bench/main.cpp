@@ -0,0 +1,424 @@
+#include "CXMF.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+// Synthetic models are written to a temporary directory, each case is timed as the best of several runs
+
+constexpr inline uint32_t LOAD_RUNS = 5;
+constexpr inline uint32_t LOAD_VERTEX_COUNT = 5'000'000;
+constexpr inline uint32_t LOAD_MESH_VERTICES = 65'536;
+constexpr inline uint32_t LOAD_BONE_COUNT = 64;
+constexpr inline uint32_t IMPORT_RUNS = 3;
+constexpr inline uint32_t IMPORT_NODE_COUNT = 200'000;
+constexpr inline uint32_t IMPORT_STEPS = 4;	 // Scenes of 1/8, 1/4, 1/2 and all of the nodes
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Deterministic noise, so deflate doesn't get unrealistically regular data
+static float noise(uint32_t& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+}
+
+
+
+// Load
+
+// Grid of meshes with 4 bone weights per vertex, one node per mesh
+static std::unique_ptr<cxmf::SkinnedModel> make_skinned_model(uint32_t vertexCount)
+{
+	std::unique_ptr<cxmf::SkinnedModel> model = std::make_unique<cxmf::SkinnedModel>();
+	model->generator = "cxmf_bench";
+	model->bounds = {{0.0F, 0.0F, 0.0F}, 1024.0F};
+
+	for (uint32_t i = 0; i < LOAD_BONE_COUNT; ++i)
+	{
+		cxmf::Bone& bone = model->bones.emplace_back();
+		bone.name = "bone_" + std::to_string(i);
+		bone.parentIndex = i == 0 ? cxmf::INVALID_INDEX : (i - 1) / 2;
+	}
+
+	uint32_t state = 1;
+	model->vertices.resize(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		cxmf::WeightedVertex& vertex = model->vertices[i];
+		vertex.position[0] = static_cast<float>(i % 1024) + noise(state) * 0.1F;
+		vertex.position[1] = static_cast<float>(i / 1024 % 1024) + noise(state) * 0.1F;
+		vertex.position[2] = noise(state);
+		vertex.normal[0] = 0.0F;
+		vertex.normal[1] = 0.0F;
+		vertex.normal[2] = 1.0F;
+		vertex.uv[0] = noise(state);
+		vertex.uv[1] = noise(state);
+		vertex.tangent[0] = 1.0F;
+		vertex.tangent[1] = 0.0F;
+		vertex.tangent[2] = 0.0F;
+
+		float sum = 0.0F;
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			vertex.boneID[k] = (i / 256 + k) % LOAD_BONE_COUNT;
+			vertex.weight[k] = noise(state) + 0.01F;
+			sum += vertex.weight[k];
+		}
+		for (float& weight : vertex.weight) weight /= sum;
+	}
+
+	for (uint32_t first = 0; first < vertexCount; first += LOAD_MESH_VERTICES)
+	{
+		const uint32_t meshIndex = static_cast<uint32_t>(model->meshes.size());
+		cxmf::Mesh& mesh = model->meshes.emplace_back();
+		mesh.name = "mesh_" + std::to_string(meshIndex);
+		mesh.bounds = model->bounds;
+		mesh.vertexOffset = first;
+		mesh.vertexCount = std::min(LOAD_MESH_VERTICES, vertexCount - first);
+		mesh.materialIndex = cxmf::INVALID_INDEX;
+
+		cxmf::MeshHierarchy& node = model->meshNodes.emplace_back();
+		node.name = mesh.name;
+		node.meshIndex = meshIndex;
+		node.parentIndex = cxmf::INVALID_INDEX;
+	}
+	return model;
+}
+
+// CXMF 1.0 layout, only read by the library: header, model type, zlib stream of the fields one after another
+class LegacyModelWriter
+{
+private:
+	std::vector<uint8_t> m_Payload;
+
+public:
+	void put(const void* data, size_t size)
+	{
+		const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+		m_Payload.insert(m_Payload.end(), bytes, bytes + size);
+	}
+
+	template <typename _Ty>
+	void value(const _Ty& value)
+	{
+		put(&value, sizeof(_Ty));
+	}
+
+	void length(std::string_view str)
+	{
+		value(static_cast<uint32_t>(str.size()));
+	}
+
+	void string(std::string_view str)
+	{
+		length(str);
+		put(str.data(), str.size());
+	}
+
+	bool save(const std::filesystem::path& path, cxmf::ModelType type, int compLevel) const
+	{
+		uLongf compressedSize = compressBound(static_cast<uLong>(m_Payload.size()));
+		std::vector<uint8_t> compressed(compressedSize);
+		if (compress2(compressed.data(), &compressedSize, m_Payload.data(), static_cast<uLong>(m_Payload.size()), compLevel) != Z_OK)
+			return false;
+
+		const uint32_t header[] = {
+			(static_cast<uint32_t>('F') << 24) | (static_cast<uint32_t>('M') << 16) | (static_cast<uint32_t>('X') << 8) |
+				static_cast<uint32_t>('C'),
+			1u << 24,  // Version 1.0.0
+			static_cast<uint32_t>(compressedSize),
+			static_cast<uint32_t>(m_Payload.size()),
+			0  // Flags
+		};
+		const uint8_t modelType = static_cast<uint8_t>(type);
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(&modelType), sizeof(modelType));
+		file.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressedSize));
+		return file.good();
+	}
+};
+
+static bool save_legacy_model(const cxmf::SkinnedModel& model, const std::filesystem::path& path, int compLevel)
+{
+	LegacyModelWriter writer;
+	writer.length(model.name);
+	writer.value(static_cast<uint32_t>(model.textures.size()));
+	writer.value(static_cast<uint32_t>(model.samplers.size()));
+	writer.value(static_cast<uint32_t>(model.materials.size()));
+	writer.value(static_cast<uint32_t>(model.meshes.size()));
+	writer.value(static_cast<uint32_t>(model.meshNodes.size()));
+	writer.value(static_cast<uint32_t>(0));	 // Meshlet vertices
+	writer.value(static_cast<uint32_t>(0));	 // Meshlet triangles
+	writer.value(static_cast<uint32_t>(0));	 // Meshlets
+	writer.length(model.copyright);
+	writer.length(model.generator);
+	writer.put(model.name.data(), model.name.size());
+
+	for (const cxmf::Mesh& mesh : model.meshes)
+	{
+		writer.string(mesh.name);
+		writer.value(mesh.bounds);
+		writer.value(static_cast<uint32_t>(mesh.vertexOffset));
+		writer.value(mesh.vertexCount);
+		writer.value(static_cast<uint32_t>(0));	 // Meshlet offset
+		writer.value(static_cast<uint32_t>(0));	 // Meshlet count
+		writer.value(mesh.materialIndex);
+	}
+	for (const cxmf::MeshHierarchy& node : model.meshNodes)
+	{
+		writer.string(node.name);
+		writer.value(node.localTransform);
+		writer.value(node.meshIndex);
+		writer.value(node.parentIndex);
+	}
+
+	writer.value(model.bounds);
+	writer.put(model.copyright.data(), model.copyright.size());
+	writer.put(model.generator.data(), model.generator.size());
+
+	writer.value(static_cast<uint32_t>(model.vertices.size()));
+	writer.value(static_cast<uint32_t>(model.bones.size()));
+	writer.put(model.vertices.data(), model.vertices.size() * sizeof(cxmf::WeightedVertex));
+	for (const cxmf::Bone& bone : model.bones)
+	{
+		writer.string(bone.name);
+		writer.value(bone.inverseBindTransform);
+		writer.value(bone.offsetMatrix);
+		writer.value(bone.parentIndex);
+	}
+	return writer.save(path, cxmf::ModelType::SKINNED, compLevel);
+}
+
+// Vertices per second of 'LoadFromFile' on the same skinned model saved in CXMF 1.0 and 1.1 layouts
+static bool bench_load(const std::filesystem::path& directory, uint32_t vertexCount)
+{
+	std::printf("Load: skinned model, %u vertices, best of %u runs\n", vertexCount, LOAD_RUNS);
+
+	const std::unique_ptr<cxmf::SkinnedModel> model = make_skinned_model(vertexCount);
+
+	struct Case
+	{
+		const char* name;
+		bool isLegacy;
+		int legacyLevel;
+		cxmf::CompressionLevel level;
+	};
+	const Case cases[] = {
+		{"1.0 stored", true, Z_NO_COMPRESSION, cxmf::CompressionLevel::NONE},
+		{"1.0 deflated", true, Z_DEFAULT_COMPRESSION, cxmf::CompressionLevel::NONE},
+		{"1.1 raw", false, 0, cxmf::CompressionLevel::NONE},
+		{"1.1 deflated", false, 0, cxmf::CompressionLevel::DEFAULT},
+	};
+
+	for (const Case& c : cases)
+	{
+		model->name = c.isLegacy ? "skinned_1_0" : "skinned_1_1";
+		const std::filesystem::path path = directory / (std::string(model->name) + ".cxmf");
+
+		const bool isSaved = c.isLegacy ? save_legacy_model(*model, path, c.legacyLevel)
+										: cxmf::SaveToFile(*model, directory.string().c_str(), c.level);
+		if (!isSaved)
+		{
+			std::printf("Can't save '%s'\n", path.string().c_str());
+			return false;
+		}
+
+		double best = 0.0;
+		for (uint32_t run = 0; run < LOAD_RUNS; ++run)
+		{
+			const Clock::time_point start = Clock::now();
+			const std::unique_ptr<cxmf::Model> loaded(cxmf::LoadFromFile(path.string().c_str()));
+			const double seconds = seconds_since(start);
+
+			const cxmf::SkinnedModel* const skinned = loaded ? loaded->SkinnedModelCast() : nullptr;
+			if (!skinned || skinned->vertices.size() != vertexCount)
+			{
+				std::printf("Can't load '%s'\n", path.string().c_str());
+				return false;
+			}
+			if (run == 0 || seconds < best) best = seconds;
+		}
+
+		std::printf("  %-14s %8.1f Mvertices/s  %8.3f s  %10.1f MB\n", c.name, vertexCount / best / 1e6, best,
+					static_cast<double>(std::filesystem::file_size(path)) / 1e6);
+	}
+	return true;
+}
+
+
+
+#ifdef CXMF_INCLUDE_IMPORTER
+
+// Import
+
+// One triangle with normals and UVs, indices are 16-bit
+constexpr inline float TRIANGLE_POSITIONS[] = {0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F};
+constexpr inline float TRIANGLE_NORMALS[] = {0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 1.0F};
+constexpr inline float TRIANGLE_UVS[] = {0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 1.0F};
+constexpr inline uint16_t TRIANGLE_INDICES[] = {0, 1, 2};
+
+// glTF scene of 'nodeCount' nodes in a 4-ary tree, each node has one of nodeCount/4 meshes over nodeCount/8 materials
+static bool save_synthetic_scene(const std::filesystem::path& path, uint32_t nodeCount)
+{
+	const uint32_t meshCount = std::max(nodeCount / 4, 1u);
+	const uint32_t materialCount = std::max(nodeCount / 8, 1u);
+
+	std::vector<uint8_t> buffer;
+	const auto append = [&buffer](const void* data, size_t size) {
+		const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	};
+	append(TRIANGLE_POSITIONS, sizeof(TRIANGLE_POSITIONS));
+	append(TRIANGLE_NORMALS, sizeof(TRIANGLE_NORMALS));
+	append(TRIANGLE_UVS, sizeof(TRIANGLE_UVS));
+	append(TRIANGLE_INDICES, sizeof(TRIANGLE_INDICES));
+	buffer.resize((buffer.size() + 3) & ~size_t(3));
+
+	std::filesystem::path bufferPath = path;
+	bufferPath.replace_extension(".bin");
+	std::ofstream bufferFile(bufferPath, std::ios::binary | std::ios::trunc);
+	bufferFile.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+	if (!bufferFile.good())	 //
+		return false;
+
+	std::string json;
+	json.reserve(static_cast<size_t>(nodeCount) * 96);
+	json += "{\"asset\":{\"version\":\"2.0\",\"generator\":\"cxmf_bench\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],";
+
+	json += "\"nodes\":[";
+	for (uint32_t i = 0; i < nodeCount; ++i)
+	{
+		if (i != 0) json += ',';
+		json += "{\"name\":\"node_" + std::to_string(i) + "\",\"mesh\":" + std::to_string(i % meshCount);
+		json += ",\"translation\":[" + std::to_string(i % 4) + ",1,0]";
+		if (i * 4 + 1 < nodeCount)
+		{
+			json += ",\"children\":[";
+			for (uint32_t child = i * 4 + 1; child <= i * 4 + 4 && child < nodeCount; ++child)
+			{
+				if (child != i * 4 + 1) json += ',';
+				json += std::to_string(child);
+			}
+			json += ']';
+		}
+		json += '}';
+	}
+	json += "],";
+
+	json += "\"meshes\":[";
+	for (uint32_t i = 0; i < meshCount; ++i)
+	{
+		if (i != 0) json += ',';
+		json += "{\"name\":\"mesh_" + std::to_string(i) + "\",\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},";
+		json += "\"indices\":3,\"material\":" + std::to_string(i % materialCount) + "}]}";
+	}
+	json += "],";
+
+	// Distinct base colors, so identical materials aren't merged by the importer
+	json += "\"materials\":[";
+	for (uint32_t i = 0; i < materialCount; ++i)
+	{
+		if (i != 0) json += ',';
+		json += "{\"name\":\"material_" + std::to_string(i) + "\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[";
+		json += std::to_string(static_cast<float>(i) / static_cast<float>(materialCount)) + ",0.5,0.5,1]}}";
+	}
+	json += "],";
+
+	json += "\"buffers\":[{\"uri\":\"" + bufferPath.filename().string() + "\",\"byteLength\":" + std::to_string(buffer.size()) + "}],";
+	json += "\"bufferViews\":["
+			"{\"buffer\":0,\"byteOffset\":0,\"byteLength\":36,\"target\":34962},"
+			"{\"buffer\":0,\"byteOffset\":36,\"byteLength\":36,\"target\":34962},"
+			"{\"buffer\":0,\"byteOffset\":72,\"byteLength\":24,\"target\":34962},"
+			"{\"buffer\":0,\"byteOffset\":96,\"byteLength\":6,\"target\":34963}],";
+	json += "\"accessors\":["
+			"{\"bufferView\":0,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\",\"min\":[0,0,0],\"max\":[1,1,0]},"
+			"{\"bufferView\":1,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\"},"
+			"{\"bufferView\":2,\"componentType\":5126,\"count\":3,\"type\":\"VEC2\"},"
+			"{\"bufferView\":3,\"componentType\":5123,\"count\":3,\"type\":\"SCALAR\"}]}";
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(json.data(), static_cast<std::streamsize>(json.size()));
+	return file.good();
+}
+
+// Import time of synthetic scenes up to 'nodeCount' nodes, doubling the node count at each step
+static bool bench_import(const std::filesystem::path& directory, uint32_t nodeCount)
+{
+	std::printf("Import: synthetic glTF scenes up to %u nodes, best of %u runs\n", nodeCount, IMPORT_RUNS);
+
+	for (uint32_t step = IMPORT_STEPS; step-- > 0;)
+	{
+		const uint32_t stepNodeCount = std::max(nodeCount >> step, 1u);
+		const std::filesystem::path path = directory / ("scene_" + std::to_string(stepNodeCount) + ".gltf");
+		if (!save_synthetic_scene(path, stepNodeCount))
+		{
+			std::printf("Can't save '%s'\n", path.string().c_str());
+			return false;
+		}
+
+		double best = 0.0;
+		for (uint32_t run = 0; run < IMPORT_RUNS; ++run)
+		{
+			const Clock::time_point start = Clock::now();
+			const std::unique_ptr<cxmf::Model> imported(cxmf::LoadFromFile(path.string().c_str()));
+			const double seconds = seconds_since(start);
+
+			if (!imported || imported->meshNodes.size() != stepNodeCount)
+			{
+				std::printf("Can't import '%s'\n", path.string().c_str());
+				return false;
+			}
+			if (run == 0 || seconds < best) best = seconds;
+		}
+
+		std::printf("  %8u nodes  %8.3f s  %8.2f us/node\n", stepNodeCount, best, best * 1e6 / stepNodeCount);
+	}
+	return true;
+}
+
+#endif
+
+
+
+/*
+	cxmf_bench [load [vertexCount] | import [nodeCount]]
+
+	Without arguments every benchmark is run with its default size.
+*/
+int main(int argc, char* argv[])
+{
+	const std::string_view benchmark = argc > 1 ? argv[1] : "";
+	const uint32_t size = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 0;
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "cxmf_bench";
+	std::filesystem::create_directories(directory);
+
+	bool result = true;
+	if (benchmark.empty() || benchmark == "load") result = bench_load(directory, size != 0 ? size : LOAD_VERTEX_COUNT) && result;
+#ifdef CXMF_INCLUDE_IMPORTER
+	if (benchmark.empty() || benchmark == "import") result = bench_import(directory, size != 0 ? size : IMPORT_NODE_COUNT) && result;
+#endif
+
+	std::filesystem::remove_all(directory);
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,6 +4,12 @@
 #include <cstddef>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <coroutine>
+#include <exception>
 
 
 
@@ -17,6 +23,7 @@ extern void DecodeVersion(uint32_t version, uint32_t& major, uint32_t& minor, ui
 CXMF_NODISCARD extern bool HasImporter();
 
 constexpr inline uint32_t INVALID_INDEX = 0xFFFFFFFFU;
+constexpr inline uint16_t INVALID_INDEX16 = 0xFFFFU;
 
 
 
@@ -72,15 +79,140 @@ struct WeightedVertex
 	float weight[4];	 // normalized
 };
 
+enum class VertexFormat : uint8_t
+{
+	FLOAT,	// 'Vertex' or 'WeightedVertex'
+	PACKED	// 'PackedVertex' or 'PackedWeightedVertex'
+};
+
+enum class VertexLayout : uint8_t
+{
+	INTERLEAVED,  // One array of whole vertices
+	STREAMS		  // Separate array per 'VertexStream', a pass can fetch only the streams it needs
+};
+
+// Element of a stream is the listed fields of the vertex of the vertex format, one after another
+enum class VertexStream : uint8_t
+{
+	POSITION,		 // 'position'
+	NORMAL_TANGENT,	 // 'normal', 'tangent'
+	UV,				 // 'uv'
+	BONE_WEIGHT		 // 'boneID', 'weight', only for 'ModelType::SKINNED'
+};
+
+/*
+	Compact vertex of 'VertexFormat::PACKED', the layout is ready for GPU vertex fetch:
+	- position is relative to the bounds of its mesh, 'position / 32767 * radius + center'
+	- normal and tangent are octahedral-encoded by 'meshopt_encodeFilterOct' with 8 bits,
+	  can be decoded in place with 'meshopt_decodeFilterOct'
+	- uv is half floats
+*/
+struct PackedVertex
+{
+	int16_t position[4];  // x, y, z as 16-bit snorm, w is 0
+	int8_t normal[4];	  // Octahedral x, y, 127, 0
+	uint16_t uv[2];		  // x, y
+	int8_t tangent[4];	  // Octahedral x, y, 127, 0
+};
+
+struct PackedWeightedVertex
+{
+	int16_t position[4];  // x, y, z as 16-bit snorm, w is 0
+	int8_t normal[4];	  // Octahedral x, y, 127, 0
+	uint16_t uv[2];		  // x, y
+	int8_t tangent[4];	  // Octahedral x, y, 127, 0
+	uint16_t boneID[4];	  // INVALID_INDEX16 if no bone
+	uint8_t weight[4];	  // 8-bit unorm
+};
+
+// Max deviation of the packed vertices of a mesh from the source ones
+struct QuantizationError
+{
+	float position;	 // Distance in model units
+	float normal;	 // Angle in radians
+	float tangent;	 // Angle in radians
+	float uv;		 // Absolute difference of the coordinates
+	float weight;	 // Absolute difference of the weights
+};
+
 struct Meshlet
 {
 	BoundingSphere bounds;
-	uint32_t vertexOffset;
-	uint32_t triangleOffset;
+	uint32_t vertexOffset;	  // Relative to 'Mesh::meshletVertexOffset' of its mesh
+	uint32_t triangleOffset;  // Relative to 'Mesh::meshletTriangleOffset' of its mesh
 	uint32_t vertexCount;
 	uint32_t triangleCount;
 };
 
+/*
+	Normal cone of a meshlet in 'Model::meshletCones', at the same index as the meshlet.
+	The meshlet faces away from a camera at 'position' when dot(normalize(apex - position), axis) >= cutoff,
+	or with an orthographic projection when dot(viewDirection, axis) >= cutoff.
+	Cones too wide to ever cull have 'cutoff' of 1.
+*/
+struct MeshletCone
+{
+	float apex[3];		 // x, y, z
+	float axis[3];		 // x, y, z, normalized
+	float cutoff;		 // Cosine of the half angle of the cone
+	int8_t axisS8[3];	 // 'axis' in 8-bit snorm, decode with x / 127
+	int8_t cutoffS8;	 // 'cutoff' in 8-bit snorm, rounded up so the quantized test stays conservative
+};
+
+// Simplified level of a mesh over the vertices of the mesh, see 'Mesh::lodOffset'
+struct MeshLod
+{
+	uint32_t meshletOffset;	 // In 'Model::meshlets', offsets of the meshlets are relative to the ranges of the mesh
+	uint32_t meshletCount;
+	float error;  // Deviation from the full-detail mesh in model units, project it to the screen to select the level
+};
+
+/*
+	Meshlet in the cluster hierarchy of a mesh, see 'Mesh::clusterOffset'.
+	A cut through the hierarchy draws the clusters whose own error is small enough on the screen while the error
+	of their parent group is not. Both errors grow up the hierarchy, so the cut is crack-free for any threshold.
+	Full-detail meshlets have no own group, their error is 0. The coarsest meshlets have no parent group.
+*/
+struct Cluster
+{
+	uint32_t meshletIndex;	// In 'Model::meshlets'
+	uint32_t group;			// Group in 'Model::clusterGroups' the meshlet was made from, INVALID_INDEX for full detail
+	uint32_t parentGroup;	// Group in 'Model::clusterGroups' the meshlet is simplified in, INVALID_INDEX for the coarsest
+};
+
+// Neighbouring meshlets simplified together with their outer border locked
+struct ClusterGroup
+{
+	BoundingSphere bounds;	// Contains the bounds of the groups and meshlets below it
+	float error;			// Of the meshlets made from the group in model units, not less than the errors below it
+};
+
+// Draw of a part of the index buffer of a mesh, see 'Mesh::indexBatchOffset'
+struct IndexBatch
+{
+	uint64_t indexOffset;  // First index of the triangle list in 'Model::indices' or 'Model::indices16'
+	uint32_t indexCount;
+	uint32_t baseVertex;  // Added to the indices, relative to 'Mesh::vertexOffset'
+};
+
+// Efficiency of the triangle list of a mesh, see meshopt_analyzeVertexCache, meshopt_analyzeVertexFetch, meshopt_analyzeOverdraw
+struct MeshQuality
+{
+	float acmr;		  // Transformed vertices per triangle with a 16-entry vertex cache, 0.5 at best, 3 at worst
+	float atvr;		  // Transformed vertices per vertex, 1 at best
+	float overfetch;  // Fetched bytes per byte of the vertex buffer, 1 at best
+	float overdraw;	  // Shaded pixels per covered pixel from all directions, 1 at best
+};
+
+// Quality of an imported mesh after each optimization stage, see 'LoadOptions::meshStatistics'
+struct MeshStatistics
+{
+	MeshQuality source;		  // After the identical vertices are merged
+	MeshQuality vertexCache;  // After meshopt_optimizeVertexCache
+	MeshQuality overdraw;	  // After meshopt_optimizeOverdraw, the same as 'vertexCache' without the pass
+	MeshQuality vertexFetch;  // After meshopt_optimizeVertexFetch and the split of 16-bit index batches, as stored
+};
+
 struct Sampler
 {
 	enum class Filter : int8_t
@@ -103,7 +235,7 @@ struct Sampler
 		CLAMP_TO_EDGE = 2,	  // VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
 	};
 
-	std::string name;
+	std::pmr::string name;
 	Filter magFilter;
 	Filter minFilter;
 	MipmapMode mipmapMode;
@@ -141,7 +273,7 @@ struct Texture
 			Green channel: Green factor
 			Blue channel: Blue factor
 	*/
-	std::string path;
+	std::pmr::string path;
 	uint32_t samplerIndex;
 
 	CXMF_NODISCARD bool HasPath() const
@@ -164,7 +296,7 @@ struct Material
 		BLEND = 2
 	};
 
-	std::string name;
+	std::pmr::string name;
 	float baseColorFactor[4];  // r, g, b, a
 	float roughnessFactor;
 	float metallicFactor;
@@ -182,15 +314,51 @@ struct Material
 	}
 };
 
+// Max size of the meshlets in a meshlet set, see 'Model::meshletSets'
+struct MeshletLimits
+{
+	uint32_t maxVertices;	// Up to 256
+	uint32_t maxTriangles;	// Up to 512, multiple of 4
+};
+
+// Meshlet data of a mesh in one meshlet set, the same ranges as in 'Mesh'
+struct MeshletRanges
+{
+	uint64_t meshletVertexOffset;
+	uint64_t meshletTriangleOffset;
+	uint32_t meshletOffset;
+	uint32_t meshletCount;
+	uint32_t lodOffset;
+	uint32_t lodCount;
+	uint32_t clusterOffset;
+	uint32_t clusterCount;
+	uint32_t clusterGroupOffset;
+	uint32_t clusterGroupCount;
+};
+
+// Meshes may share their vertex and meshlet ranges, e.g. the same geometry with different materials.
+// 'meshletOffset' and 'meshletCount' are the full-detail level, simplified levels follow in 'Model::meshLods'.
+// Meshlet ranges of the mesh are those of the first meshlet set, see 'Model::meshletSets'.
 struct Mesh
 {
-	std::string name;
+	std::pmr::string name;
 	BoundingSphere bounds;
-	uint32_t vertexOffset;
+	uint64_t vertexOffset;	// First vertex of the mesh, values of its meshlet vertices are relative to it
 	uint32_t vertexCount;
 	uint32_t meshletOffset;
 	uint32_t meshletCount;
 	uint32_t materialIndex;
+	uint64_t meshletVertexOffset;	 // First meshlet vertex of the mesh in 'Model::meshletVertices'
+	uint64_t meshletTriangleOffset;	 // First meshlet triangle index of the mesh in 'Model::meshletTriangles'
+	uint32_t lodOffset;				 // First simplified level of the mesh in 'Model::meshLods', from the finest
+	uint32_t lodCount;
+	uint32_t clusterOffset;	 // Cluster hierarchy of the mesh in 'Model::clusters', empty if not built
+	uint32_t clusterCount;
+	uint32_t clusterGroupOffset;  // Groups of the cluster hierarchy in 'Model::clusterGroups'
+	uint32_t clusterGroupCount;
+	uint32_t indexBatchOffset;	// Index buffer of the mesh in 'Model::indexBatches', empty if not kept
+	uint32_t indexBatchCount;
+	QuantizationError quantizationError;  // Zero unless the model is loaded from 'VertexFormat::PACKED'
 
 	CXMF_NODISCARD bool HasMaterial() const
 	{
@@ -200,7 +368,7 @@ struct Mesh
 
 struct MeshHierarchy
 {
-	std::string name;
+	std::pmr::string name;
 	Mat4x4 localTransform;
 	uint32_t meshIndex;
 	uint32_t parentIndex;
@@ -213,7 +381,116 @@ struct MeshHierarchy
 
 struct Bone
 {
-	std::string name;
+	std::pmr::string name;
+	Mat4x4 inverseBindTransform;
+	Mat4x4 offsetMatrix;
+	uint32_t parentIndex;
+
+	CXMF_NODISCARD bool HasParent() const
+	{
+		return parentIndex != INVALID_INDEX;
+	}
+};
+
+
+
+/*
+	Fixed-size records of the CXMF sections, they are stored in the file as is.
+	Strings are referenced by 'StringRef' into the string table of the model, identical strings share one entry.
+	Only 'ModelView::GetString' keeps that sharing in memory, loading a 'Model' copies each name into its own record.
+*/
+
+struct StringRef
+{
+	uint32_t id;  // Index of the string in the string table
+};
+
+struct TextureRecord
+{
+	StringRef path;
+	uint32_t samplerIndex;
+
+	CXMF_NODISCARD bool HasSampler() const
+	{
+		return samplerIndex != INVALID_INDEX;
+	}
+};
+
+struct SamplerRecord
+{
+	StringRef name;
+	Sampler::Filter magFilter;
+	Sampler::Filter minFilter;
+	Sampler::MipmapMode mipmapMode;
+	Sampler::AddressMode addressModeU;
+	Sampler::AddressMode addressModeV;
+	int8_t reserved[3];
+};
+
+struct MaterialRecord
+{
+	StringRef name;
+	float baseColorFactor[4];  // r, g, b, a
+	float roughnessFactor;
+	float metallicFactor;
+	float ambientOcclusionFactor;
+	float emissiveFactor[3];  // r, g, b
+	uint32_t textureIndex;
+	float alphaCutoff;
+	Material::AlphaMode alphaMode;
+	uint8_t doubleSided;  // 0 or 1, stored as a byte since any value may come from a file
+	uint8_t shadeless;	  // 0 or 1
+	int8_t reserved;
+
+	CXMF_NODISCARD bool HasTexture() const
+	{
+		return textureIndex != INVALID_INDEX;
+	}
+};
+
+struct MeshRecord
+{
+	StringRef name;
+	uint32_t vertexCount;
+	BoundingSphere bounds;
+	uint64_t vertexOffset;
+	uint64_t meshletVertexOffset;
+	uint64_t meshletTriangleOffset;
+	uint32_t meshletOffset;
+	uint32_t meshletCount;
+	uint32_t materialIndex;
+	uint32_t lodOffset;
+	uint32_t lodCount;
+	uint32_t clusterOffset;
+	uint32_t clusterCount;
+	uint32_t clusterGroupOffset;
+	uint32_t clusterGroupCount;
+	uint32_t indexBatchOffset;
+	uint32_t indexBatchCount;
+	uint32_t reserved;
+
+	CXMF_NODISCARD bool HasMaterial() const
+	{
+		return materialIndex != INVALID_INDEX;
+	}
+};
+
+struct MeshHierarchyRecord
+{
+	StringRef name;
+	Mat4x4 localTransform;
+	uint32_t meshIndex;
+	uint32_t parentIndex;
+
+	CXMF_NODISCARD bool HasParent() const
+	{
+		return parentIndex != INVALID_INDEX;
+	}
+};
+
+struct BoneRecord
+{
+	StringRef name;
 	Mat4x4 inverseBindTransform;
 	Mat4x4 offsetMatrix;
 	uint32_t parentIndex;
@@ -241,18 +518,32 @@ private:
 	const ModelType c_type;
 
 public:
-	std::string name;
-	std::vector<Texture> textures;
-	std::vector<Sampler> samplers;
-	std::vector<Material> materials;
-	std::vector<Mesh> meshes;
-	std::vector<MeshHierarchy> meshNodes;
-	std::vector<uint32_t> meshletVertices;
-	std::vector<uint8_t> meshletTriangles;
-	std::vector<Meshlet> meshlets;
+	// All arrays and strings use the memory resource of the model, strings of records added to the arrays
+	// keep their own allocator, assign to a record created with 'GetMemoryResource' to place them in it.
+	// Loaded names are copies of the string table, one per record even if the file stores the name once,
+	// names longer than the small string buffer allocate from the resource, see 'LoadOptions::memoryResource'
+	std::pmr::string name;
+	std::pmr::vector<Texture> textures;
+	std::pmr::vector<Sampler> samplers;
+	std::pmr::vector<Material> materials;
+	std::pmr::vector<Mesh> meshes;
+	std::pmr::vector<MeshHierarchy> meshNodes;
+	std::pmr::vector<uint32_t> meshletVertices;	 // Vertex indices local to the mesh, see 'Mesh::vertexOffset'
+	std::pmr::vector<uint8_t> meshletTriangles;
+	std::pmr::vector<Meshlet> meshlets;
+	std::pmr::vector<MeshletCone> meshletCones;	 // Empty or one per meshlet
+	std::pmr::vector<MeshLod> meshLods;
+	std::pmr::vector<Cluster> clusters;
+	std::pmr::vector<ClusterGroup> clusterGroups;
+	std::pmr::vector<MeshletLimits> meshletSets;  // Limits of the stored meshlet sets, empty if not recorded
+	std::pmr::vector<MeshletRanges> meshletSetRanges;	// Of each mesh in the sets after the first one, set by set
+	std::pmr::vector<uint32_t> indices;	 // Triangle lists of 'indexBatches', relative to the base vertex of the batch
+	std::pmr::vector<uint16_t> indices16;  // Used instead of 'indices' once every batch addresses at most 65535 vertices
+	std::pmr::vector<IndexBatch> indexBatches;
+	std::pmr::vector<MeshStatistics> meshStatistics;  // Empty or one per mesh
 	BoundingSphere bounds;
-	std::string copyright;
-	std::string generator;
+	std::pmr::string copyright;
+	std::pmr::string generator;
 	uint32_t flags;
 	uint32_t version;
 
@@ -260,7 +551,7 @@ public:
 	virtual ~Model() = default;
 
 protected:
-	Model(ModelType type);
+	Model(ModelType type, std::pmr::memory_resource* resource);
 
 public:
 	CXMF_NODISCARD ModelType GetType() const
@@ -268,6 +559,11 @@ public:
 		return c_type;
 	}
 
+	CXMF_NODISCARD std::pmr::memory_resource* GetMemoryResource() const
+	{
+		return name.get_allocator().resource();
+	}
+
 	CXMF_NODISCARD StaticModel* StaticModelCast();
 	CXMF_NODISCARD const StaticModel* StaticModelCast() const;
 
@@ -279,9 +575,10 @@ public:
 
 struct StaticModel final : public Model
 {
-	std::vector<Vertex> vertices;
+	std::pmr::vector<Vertex> vertices;
 
 	StaticModel();
+	explicit StaticModel(std::pmr::memory_resource* resource);
 	~StaticModel() override = default;
 };
 
@@ -289,15 +586,51 @@ struct StaticModel final : public Model
 
 struct SkinnedModel final : public Model
 {
-	std::vector<WeightedVertex> vertices;
-	std::vector<Bone> bones;
+	std::pmr::vector<WeightedVertex> vertices;
+	std::pmr::vector<Bone> bones;
 
 	SkinnedModel();
+	explicit SkinnedModel(std::pmr::memory_resource* resource);
 	~SkinnedModel() override = default;
 };
 
 
 
+// Model structure without geometry, see 'ProbeFile'
+struct ModelInfo
+{
+	ModelType type;
+	VertexFormat vertexFormat;
+	VertexLayout vertexLayout;
+	std::string name;
+	std::vector<Texture> textures;
+	std::vector<Sampler> samplers;
+	std::vector<Material> materials;
+	std::vector<Mesh> meshes;
+	std::vector<MeshHierarchy> meshNodes;
+	std::vector<Bone> bones;  // Empty for 'ModelType::STATIC'
+	std::vector<MeshLod> meshLods;
+	std::vector<Cluster> clusters;
+	std::vector<ClusterGroup> clusterGroups;
+	std::vector<MeshletLimits> meshletSets;
+	std::vector<MeshletRanges> meshletSetRanges;
+	std::vector<IndexBatch> indexBatches;
+	std::vector<MeshStatistics> meshStatistics;
+	BoundingSphere bounds;
+	std::string copyright;
+	std::string generator;
+	uint32_t flags;
+	uint32_t version;
+	uint64_t vertexCount;
+	uint64_t meshletCount;
+	uint64_t meshletVertexCount;
+	uint64_t meshletTriangleCount;	// Size of 'Model::meshletTriangles'
+	uint64_t indexCount;			// Size of 'Model::indices'
+	uint64_t indexCount16;			// Size of 'Model::indices16'
+};
+
+
+
 class Logger
 {
 public:
@@ -306,6 +639,35 @@ public:
 	virtual void write(const char* message) = 0;
 };
 
+// Sharing of identical geometry between imported meshes, nodes of the shared meshes reference one mesh
+enum class GeometryDeduplication : uint8_t
+{
+	NONE,	// Every imported mesh keeps its own geometry
+	EXACT,	// Meshes with identical vertices and indices share the vertices and meshlets of the first one
+	RIGID	// Like EXACT, also matches static geometry that differs by rotation and translation within a small tolerance,
+			// the difference is moved to the transform of the nodes
+};
+
+struct LoadOptions
+{
+	uint32_t threadCount = 0;							  // Threads used to decompress or import the model, 0 - all hardware threads
+	std::pmr::memory_resource* memoryResource = nullptr;  // Resource of all model arrays and strings, nullptr - default resource
+	const char* importCacheDirectory = nullptr;			  // Where imported .gltf/.glb models are kept in CXMF, nullptr - no cache
+	GeometryDeduplication geometryDeduplication = GeometryDeduplication::NONE;	// Of imported .gltf/.glb models
+	uint32_t lodCount = 0;		// Max simplified levels of each imported mesh, 0 - full detail only
+	float lodRatio = 0.5F;		// Target index count of a level relative to the previous one
+	float lodMaxError = 0.05F;	// Max simplification error relative to the mesh extent
+	bool clusterLod = false;	// Build the cluster hierarchy of each imported mesh for continuous level of detail
+	float meshletConeWeight = 0.0F;	 // 0..1, trades meshlet size for tighter normal cones of imported meshlets
+	std::span<const MeshletLimits> meshletSets;	 // Built for each imported mesh, empty - CXMF_MAX_MESHLET_VERTICES/TRIANGLES
+	MeshletLimits meshletLimits = {};			 // Keep only the largest meshlet set within the limits, zero field - no limit of it,
+												 // both zero - keep all sets, files without recorded sets are loaded unchanged
+	bool indexBuffers = false;	  // Keep the cache-optimized index buffer of each imported mesh
+	bool indexBuffers16 = false;  // Split index buffers of imported meshes in batches addressable with 16-bit indices
+	float overdrawThreshold = 0.0F;	 // Vertex cache degradation allowed to reduce overdraw of imported meshes, 0 - no overdraw pass
+	bool meshStatistics = false;	 // Record 'Model::meshStatistics' of imported meshes
+};
+
 /*
 	Load a model in glTF 2.0 or FBX format for import (required CXMF_INCLUDE_IMPORTER option)
 	or an already imported model in CXMF format.
@@ -317,6 +679,48 @@ public:
 */
 CXMF_NODISCARD extern Model* LoadFromFile(const char* filePath, Logger* logger = nullptr);
 
+/*
+	Load a model in glTF 2.0 or FBX format for import (required CXMF_INCLUDE_IMPORTER option)
+	or an already imported model in CXMF format.
+
+	With 'LoadOptions::importCacheDirectory' the import result is stored in the directory,
+	keyed by the content of the source file, the files it references and the importer settings.
+	Next imports of the same content are loaded from the stored CXMF model.
+
+	With 'LoadOptions::geometryDeduplication' meshes of different nodes with the same geometry are imported once.
+	Meshes that differ only by material get their own mesh record over the same vertices and meshlets.
+
+	With 'LoadOptions::lodCount' each imported mesh gets a chain of simplified levels over its vertices.
+	The chain ends early once a level can't be reduced within 'LoadOptions::lodMaxError'.
+
+	With 'LoadOptions::clusterLod' the full-detail meshlets of each imported mesh are grouped with their neighbours,
+	each group is simplified to about half and split into coarser meshlets, up to the meshlets that can't be reduced further.
+
+	Every imported meshlet gets its normal cone in 'Model::meshletCones'. Raising 'LoadOptions::meshletConeWeight'
+	makes meshlets follow the surface orientation, so more of them can be culled as back-facing.
+
+	With 'LoadOptions::meshletSets' the meshlets, levels and clusters of each imported mesh are built once per limits,
+	so one model serves hardware with different meshlet limits. With 'LoadOptions::meshletLimits' only the largest
+	stored set within the limits is kept, the meshes take its ranges. Loading fails if no stored set fits.
+
+	With 'LoadOptions::indexBuffers' each imported mesh keeps its index buffer for classic indexed draws,
+	in one batch per mesh. Adding 'LoadOptions::indexBuffers16' splits meshes over 65535 vertices in several batches,
+	each addressing at most 65535 vertices from its base vertex, vertices shared by the batches are duplicated.
+	The batches are then stored as 16-bit indices in 'Model::indices16', half the size of 'Model::indices'.
+
+	With 'LoadOptions::overdrawThreshold' triangles of each imported mesh are reordered front to back after the vertex cache
+	optimization, 1.05 lets the vertex cache efficiency drop by up to 5%. With 'LoadOptions::meshStatistics'
+	the efficiency of each imported mesh before and after every stage is kept in 'Model::meshStatistics',
+	so an asset pipeline can check it, also on later loads of the stored model.
+
+	@param filePath - path to .gltf/.cxmf model file
+	@param options - loading parameters
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::Model' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern Model* LoadFromFile(const char* filePath, const LoadOptions& options, Logger* logger = nullptr);
+
 
 
 /*
@@ -330,6 +734,81 @@ CXMF_NODISCARD extern Model* LoadFromFile(const char* filePath, Logger* logger =
 */
 CXMF_NODISCARD extern Model* LoadFromMemory(const void* data, size_t dataSize, Logger* logger = nullptr);
 
+/*
+	Load a CXMF model from memory buffer
+
+	@param data - buffer with content
+	@param dataSize - buffer size in bytes
+	@param options - loading parameters
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::Model' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern Model* LoadFromMemory(const void* data, size_t dataSize, const LoadOptions& options,
+											Logger* logger = nullptr);
+
+
+
+class InputStream
+{
+public:
+	virtual ~InputStream() = default;
+
+	// Return number of bytes read, may be fewer than requested, 0 at the end of the stream or on error
+	virtual size_t read(void* data, size_t sizeBytes) = 0;
+};
+
+/*
+	Load a CXMF model from input stream, content is decoded while it is read,
+	so only a small window of the stored model is resident at a time
+
+	@param stream - input stream positioned at the beginning of the model
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::Model' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern Model* LoadFromStream(InputStream& stream, Logger* logger = nullptr);
+
+/*
+	Load a CXMF model from input stream, content is decoded while it is read,
+	so only a small window of the stored model is resident at a time
+
+	@param stream - input stream positioned at the beginning of the model
+	@param options - loading parameters
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::Model' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern Model* LoadFromStream(InputStream& stream, const LoadOptions& options, Logger* logger = nullptr);
+
+
+
+/*
+	Read the structure of a CXMF model without decoding the geometry.
+	Models saved in CXMF 1.0 layout have no separate geometry, so they are loaded entirely.
+
+	@param filePath - path to .cxmf model file
+	@param info - receives the model structure
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return true if success
+*/
+CXMF_NODISCARD extern bool ProbeFile(const char* filePath, ModelInfo& info, Logger* logger = nullptr);
+
+
+
+/*
+	Read the structure of a CXMF model in memory buffer without decoding the geometry
+
+	@param data - buffer with content
+	@param dataSize - buffer size in bytes
+	@param info - receives the model structure
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return true if success
+*/
+CXMF_NODISCARD extern bool ProbeMemory(const void* data, size_t dataSize, ModelInfo& info, Logger* logger = nullptr);
+
 
 
 enum class CompressionLevel
@@ -340,6 +819,16 @@ enum class CompressionLevel
 	MIN_SIZE  // Max compression
 };
 
+struct SaveOptions
+{
+	CompressionLevel level = CompressionLevel::DEFAULT;
+	uint32_t threadCount = 0;						// Threads used to compress the model, 0 - all hardware threads
+	bool encodeGeometry = false;					// Encode vertices, meshlets and indices with meshoptimizer codecs before compression,
+													// triangles of the index batches may come back rotated, their winding is kept
+	VertexFormat vertexFormat = VertexFormat::FLOAT;		  // Vertex type in the file
+	VertexLayout vertexLayout = VertexLayout::INTERLEAVED;  // Vertex streams in the file, loaded models are interleaved
+};
+
 /*
 	Save the model to file in CXMF format
 
@@ -353,6 +842,19 @@ enum class CompressionLevel
 */
 extern bool SaveToFile(const Model& model, const char* directoryPath, CompressionLevel level, Logger* logger = nullptr);
 
+/*
+	Save the model to file in CXMF format
+
+	@param model - model to save
+	@param directoryPath - path to the directory where the model should be saved, with 'model.name'.cxmf format
+		if directoryPath is nullptr then model will be saved to current working directory
+	@param options - saving parameters
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return true if success
+*/
+extern bool SaveToFile(const Model& model, const char* directoryPath, const SaveOptions& options, Logger* logger = nullptr);
+
 
 
 class OutputStream
@@ -376,12 +878,594 @@ public:
 */
 extern bool SaveToStream(const Model& model, OutputStream& stream, CompressionLevel level, Logger* logger = nullptr);
 
+/*
+	Save the model content to output stream
 
+	@param model - model to save
+	@param stream - output stream
+	@param options - saving parameters
+	@param logger - optional log handler for outputting errors and warnings
 
-/*
-	Use this for free model object or just use C++ 'delete' keyword
+	@return Return true if success
 */
-inline void Free(Model* const& model)
+extern bool SaveToStream(const Model& model, OutputStream& stream, const SaveOptions& options, Logger* logger = nullptr);
+
+
+
+/*
+	Restore the vertex of 'VertexFormat::PACKED'
+
+	@param vertex - packed vertex
+	@param bounds - bounds of the mesh the vertex belongs to
+
+	@return Return the dequantized vertex
+*/
+CXMF_NODISCARD extern Vertex Dequantize(const PackedVertex& vertex, const BoundingSphere& bounds);
+
+/*
+	Restore the vertex of 'VertexFormat::PACKED'
+
+	@param vertex - packed vertex
+	@param bounds - bounds of the mesh the vertex belongs to
+
+	@return Return the dequantized vertex
+*/
+CXMF_NODISCARD extern WeightedVertex Dequantize(const PackedWeightedVertex& vertex, const BoundingSphere& bounds);
+
+/*
+	Size of the stream element of 'VertexLayout::STREAMS'
+
+	@param type - model type
+	@param format - vertex format
+	@param stream - vertex stream
+
+	@return Return the element size in bytes, 0 if the model type has no such stream
+*/
+CXMF_NODISCARD extern size_t GetVertexStreamStride(ModelType type, VertexFormat format, VertexStream stream);
+
+
+
+/*
+	Executor of asynchronous loads and saves, every stage of them is posted as a coroutine resumption.
+	'post' may be called from any thread, the handle must be resumed exactly once.
+*/
+class Executor
+{
+public:
+	virtual ~Executor() = default;
+
+	virtual void post(std::coroutine_handle<> handle) = 0;
+};
+
+/*
+	Lazy result of an asynchronous load or save, the operation starts when the task is awaited.
+	The awaiting coroutine is resumed on a thread of the executor after the last stage.
+*/
+template <typename _Ty>
+class Task
+{
+public:
+	struct promise_type;
+
+private:
+	using Handle = std::coroutine_handle<promise_type>;
+
+	struct FinalAwaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		std::coroutine_handle<> await_suspend(Handle handle) const noexcept
+		{
+			const std::coroutine_handle<> continuation = handle.promise().continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept {}
+	};
+
+public:
+	struct promise_type
+	{
+		_Ty result{};
+		std::coroutine_handle<> continuation;
+
+		Task get_return_object()
+		{
+			return Task(Handle::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() const noexcept
+		{
+			return {};
+		}
+
+		FinalAwaiter final_suspend() const noexcept
+		{
+			return {};
+		}
+
+		void return_value(_Ty value)
+		{
+			result = std::move(value);
+		}
+
+		void unhandled_exception() const
+		{
+			std::terminate();
+		}
+	};
+
+private:
+	Handle m_Handle;
+
+	explicit Task(Handle handle)
+		: m_Handle(handle)
+	{}
+
+public:
+	Task(Task&& other) noexcept
+		: m_Handle(std::exchange(other.m_Handle, nullptr))
+	{}
+
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	Task& operator=(Task&&) = delete;
+
+	~Task()
+	{
+		if (m_Handle) m_Handle.destroy();
+	}
+
+	bool await_ready() const noexcept
+	{
+		return !m_Handle || m_Handle.done();
+	}
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		m_Handle.promise().continuation = awaiting;
+		return m_Handle;
+	}
+
+	_Ty await_resume()
+	{
+		return std::move(m_Handle.promise().result);
+	}
+};
+
+/*
+	Asynchronous version of 'LoadFromFile', stages are run on the executor:
+	file read-ahead, model metadata, vertex decompression and meshlet decompression.
+	Decompression of large sections and mesh optimization of imported models still use 'options.threadCount' threads,
+	set it to 1 to keep all work on the executor.
+	'LoadOptions::importCacheDirectory' and 'LoadOptions::meshletSets' are copied into the task on the call,
+	only 'LoadOptions::memoryResource' must outlive the task.
+
+	@param filePath - path to .gltf/.cxmf model file
+	@param executor - executor of the stages, must outlive the task
+	@param options - loading parameters
+	@param logger - optional log handler for outputting errors and warnings, must outlive the task
+
+	@return Return a task with 'cxmf::Model' object if success, otherwise with 'nullptr'
+*/
+CXMF_NODISCARD extern Task<Model*> LoadAsync(std::string filePath, Executor& executor, LoadOptions options = LoadOptions(),
+											 Logger* logger = nullptr);
+
+/*
+	Asynchronous version of 'LoadFromMemory', the buffer must stay alive until the task is complete
+
+	@param data - buffer with content
+	@param dataSize - buffer size in bytes
+	@param executor - executor of the stages, must outlive the task
+	@param options - loading parameters
+	@param logger - optional log handler for outputting errors and warnings, must outlive the task
+
+	@return Return a task with 'cxmf::Model' object if success, otherwise with 'nullptr'
+*/
+CXMF_NODISCARD extern Task<Model*> LoadAsync(const void* data, size_t dataSize, Executor& executor,
+											 LoadOptions options = LoadOptions(), Logger* logger = nullptr);
+
+/*
+	Asynchronous version of 'SaveToFile', stages are run on the executor:
+	vertex packing, geometry codecs, then compression and output of each section.
+	The model must stay alive and unchanged until the task is complete.
+
+	@param model - model to save
+	@param directoryPath - path to the directory where the model should be saved, with 'model.name'.cxmf format
+		if directoryPath is empty then model will be saved to current working directory
+	@param executor - executor of the stages, must outlive the task
+	@param options - saving parameters
+	@param logger - optional log handler for outputting errors and warnings, must outlive the task
+
+	@return Return a task with true if success
+*/
+CXMF_NODISCARD extern Task<bool> SaveAsync(const Model& model, std::string directoryPath, Executor& executor,
+										   SaveOptions options = SaveOptions(), Logger* logger = nullptr);
+
+/*
+	Asynchronous version of 'SaveToStream', the model and the stream must stay alive until the task is complete
+
+	@param model - model to save
+	@param stream - output stream
+	@param executor - executor of the stages, must outlive the task
+	@param options - saving parameters
+	@param logger - optional log handler for outputting errors and warnings, must outlive the task
+
+	@return Return a task with true if success
+*/
+CXMF_NODISCARD extern Task<bool> SaveAsync(const Model& model, OutputStream& stream, Executor& executor,
+										   SaveOptions options = SaveOptions(), Logger* logger = nullptr);
+
+
+
+class ModelView;
+
+/*
+	Open a CXMF model saved with 'CompressionLevel::NONE' as read-only view, the file is memory-mapped
+	and nothing is copied or decoded.
+
+	@param filePath - path to .cxmf model file
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::ModelView' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern ModelView* OpenViewFromFile(const char* filePath, Logger* logger = nullptr);
+
+
+
+/*
+	Open a CXMF model saved with 'CompressionLevel::NONE' as read-only view over memory buffer.
+	The buffer must stay alive and unchanged while the view is in use.
+
+	@param data - buffer with content, must be aligned at least to 8 bytes, sections are used in place
+	@param dataSize - buffer size in bytes
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::ModelView' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern ModelView* OpenViewFromMemory(const void* data, size_t dataSize, Logger* logger = nullptr);
+
+
+
+class ModelView
+{
+private:
+	struct Storage;
+
+private:
+	Storage* m_Storage;	 // Memory-mapped file, nullptr for views over user memory
+	ModelType m_Type;
+	VertexFormat m_VertexFormat;
+	VertexLayout m_VertexLayout;
+	uint32_t m_Flags;
+	uint32_t m_Version;
+	std::string_view m_Strings;
+	std::string_view m_Name;
+	std::string_view m_Copyright;
+	std::string_view m_Generator;
+	BoundingSphere m_Bounds;
+	std::span<const TextureRecord> m_Textures;
+	std::span<const SamplerRecord> m_Samplers;
+	std::span<const MaterialRecord> m_Materials;
+	std::span<const MeshRecord> m_Meshes;
+	std::span<const MeshHierarchyRecord> m_MeshNodes;
+	std::span<const BoneRecord> m_Bones;
+	std::span<const Vertex> m_Vertices;
+	std::span<const WeightedVertex> m_WeightedVertices;
+	std::span<const PackedVertex> m_PackedVertices;
+	std::span<const PackedWeightedVertex> m_PackedWeightedVertices;
+	std::span<const uint8_t> m_VertexStreams[4];  // By 'VertexStream'
+	std::span<const QuantizationError> m_QuantizationErrors;
+	std::span<const Meshlet> m_Meshlets;
+	std::span<const MeshletCone> m_MeshletCones;
+	std::span<const MeshLod> m_MeshLods;
+	std::span<const Cluster> m_Clusters;
+	std::span<const ClusterGroup> m_ClusterGroups;
+	std::span<const MeshletLimits> m_MeshletSets;
+	std::span<const MeshletRanges> m_MeshletSetRanges;
+	std::span<const IndexBatch> m_IndexBatches;
+	std::span<const uint32_t> m_Indices;
+	std::span<const uint16_t> m_Indices16;
+	std::span<const MeshStatistics> m_MeshStatistics;
+	std::span<const uint32_t> m_MeshletVertices;
+	std::span<const uint8_t> m_MeshletTriangles;
+
+private:
+	ModelView();
+
+	bool init(const void* data, size_t dataSize, Logger* logger);
+
+	friend ModelView* OpenViewFromFile(const char* filePath, Logger* logger);
+	friend ModelView* OpenViewFromMemory(const void* data, size_t dataSize, Logger* logger);
+
+public:
+	ModelView(const ModelView&) = delete;
+	ModelView& operator=(const ModelView&) = delete;
+	~ModelView();
+
+public:
+	CXMF_NODISCARD ModelType GetType() const
+	{
+		return m_Type;
+	}
+	CXMF_NODISCARD VertexFormat GetVertexFormat() const
+	{
+		return m_VertexFormat;
+	}
+	CXMF_NODISCARD VertexLayout GetVertexLayout() const
+	{
+		return m_VertexLayout;
+	}
+	CXMF_NODISCARD uint32_t GetFlags() const
+	{
+		return m_Flags;
+	}
+	CXMF_NODISCARD uint32_t GetVersion() const
+	{
+		return m_Version;
+	}
+
+	CXMF_NODISCARD std::string_view GetName() const
+	{
+		return m_Name;
+	}
+	CXMF_NODISCARD std::string_view GetCopyright() const
+	{
+		return m_Copyright;
+	}
+	CXMF_NODISCARD std::string_view GetGenerator() const
+	{
+		return m_Generator;
+	}
+	CXMF_NODISCARD const BoundingSphere& GetBounds() const
+	{
+		return m_Bounds;
+	}
+
+	// Points into the contiguous string table of the view, return empty string if the reference is out of the table
+	CXMF_NODISCARD std::string_view GetString(const StringRef& ref) const;
+
+	CXMF_NODISCARD std::span<const TextureRecord> GetTextures() const
+	{
+		return m_Textures;
+	}
+	CXMF_NODISCARD std::span<const SamplerRecord> GetSamplers() const
+	{
+		return m_Samplers;
+	}
+	CXMF_NODISCARD std::span<const MaterialRecord> GetMaterials() const
+	{
+		return m_Materials;
+	}
+	CXMF_NODISCARD std::span<const MeshRecord> GetMeshes() const
+	{
+		return m_Meshes;
+	}
+	CXMF_NODISCARD std::span<const MeshHierarchyRecord> GetMeshNodes() const
+	{
+		return m_MeshNodes;
+	}
+	// Empty for 'ModelType::STATIC'
+	CXMF_NODISCARD std::span<const BoneRecord> GetBones() const
+	{
+		return m_Bones;
+	}
+
+	// Empty for 'ModelType::SKINNED' or 'VertexFormat::PACKED' or 'VertexLayout::STREAMS'
+	CXMF_NODISCARD std::span<const Vertex> GetVertices() const
+	{
+		return m_Vertices;
+	}
+	// Empty for 'ModelType::STATIC' or 'VertexFormat::PACKED' or 'VertexLayout::STREAMS'
+	CXMF_NODISCARD std::span<const WeightedVertex> GetWeightedVertices() const
+	{
+		return m_WeightedVertices;
+	}
+	// Empty for 'ModelType::SKINNED' or 'VertexFormat::FLOAT' or 'VertexLayout::STREAMS'
+	CXMF_NODISCARD std::span<const PackedVertex> GetPackedVertices() const
+	{
+		return m_PackedVertices;
+	}
+	// Empty for 'ModelType::STATIC' or 'VertexFormat::FLOAT' or 'VertexLayout::STREAMS'
+	CXMF_NODISCARD std::span<const PackedWeightedVertex> GetPackedWeightedVertices() const
+	{
+		return m_PackedWeightedVertices;
+	}
+	// Raw elements of the stream, see 'GetVertexStreamStride', empty for 'VertexLayout::INTERLEAVED'
+	CXMF_NODISCARD std::span<const uint8_t> GetVertexStream(VertexStream stream) const
+	{
+		return static_cast<size_t>(stream) < std::size(m_VertexStreams) ? m_VertexStreams[static_cast<size_t>(stream)]
+																		: std::span<const uint8_t>();
+	}
+	// One per mesh, empty for 'VertexFormat::FLOAT'
+	CXMF_NODISCARD std::span<const QuantizationError> GetQuantizationErrors() const
+	{
+		return m_QuantizationErrors;
+	}
+	CXMF_NODISCARD std::span<const Meshlet> GetMeshlets() const
+	{
+		return m_Meshlets;
+	}
+	CXMF_NODISCARD std::span<const MeshletCone> GetMeshletCones() const
+	{
+		return m_MeshletCones;
+	}
+	CXMF_NODISCARD std::span<const MeshLod> GetMeshLods() const
+	{
+		return m_MeshLods;
+	}
+	CXMF_NODISCARD std::span<const Cluster> GetClusters() const
+	{
+		return m_Clusters;
+	}
+	CXMF_NODISCARD std::span<const ClusterGroup> GetClusterGroups() const
+	{
+		return m_ClusterGroups;
+	}
+	CXMF_NODISCARD std::span<const MeshletLimits> GetMeshletSets() const
+	{
+		return m_MeshletSets;
+	}
+	CXMF_NODISCARD std::span<const MeshletRanges> GetMeshletSetRanges() const
+	{
+		return m_MeshletSetRanges;
+	}
+	CXMF_NODISCARD std::span<const IndexBatch> GetIndexBatches() const
+	{
+		return m_IndexBatches;
+	}
+	CXMF_NODISCARD std::span<const uint32_t> GetIndices() const
+	{
+		return m_Indices;
+	}
+	// Used instead of 'GetIndices' by models with 'Model::indices16'
+	CXMF_NODISCARD std::span<const uint16_t> GetIndices16() const
+	{
+		return m_Indices16;
+	}
+	// Empty or one per mesh
+	CXMF_NODISCARD std::span<const MeshStatistics> GetMeshStatistics() const
+	{
+		return m_MeshStatistics;
+	}
+	CXMF_NODISCARD std::span<const uint32_t> GetMeshletVertices() const
+	{
+		return m_MeshletVertices;
+	}
+	CXMF_NODISCARD std::span<const uint8_t> GetMeshletTriangles() const
+	{
+		return m_MeshletTriangles;
+	}
+};
+
+
+
+// Geometry of a single mesh, see 'ModelStream'.
+// Offsets of the meshlets and values of 'meshletVertices' are relative to the arrays of this object.
+struct MeshGeometry
+{
+	uint32_t meshIndex;
+	std::vector<Vertex> vertices;				   // Empty for 'ModelType::SKINNED'
+	std::vector<WeightedVertex> weightedVertices;  // Empty for 'ModelType::STATIC'
+	std::vector<Meshlet> meshlets;				   // Full-detail meshlets, then the meshlets of each level and the clusters
+	std::vector<MeshletCone> meshletCones;		   // Empty or one per meshlet
+	std::vector<MeshLod> lods;					   // Offsets are relative to 'meshlets'
+	std::vector<Cluster> clusters;				   // Indices are relative to 'meshlets' and 'clusterGroups'
+	std::vector<ClusterGroup> clusterGroups;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint8_t> meshletTriangles;
+	std::vector<IndexBatch> indexBatches;  // Offsets are relative to 'indices' or 'indices16', whichever the model stores
+	std::vector<uint32_t> indices;
+	std::vector<uint16_t> indices16;
+};
+
+class ModelStream;
+
+/*
+	Open a CXMF model for per-mesh geometry streaming, the file is memory-mapped
+	and only the metadata is decoded up front.
+
+	@param filePath - path to .cxmf model file
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::ModelStream' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern ModelStream* OpenStreamFromFile(const char* filePath, Logger* logger = nullptr);
+
+/*
+	Open a CXMF model for per-mesh geometry streaming, the file is memory-mapped
+	and only the metadata is decoded up front.
+	With 'LoadOptions::meshletLimits' the meshes take the ranges of the selected meshlet set, 'LoadMesh' fetches only it.
+
+	@param filePath - path to .cxmf model file
+	@param options - loading parameters
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::ModelStream' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern ModelStream* OpenStreamFromFile(const char* filePath, const LoadOptions& options, Logger* logger = nullptr);
+
+
+
+/*
+	Open a CXMF model in memory buffer for per-mesh geometry streaming.
+	The buffer must stay alive and unchanged while the stream is in use.
+
+	@param data - buffer with content
+	@param dataSize - buffer size in bytes
+	@param options - loading parameters
+	@param logger - optional log handler for outputting errors and warnings
+
+	@return Return a 'cxmf::ModelStream' object if success, otherwise 'nullptr'
+*/
+CXMF_NODISCARD extern ModelStream* OpenStreamFromMemory(const void* data, size_t dataSize, const LoadOptions& options,
+														Logger* logger = nullptr);
+
+
+
+class ModelStream
+{
+private:
+	struct Storage;
+
+private:
+	Storage* m_Storage;
+	ModelInfo m_Info;
+
+private:
+	ModelStream();
+
+	bool init(const void* data, size_t dataSize, const LoadOptions& options, Logger* logger);
+
+	friend ModelStream* OpenStreamFromFile(const char* filePath, const LoadOptions& options, Logger* logger);
+	friend ModelStream* OpenStreamFromMemory(const void* data, size_t dataSize, const LoadOptions& options, Logger* logger);
+
+public:
+	ModelStream(const ModelStream&) = delete;
+	ModelStream& operator=(const ModelStream&) = delete;
+	~ModelStream();
+
+public:
+	CXMF_NODISCARD const ModelInfo& GetInfo() const
+	{
+		return m_Info;
+	}
+
+	/*
+		Decode the geometry of the mesh. Only the compressed blocks overlapping the mesh are inflated,
+		sections without random access (single zlib stream, meshoptimizer codecs) are decoded once and kept.
+		Not thread-safe.
+
+		@param meshIndex - index in 'GetInfo().meshes'
+		@param geometry - receives the mesh geometry
+		@param logger - optional log handler for outputting errors and warnings
+
+		@return Return true if success
+	*/
+	CXMF_NODISCARD bool LoadMesh(uint32_t meshIndex, MeshGeometry& geometry, Logger* logger = nullptr);
+
+	/*
+		Decode the geometry of several meshes, see 'LoadMesh'
+
+		@param meshIndices - indices in 'GetInfo().meshes'
+		@param geometries - receives the geometry of each mesh in the same order
+		@param logger - optional log handler for outputting errors and warnings
+
+		@return Return true if success
+	*/
+	CXMF_NODISCARD bool LoadMeshes(std::span<const uint32_t> meshIndices, std::vector<MeshGeometry>& geometries,
+								   Logger* logger = nullptr);
+};
+
+
+
+/*
+	Use this for free model object or just use C++ 'delete' keyword
+*/
+inline void Free(Model* const& model)
 {
 	if (model)
 	{
@@ -390,4 +1474,28 @@ inline void Free(Model* const& model)
 	}
 }
 
+/*
+	Use this for free model view object or just use C++ 'delete' keyword
+*/
+inline void Free(ModelView* const& view)
+{
+	if (view)
+	{
+		delete view;
+		const_cast<ModelView*&>(view) = nullptr;
+	}
+}
+
+/*
+	Use this for free model stream object or just use C++ 'delete' keyword
+*/
+inline void Free(ModelStream* const& stream)
+{
+	if (stream)
+	{
+		delete stream;
+		const_cast<ModelStream*&>(stream) = nullptr;
+	}
+}
+
 }  //namespace cxmf
@@ -1,13 +1,41 @@
 #include "CXMF.hpp"
 
 #include <fstream>
-#include <sstream>
 #include <format>
 #include <optional>
+#include <memory>
 #include <filesystem>
 #include <limits>
-#include <list>
 #include <unordered_map>
+#include <unordered_set>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <bit>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#ifndef NOGDI
+		#define NOGDI
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
 
 #ifdef CXMF_INCLUDE_IMPORTER
 	#include "assimp/Importer.hpp"
@@ -18,6 +46,7 @@
 	#include "assimp/Logger.hpp"
 	#include "assimp/DefaultLogger.hpp"
 	#include "assimp/LogStream.hpp"
+	#include "assimp/DefaultIOSystem.h"
 	#include "assimp/commonMetaData.h"
 
 	#ifndef AI_MATKEY_LIGHTMAP_FACTOR
@@ -27,10 +56,9 @@
 
 	#define GLM_ENABLE_EXPERIMENTAL
 	#include "glm/ext.hpp"
-
-	#include "meshoptimizer.h"
 #endif
 
+#include "meshoptimizer.h"
 #include "zlib.h"
 
 #undef min
@@ -38,75 +66,344 @@
 
 
 
-// Read/Write model stuff
+// CXMF 1.0 model layout (read only, models are saved in sections since 1.1)
 
-#define WRITE_PARAM(Param, Size) stream.write(reinterpret_cast<const char*>(Param), Size)
-#define READ_PARAM(Param, Size) stream.read(reinterpret_cast<char*>(Param), Size)
+// Sequential reader over the user input stream, stored content is pulled in fixed-size chunks
+// and zlib streams are inflated right from the chunk, so the stored model is never resident as a whole
+class StreamReader
+{
+public:
+	static constexpr size_t ChunkSize = 64 * 1024;
+	static constexpr size_t WindowSize = 16 * 1024 * 1024;	// Decoded bytes requested from the destination at once
 
+private:
+	cxmf::InputStream& m_Stream;
+	std::vector<uint8_t> m_Chunk;
+	size_t m_ChunkPos;
+	size_t m_ChunkSize;
+	uint64_t m_ChunkOffset;	 // Position of the chunk in the stream
 
+private:
+	bool fill()
+	{
+		m_ChunkOffset += m_ChunkSize;
+		m_ChunkPos = 0;
+		m_ChunkSize = std::min(m_Stream.read(m_Chunk.data(), m_Chunk.size()), m_Chunk.size());
+		return m_ChunkSize > 0;
+	}
 
-// Vertex
+public:
+	explicit StreamReader(cxmf::InputStream& stream)
+		: m_Stream(stream), m_Chunk(ChunkSize), m_ChunkPos(0), m_ChunkSize(0), m_ChunkOffset(0)
+	{
+	}
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::Vertex& vertex)
-{
-	WRITE_PARAM(&vertex.position[0], sizeof(vertex.position));
-	WRITE_PARAM(&vertex.normal[0], sizeof(vertex.normal));
-	WRITE_PARAM(&vertex.uv[0], sizeof(vertex.uv));
-	WRITE_PARAM(&vertex.tangent[0], sizeof(vertex.tangent));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::Vertex& vertex)
+	StreamReader(const StreamReader&) = delete;
+	StreamReader& operator=(const StreamReader&) = delete;
+
+	bool read(void* dst, size_t size)
+	{
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		while (size > 0)
+		{
+			// Large reads bypass the chunk
+			if (m_ChunkPos == m_ChunkSize && size >= m_Chunk.size())
+			{
+				const size_t count = std::min(m_Stream.read(out, size), size);
+				if (count == 0) return false;
+
+				m_ChunkOffset += count;
+				out += count;
+				size -= count;
+				continue;
+			}
+
+			if (m_ChunkPos == m_ChunkSize && !fill()) return false;
+
+			const size_t count = std::min(size, m_ChunkSize - m_ChunkPos);
+			std::memcpy(out, m_Chunk.data() + m_ChunkPos, count);
+			m_ChunkPos += count;
+			out += count;
+			size -= count;
+		}
+		return true;
+	}
+
+	bool skip(uint64_t size)
+	{
+		while (size > 0)
+		{
+			if (m_ChunkPos == m_ChunkSize && !fill()) return false;
+
+			const size_t count = static_cast<size_t>(std::min<uint64_t>(size, m_ChunkSize - m_ChunkPos));
+			m_ChunkPos += count;
+			size -= count;
+		}
+		return true;
+	}
+
+	// Point zlib input to the unread part of the chunk
+	void attach(z_stream& zlibStream)
+	{
+		zlibStream.next_in = m_Chunk.data() + m_ChunkPos;
+		zlibStream.avail_in = static_cast<uInt>(m_ChunkSize - m_ChunkPos);
+	}
+
+	// Pull the next chunk once zlib has consumed the attached one
+	bool refill(z_stream& zlibStream)
+	{
+		m_ChunkPos = m_ChunkSize;
+		if (!fill()) return false;
+
+		attach(zlibStream);
+		return true;
+	}
+
+	// Bytes left by zlib after the end of its stream are read next
+	void detach(const z_stream& zlibStream)
+	{
+		m_ChunkPos = m_ChunkSize - zlibStream.avail_in;
+	}
+
+	// Inflate a single zlib stream of exactly 'size' decoded bytes, return Z_OK or zlib error.
+	// Output is taken window by window from 'output(offset, count)', so the destination can grow as the content arrives.
+	template <typename _OutputFn>
+	int inflate(size_t size, _OutputFn&& output)
+	{
+		z_stream zlibStream;
+		std::memset(&zlibStream, 0, sizeof(z_stream));
+		int err = inflateInit(&zlibStream);
+		if (err != Z_OK) return err;
+
+		size_t outOffset = 0;
+		bool hasInput = true;
+
+		attach(zlibStream);
+		do
+		{
+			if (zlibStream.avail_in == 0) hasInput = refill(zlibStream);
+			if (zlibStream.avail_out == 0 && outOffset < size)
+			{
+				const size_t count = std::min(size - outOffset, WindowSize);
+				zlibStream.next_out = output(outOffset, count);
+				zlibStream.avail_out = static_cast<uInt>(count);
+				outOffset += count;
+			}
+			err = ::inflate(&zlibStream, Z_NO_FLUSH);
+		} while (err == Z_OK ||
+				 (err == Z_BUF_ERROR && ((zlibStream.avail_in == 0 && hasInput) || (zlibStream.avail_out == 0 && outOffset < size))));
+
+		detach(zlibStream);
+		inflateEnd(&zlibStream);
+
+		if (err != Z_STREAM_END) return err;
+		return outOffset < size || zlibStream.avail_out > 0 ? Z_DATA_ERROR : Z_OK;
+	}
+
+	uint64_t position() const
+	{
+		return m_ChunkOffset + m_ChunkPos;
+	}
+};
+
+// Sequential reader over the zlib stream of CXMF 1.0 model, fails instead of reading out of bounds.
+// Small fields are served from a fixed-size window, large arrays are inflated right into the destination,
+// so the whole decompressed content is never resident.
+class LegacyModelStream
 {
-	READ_PARAM(&vertex.position[0], sizeof(vertex.position));
-	READ_PARAM(&vertex.normal[0], sizeof(vertex.normal));
-	READ_PARAM(&vertex.uv[0], sizeof(vertex.uv));
-	READ_PARAM(&vertex.tangent[0], sizeof(vertex.tangent));
-	return stream;
-}
+private:
+	static constexpr size_t WindowSize = 64 * 1024;
+
+private:
+	z_stream m_Zlib;
+	StreamReader* m_Source;	 // Supplies the compressed content when it is not in memory
+	std::vector<uint8_t> m_Window;
+	size_t m_WindowPos;
+	size_t m_WindowSize;
+	uint64_t m_Remaining;  // Not yet read bytes of the decompressed content
+	int m_Error;
+	bool m_Good;
+
+private:
+	bool inflateTo(uint8_t* dst, size_t size)
+	{
+		while (size > 0)
+		{
+			const uInt chunk = static_cast<uInt>(std::min<size_t>(size, std::numeric_limits<uInt>::max()));
+			m_Zlib.next_out = dst;
+			m_Zlib.avail_out = chunk;
+			do
+			{
+				if (m_Zlib.avail_in == 0 && m_Source && !m_Source->refill(m_Zlib)) break;
+				m_Error = inflate(&m_Zlib, Z_NO_FLUSH);
+			} while (m_Error == Z_OK && m_Zlib.avail_out > 0);
+
+			if (m_Zlib.avail_out > 0)  //
+				return false;
+
+			dst += chunk;
+			size -= chunk;
+		}
+		return true;
+	}
+
+	LegacyModelStream(StreamReader* source, uint32_t baseSize)
+		: m_Zlib(), m_Source(source), m_Window(), m_WindowPos(0), m_WindowSize(0), m_Remaining(baseSize), m_Error(Z_OK),
+		  m_Good(false)
+	{
+		std::memset(&m_Zlib, 0, sizeof(z_stream));
+		m_Error = inflateInit(&m_Zlib);
+		if (m_Error != Z_OK) return;
+
+		m_Window.resize(std::min<size_t>(WindowSize, baseSize));
+		m_Good = true;
+	}
+
+public:
+	LegacyModelStream(const void* compressed, uint32_t compressedSize, uint32_t baseSize) : LegacyModelStream(nullptr, baseSize)
+	{
+		m_Zlib.next_in = static_cast<Bytef*>(const_cast<void*>(compressed));
+		m_Zlib.avail_in = compressedSize;
+	}
+
+	// Compressed content is pulled from the reader while inflating
+	LegacyModelStream(StreamReader& source, uint32_t baseSize) : LegacyModelStream(&source, baseSize)
+	{
+		source.attach(m_Zlib);
+	}
+
+	LegacyModelStream(const LegacyModelStream&) = delete;
+	LegacyModelStream& operator=(const LegacyModelStream&) = delete;
+
+	~LegacyModelStream()
+	{
+		inflateEnd(&m_Zlib);
+	}
+
+	LegacyModelStream& read(void* dst, size_t size)
+	{
+		if (!m_Good || size > m_Remaining)
+		{
+			m_Good = false;
+			return *this;
+		}
+		m_Remaining -= size;
+
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		const size_t buffered = std::min(size, m_WindowSize - m_WindowPos);
+		if (buffered > 0)
+		{
+			std::memcpy(out, m_Window.data() + m_WindowPos, buffered);
+			m_WindowPos += buffered;
+			out += buffered;
+			size -= buffered;
+		}
+
+		if (size == 0) return *this;
+
+		if (size >= m_Window.size())
+		{
+			m_Good = inflateTo(out, size);
+			return *this;
+		}
+
+		const size_t fill = static_cast<size_t>(std::min<uint64_t>(m_Window.size(), m_Remaining + size));
+		m_Good = inflateTo(m_Window.data(), fill);
+		if (m_Good)
+		{
+			std::memcpy(out, m_Window.data(), size);
+			m_WindowPos = size;
+			m_WindowSize = fill;
+		}
+		return *this;
+	}
+
+	// Whole array of fixed-size values, inflated in place
+	template <typename _Ty>
+	requires std::is_trivially_copyable_v<_Ty>
+	LegacyModelStream& readArray(std::pmr::vector<_Ty>& out, uint32_t count)
+	{
+		if (!m_Good || count > m_Remaining / sizeof(_Ty))
+		{
+			m_Good = false;
+			return *this;
+		}
+		out.resize(count);
+		return read(out.data(), sizeof(_Ty) * count);
+	}
+
+	LegacyModelStream& readString(std::pmr::string& out, uint32_t length)
+	{
+		if (!m_Good || length > m_Remaining)
+		{
+			m_Good = false;
+			return *this;
+		}
+		out.resize(length);
+		return read(out.data(), length);
+	}
+
+	void fail()
+	{
+		m_Good = false;
+	}
+
+	uint64_t remaining() const
+	{
+		return m_Remaining;
+	}
+
+	bool good() const
+	{
+		return m_Good;
+	}
+
+	// Last zlib result, Z_OK or Z_STREAM_END if there were no decompression errors
+	int error() const
+	{
+		return m_Error;
+	}
+};
+
+#define READ_PARAM(Param, Size) stream.read(Param, Size)
 
+// Vertex, WeightedVertex and Meshlet were written field by field without gaps,
+// so the arrays of them are read in place with a single copy
+static_assert(sizeof(cxmf::Vertex) == sizeof(float) * 11);
+static_assert(sizeof(cxmf::WeightedVertex) == sizeof(float) * 15 + sizeof(uint32_t) * 4);
+static_assert(sizeof(cxmf::Meshlet) == sizeof(cxmf::BoundingSphere) + sizeof(uint32_t) * 4);
 
 
-// WeightedVertex
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::WeightedVertex& vertex)
+// Records of model arrays have the name as first member, it is created on the memory resource of the array.
+// Record assignment keeps the allocator of the name, so the content is carved from the same resource.
+template <typename _Ty>
+static std::pmr::memory_resource* array_resource(const std::vector<_Ty>&)
 {
-	WRITE_PARAM(&vertex.position[0], sizeof(vertex.position));
-	WRITE_PARAM(&vertex.normal[0], sizeof(vertex.normal));
-	WRITE_PARAM(&vertex.uv[0], sizeof(vertex.uv));
-	WRITE_PARAM(&vertex.tangent[0], sizeof(vertex.tangent));
-	WRITE_PARAM(&vertex.boneID[0], sizeof(vertex.boneID));
-	WRITE_PARAM(&vertex.weight[0], sizeof(vertex.weight));
-	return stream;
+	return std::pmr::get_default_resource();
 }
-static std::istream& operator>>(std::istream& stream, cxmf::WeightedVertex& vertex)
+
+template <typename _Ty>
+static std::pmr::memory_resource* array_resource(const std::pmr::vector<_Ty>& array)
 {
-	READ_PARAM(&vertex.position[0], sizeof(vertex.position));
-	READ_PARAM(&vertex.normal[0], sizeof(vertex.normal));
-	READ_PARAM(&vertex.uv[0], sizeof(vertex.uv));
-	READ_PARAM(&vertex.tangent[0], sizeof(vertex.tangent));
-	READ_PARAM(&vertex.boneID[0], sizeof(vertex.boneID));
-	READ_PARAM(&vertex.weight[0], sizeof(vertex.weight));
-	return stream;
+	return array.get_allocator().resource();
+}
+
+template <typename _ArrayTy>
+static typename _ArrayTy::value_type& emplace_record(_ArrayTy& out)
+{
+	return out.emplace_back(std::pmr::string(array_resource(out)));
 }
 
 
 
 // Texture
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::Texture& tex)
-{
-	const uint32_t pathLen = static_cast<uint32_t>(tex.path.length());
-	WRITE_PARAM(&pathLen, sizeof(pathLen));
-	WRITE_PARAM(tex.path.c_str(), pathLen);
-	WRITE_PARAM(&tex.samplerIndex, sizeof(tex.samplerIndex));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::Texture& tex)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::Texture& tex)
 {
 	uint32_t pathLen = 0;
 	READ_PARAM(&pathLen, sizeof(pathLen));
-	tex.path.resize(pathLen);
-	READ_PARAM(tex.path.data(), pathLen);
+	stream.readString(tex.path, pathLen);
 	READ_PARAM(&tex.samplerIndex, sizeof(tex.samplerIndex));
 	return stream;
 }
@@ -115,24 +412,11 @@ static std::istream& operator>>(std::istream& stream, cxmf::Texture& tex)
 
 // Sampler
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::Sampler& sampler)
-{
-	const uint32_t nameLen = static_cast<uint32_t>(sampler.name.length());
-	WRITE_PARAM(&nameLen, sizeof(nameLen));
-	WRITE_PARAM(sampler.name.c_str(), nameLen);
-	WRITE_PARAM(&sampler.magFilter, sizeof(sampler.magFilter));
-	WRITE_PARAM(&sampler.minFilter, sizeof(sampler.minFilter));
-	WRITE_PARAM(&sampler.mipmapMode, sizeof(sampler.mipmapMode));
-	WRITE_PARAM(&sampler.addressModeU, sizeof(sampler.addressModeU));
-	WRITE_PARAM(&sampler.addressModeV, sizeof(sampler.addressModeV));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::Sampler& sampler)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::Sampler& sampler)
 {
 	uint32_t nameLen = 0;
 	READ_PARAM(&nameLen, sizeof(nameLen));
-	sampler.name.resize(nameLen);
-	READ_PARAM(sampler.name.data(), nameLen);
+	stream.readString(sampler.name, nameLen);
 	READ_PARAM(&sampler.magFilter, sizeof(sampler.magFilter));
 	READ_PARAM(&sampler.minFilter, sizeof(sampler.minFilter));
 	READ_PARAM(&sampler.mipmapMode, sizeof(sampler.mipmapMode));
@@ -145,29 +429,11 @@ static std::istream& operator>>(std::istream& stream, cxmf::Sampler& sampler)
 
 // Material
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::Material& material)
-{
-	const uint32_t nameLen = static_cast<uint32_t>(material.name.length());
-	WRITE_PARAM(&nameLen, sizeof(nameLen));
-	WRITE_PARAM(material.name.c_str(), nameLen);
-	WRITE_PARAM(&material.baseColorFactor[0], sizeof(material.baseColorFactor));
-	WRITE_PARAM(&material.roughnessFactor, sizeof(material.roughnessFactor));
-	WRITE_PARAM(&material.metallicFactor, sizeof(material.metallicFactor));
-	WRITE_PARAM(&material.ambientOcclusionFactor, sizeof(material.ambientOcclusionFactor));
-	WRITE_PARAM(&material.emissiveFactor[0], sizeof(material.emissiveFactor));
-	WRITE_PARAM(&material.textureIndex, sizeof(material.textureIndex));
-	WRITE_PARAM(&material.alphaMode, sizeof(material.alphaMode));
-	WRITE_PARAM(&material.alphaCutoff, sizeof(material.alphaCutoff));
-	WRITE_PARAM(&material.doubleSided, sizeof(material.doubleSided));
-	WRITE_PARAM(&material.shadeless, sizeof(material.shadeless));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::Material& material)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::Material& material)
 {
 	uint32_t nameLen = 0;
 	READ_PARAM(&nameLen, sizeof(nameLen));
-	material.name.resize(nameLen);
-	READ_PARAM(material.name.data(), nameLen);
+	stream.readString(material.name, nameLen);
 	READ_PARAM(&material.baseColorFactor[0], sizeof(material.baseColorFactor));
 	READ_PARAM(&material.roughnessFactor, sizeof(material.roughnessFactor));
 	READ_PARAM(&material.metallicFactor, sizeof(material.metallicFactor));
@@ -176,33 +442,11 @@ static std::istream& operator>>(std::istream& stream, cxmf::Material& material)
 	READ_PARAM(&material.textureIndex, sizeof(material.textureIndex));
 	READ_PARAM(&material.alphaMode, sizeof(material.alphaMode));
 	READ_PARAM(&material.alphaCutoff, sizeof(material.alphaCutoff));
-	READ_PARAM(&material.doubleSided, sizeof(material.doubleSided));
-	READ_PARAM(&material.shadeless, sizeof(material.shadeless));
-	return stream;
-}
-
-
-
-// Meshlet
-
-static std::ostream& operator<<(std::ostream& stream, const cxmf::Meshlet& meshlet)
-{
-	WRITE_PARAM(&meshlet.bounds.center[0], sizeof(meshlet.bounds.center));
-	WRITE_PARAM(&meshlet.bounds.radius, sizeof(meshlet.bounds.radius));
-	WRITE_PARAM(&meshlet.vertexOffset, sizeof(meshlet.vertexOffset));
-	WRITE_PARAM(&meshlet.triangleOffset, sizeof(meshlet.triangleOffset));
-	WRITE_PARAM(&meshlet.vertexCount, sizeof(meshlet.vertexCount));
-	WRITE_PARAM(&meshlet.triangleCount, sizeof(meshlet.triangleCount));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::Meshlet& meshlet)
-{
-	READ_PARAM(&meshlet.bounds.center[0], sizeof(meshlet.bounds.center));
-	READ_PARAM(&meshlet.bounds.radius, sizeof(meshlet.bounds.radius));
-	READ_PARAM(&meshlet.vertexOffset, sizeof(meshlet.vertexOffset));
-	READ_PARAM(&meshlet.triangleOffset, sizeof(meshlet.triangleOffset));
-	READ_PARAM(&meshlet.vertexCount, sizeof(meshlet.vertexCount));
-	READ_PARAM(&meshlet.triangleCount, sizeof(meshlet.triangleCount));
+	uint8_t doubleSided = 0, shadeless = 0;
+	READ_PARAM(&doubleSided, sizeof(doubleSided));
+	READ_PARAM(&shadeless, sizeof(shadeless));
+	material.doubleSided = doubleSided != 0;
+	material.shadeless = shadeless != 0;
 	return stream;
 }
 
@@ -210,29 +454,15 @@ static std::istream& operator>>(std::istream& stream, cxmf::Meshlet& meshlet)
 
 // Mesh
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::Mesh& mesh)
-{
-	const uint32_t nameLen = static_cast<uint32_t>(mesh.name.length());
-	WRITE_PARAM(&nameLen, sizeof(nameLen));
-	WRITE_PARAM(mesh.name.c_str(), nameLen);
-	WRITE_PARAM(&mesh.bounds.center[0], sizeof(mesh.bounds.center));
-	WRITE_PARAM(&mesh.bounds.radius, sizeof(mesh.bounds.radius));
-	WRITE_PARAM(&mesh.vertexOffset, sizeof(mesh.vertexOffset));
-	WRITE_PARAM(&mesh.vertexCount, sizeof(mesh.vertexCount));
-	WRITE_PARAM(&mesh.meshletOffset, sizeof(mesh.meshletOffset));
-	WRITE_PARAM(&mesh.meshletCount, sizeof(mesh.meshletCount));
-	WRITE_PARAM(&mesh.materialIndex, sizeof(mesh.materialIndex));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::Mesh& mesh)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::Mesh& mesh)
 {
 	uint32_t nameLen = 0;
 	READ_PARAM(&nameLen, sizeof(nameLen));
-	mesh.name.resize(nameLen);
-	READ_PARAM(mesh.name.data(), nameLen);
-	READ_PARAM(&mesh.bounds.center[0], sizeof(mesh.bounds.center));
-	READ_PARAM(&mesh.bounds.radius, sizeof(mesh.bounds.radius));
-	READ_PARAM(&mesh.vertexOffset, sizeof(mesh.vertexOffset));
+	stream.readString(mesh.name, nameLen);
+	READ_PARAM(&mesh.bounds, sizeof(mesh.bounds));
+	uint32_t vertexOffset = 0;
+	READ_PARAM(&vertexOffset, sizeof(vertexOffset));
+	mesh.vertexOffset = vertexOffset;
 	READ_PARAM(&mesh.vertexCount, sizeof(mesh.vertexCount));
 	READ_PARAM(&mesh.meshletOffset, sizeof(mesh.meshletOffset));
 	READ_PARAM(&mesh.meshletCount, sizeof(mesh.meshletCount));
@@ -244,22 +474,11 @@ static std::istream& operator>>(std::istream& stream, cxmf::Mesh& mesh)
 
 // MeshHierarchy
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::MeshHierarchy& mhi)
-{
-	const uint32_t nameLen = static_cast<uint32_t>(mhi.name.length());
-	WRITE_PARAM(&nameLen, sizeof(nameLen));
-	WRITE_PARAM(mhi.name.c_str(), nameLen);
-	WRITE_PARAM(mhi.localTransform.Data(), sizeof(mhi.localTransform));
-	WRITE_PARAM(&mhi.meshIndex, sizeof(mhi.meshIndex));
-	WRITE_PARAM(&mhi.parentIndex, sizeof(mhi.parentIndex));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::MeshHierarchy& mhi)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::MeshHierarchy& mhi)
 {
 	uint32_t nameLen = 0;
 	READ_PARAM(&nameLen, sizeof(nameLen));
-	mhi.name.resize(nameLen);
-	READ_PARAM(mhi.name.data(), nameLen);
+	stream.readString(mhi.name, nameLen);
 	READ_PARAM(mhi.localTransform.Data(), sizeof(mhi.localTransform));
 	READ_PARAM(&mhi.meshIndex, sizeof(mhi.meshIndex));
 	READ_PARAM(&mhi.parentIndex, sizeof(mhi.parentIndex));
@@ -270,22 +489,11 @@ static std::istream& operator>>(std::istream& stream, cxmf::MeshHierarchy& mhi)
 
 // Bone
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::Bone& bone)
-{
-	const uint32_t nameLen = static_cast<uint32_t>(bone.name.length());
-	WRITE_PARAM(&nameLen, sizeof(nameLen));
-	WRITE_PARAM(bone.name.c_str(), nameLen);
-	WRITE_PARAM(bone.inverseBindTransform.Data(), sizeof(bone.inverseBindTransform));
-	WRITE_PARAM(bone.offsetMatrix.Data(), sizeof(bone.offsetMatrix));
-	WRITE_PARAM(&bone.parentIndex, sizeof(bone.parentIndex));
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::Bone& bone)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::Bone& bone)
 {
 	uint32_t nameLen = 0;
 	READ_PARAM(&nameLen, sizeof(nameLen));
-	bone.name.resize(nameLen);
-	READ_PARAM(bone.name.data(), nameLen);
+	stream.readString(bone.name, nameLen);
 	READ_PARAM(bone.inverseBindTransform.Data(), sizeof(bone.inverseBindTransform));
 	READ_PARAM(bone.offsetMatrix.Data(), sizeof(bone.offsetMatrix));
 	READ_PARAM(&bone.parentIndex, sizeof(bone.parentIndex));
@@ -294,54 +502,68 @@ static std::istream& operator>>(std::istream& stream, cxmf::Bone& bone)
 
 
 
+// Each record holds at least 32-bit string length
+template <typename _Ty>
+static void readRecords(LegacyModelStream& stream, std::pmr::vector<_Ty>& out, uint32_t count)
+{
+	if (count > stream.remaining() / sizeof(uint32_t))
+	{
+		stream.fail();
+		return;
+	}
+
+	out.clear();
+	out.reserve(count);
+	for (uint32_t i = 0; i < count && stream.good(); ++i)
+		stream >> emplace_record(out);
+}
+
+
+
 // Model
 
-static void writeGenericModelToStream(std::ostream& stream, const cxmf::Model& model)
-{
-	const uint32_t nameLen = static_cast<uint32_t>(model.name.length());
-	const uint32_t texturesCount = static_cast<uint32_t>(model.textures.size());
-	const uint32_t samplersCount = static_cast<uint32_t>(model.samplers.size());
-	const uint32_t materialsCount = static_cast<uint32_t>(model.materials.size());
-	const uint32_t meshesCount = static_cast<uint32_t>(model.meshes.size());
-	const uint32_t meshNodesCount = static_cast<uint32_t>(model.meshNodes.size());
-	const uint32_t meshletVerticesCount = static_cast<uint32_t>(model.meshletVertices.size());
-	const uint32_t meshletTrianglesCount = static_cast<uint32_t>(model.meshletTriangles.size());
-	const uint32_t meshletsCount = static_cast<uint32_t>(model.meshlets.size());
-	const uint32_t copyrightLen = static_cast<uint32_t>(model.copyright.length());
-	const uint32_t generatorLen = static_cast<uint32_t>(model.generator.length());
-	WRITE_PARAM(&nameLen, sizeof(nameLen));
-	WRITE_PARAM(&texturesCount, sizeof(texturesCount));
-	WRITE_PARAM(&samplersCount, sizeof(samplersCount));
-	WRITE_PARAM(&materialsCount, sizeof(materialsCount));
-	WRITE_PARAM(&meshesCount, sizeof(meshesCount));
-	WRITE_PARAM(&meshNodesCount, sizeof(meshNodesCount));
-	WRITE_PARAM(&meshletVerticesCount, sizeof(meshletVerticesCount));
-	WRITE_PARAM(&meshletTrianglesCount, sizeof(meshletTrianglesCount));
-	WRITE_PARAM(&meshletsCount, sizeof(meshletsCount));
-	WRITE_PARAM(&copyrightLen, sizeof(copyrightLen));
-	WRITE_PARAM(&generatorLen, sizeof(generatorLen));
-	WRITE_PARAM(model.name.c_str(), nameLen);
-	for (uint32_t i = 0; i < texturesCount; ++i)
-		stream << model.textures[i];
-	for (uint32_t i = 0; i < samplersCount; ++i)
-		stream << model.samplers[i];
-	for (uint32_t i = 0; i < materialsCount; ++i)
-		stream << model.materials[i];
-	for (uint32_t i = 0; i < meshesCount; ++i)
-		stream << model.meshes[i];
-	for (uint32_t i = 0; i < meshNodesCount; ++i)
-		stream << model.meshNodes[i];
-	WRITE_PARAM(model.meshletVertices.data(), sizeof(uint32_t) * meshletVerticesCount);
-	WRITE_PARAM(model.meshletTriangles.data(), sizeof(uint8_t) * meshletTrianglesCount);
-	for (uint32_t i = 0; i < meshletsCount; ++i)
-		stream << model.meshlets[i];
-	WRITE_PARAM(&model.bounds.center[0], sizeof(model.bounds.center));
-	WRITE_PARAM(&model.bounds.radius, sizeof(model.bounds.radius));
-	WRITE_PARAM(model.copyright.c_str(), copyrightLen);
-	WRITE_PARAM(model.generator.c_str(), generatorLen);
-}
-
-static void readGenericModelFromStream(std::istream& stream, cxmf::Model& model)
+// CXMF 1.0 meshlets address the whole model arrays, they are rebased to the ranges of their meshes
+static bool localize_meshlets(cxmf::Model& model)
+{
+	for (cxmf::Mesh& mesh : model.meshes)
+	{
+		if (mesh.meshletOffset > model.meshlets.size() || mesh.meshletCount > model.meshlets.size() - mesh.meshletOffset)
+			return false;
+
+		const std::span<cxmf::Meshlet> meshlets(model.meshlets.data() + mesh.meshletOffset, mesh.meshletCount);
+		uint64_t verticesBegin = 0, verticesEnd = 0, trianglesBegin = 0;
+		if (!meshlets.empty())
+		{
+			verticesBegin = trianglesBegin = std::numeric_limits<uint64_t>::max();
+			for (const cxmf::Meshlet& meshlet : meshlets)
+			{
+				verticesBegin = std::min<uint64_t>(verticesBegin, meshlet.vertexOffset);
+				verticesEnd = std::max<uint64_t>(verticesEnd, static_cast<uint64_t>(meshlet.vertexOffset) + meshlet.vertexCount);
+				trianglesBegin = std::min<uint64_t>(trianglesBegin, meshlet.triangleOffset);
+			}
+		}
+
+		if (verticesEnd > model.meshletVertices.size()) return false;
+
+		for (uint64_t i = verticesBegin; i < verticesEnd; ++i)
+		{
+			uint32_t& vertex = model.meshletVertices[static_cast<size_t>(i)];
+			if (vertex < mesh.vertexOffset || vertex - mesh.vertexOffset >= mesh.vertexCount) return false;
+			vertex -= static_cast<uint32_t>(mesh.vertexOffset);
+		}
+
+		for (cxmf::Meshlet& meshlet : meshlets)
+		{
+			meshlet.vertexOffset -= static_cast<uint32_t>(verticesBegin);
+			meshlet.triangleOffset -= static_cast<uint32_t>(trianglesBegin);
+		}
+		mesh.meshletVertexOffset = verticesBegin;
+		mesh.meshletTriangleOffset = trianglesBegin;
+	}
+	return true;
+}
+
+static void readGenericModelFromStream(LegacyModelStream& stream, cxmf::Model& model)
 {
 	uint32_t nameLen = 0;
 	uint32_t texturesCount = 0;
@@ -365,61 +587,34 @@ static void readGenericModelFromStream(std::istream& stream, cxmf::Model& model)
 	READ_PARAM(&meshletsCount, sizeof(meshletsCount));
 	READ_PARAM(&copyrightLen, sizeof(copyrightLen));
 	READ_PARAM(&generatorLen, sizeof(generatorLen));
-	model.name.resize(nameLen);
-	model.textures.resize(texturesCount);
-	model.samplers.resize(samplersCount);
-	model.materials.resize(materialsCount);
-	model.meshes.resize(meshesCount);
-	model.meshNodes.resize(meshNodesCount);
-	model.meshletVertices.resize(meshletVerticesCount);
-	model.meshletTriangles.resize(meshletTrianglesCount);
-	model.meshlets.resize(meshletsCount);
-	model.copyright.resize(copyrightLen);
-	model.generator.resize(generatorLen);
-	READ_PARAM(model.name.data(), nameLen);
-	for (uint32_t i = 0; i < texturesCount; ++i)
-		stream >> model.textures[i];
-	for (uint32_t i = 0; i < samplersCount; ++i)
-		stream >> model.samplers[i];
-	for (uint32_t i = 0; i < materialsCount; ++i)
-		stream >> model.materials[i];
-	for (uint32_t i = 0; i < meshesCount; ++i)
-		stream >> model.meshes[i];
-	for (uint32_t i = 0; i < meshNodesCount; ++i)
-		stream >> model.meshNodes[i];
-	READ_PARAM(model.meshletVertices.data(), sizeof(uint32_t) * meshletVerticesCount);
-	READ_PARAM(model.meshletTriangles.data(), sizeof(uint8_t) * meshletTrianglesCount);
-	for (uint32_t i = 0; i < meshletsCount; ++i)
-		stream >> model.meshlets[i];
-	READ_PARAM(&model.bounds.center[0], sizeof(model.bounds.center));
-	READ_PARAM(&model.bounds.radius, sizeof(model.bounds.radius));
-	READ_PARAM(model.copyright.data(), copyrightLen);
-	READ_PARAM(model.generator.data(), generatorLen);
+	stream.readString(model.name, nameLen);
+	readRecords(stream, model.textures, texturesCount);
+	readRecords(stream, model.samplers, samplersCount);
+	readRecords(stream, model.materials, materialsCount);
+	readRecords(stream, model.meshes, meshesCount);
+	readRecords(stream, model.meshNodes, meshNodesCount);
+	stream.readArray(model.meshletVertices, meshletVerticesCount);
+	stream.readArray(model.meshletTriangles, meshletTrianglesCount);
+	stream.readArray(model.meshlets, meshletsCount);
+	READ_PARAM(&model.bounds, sizeof(model.bounds));
+	stream.readString(model.copyright, copyrightLen);
+	stream.readString(model.generator, generatorLen);
+
+	if (stream.good() && !localize_meshlets(model))	 //
+		stream.fail();
 }
 
 
 
 // StaticModel
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::StaticModel& model)
-{
-	writeGenericModelToStream(stream, model);
-
-	const uint32_t vertexCount = static_cast<uint32_t>(model.vertices.size());
-	WRITE_PARAM(&vertexCount, sizeof(vertexCount));
-	for (uint32_t i = 0; i < vertexCount; ++i)
-		stream << model.vertices[i];
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::StaticModel& model)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::StaticModel& model)
 {
 	readGenericModelFromStream(stream, model);
 
 	uint32_t vertexCount = 0;
 	READ_PARAM(&vertexCount, sizeof(vertexCount));
-	model.vertices.resize(vertexCount);
-	for (uint32_t i = 0; i < vertexCount; ++i)
-		stream >> model.vertices[i];
+	stream.readArray(model.vertices, vertexCount);
 	return stream;
 }
 
@@ -427,38 +622,19 @@ static std::istream& operator>>(std::istream& stream, cxmf::StaticModel& model)
 
 // SkinnedModel
 
-static std::ostream& operator<<(std::ostream& stream, const cxmf::SkinnedModel& model)
-{
-	writeGenericModelToStream(stream, model);
-
-	const uint32_t vertexCount = static_cast<uint32_t>(model.vertices.size());
-	const uint32_t bonesCount = static_cast<uint32_t>(model.bones.size());
-	WRITE_PARAM(&vertexCount, sizeof(vertexCount));
-	WRITE_PARAM(&bonesCount, sizeof(vertexCount));
-	for (uint32_t i = 0; i < vertexCount; ++i)
-		stream << model.vertices[i];
-	for (uint32_t i = 0; i < bonesCount; ++i)
-		stream << model.bones[i];
-	return stream;
-}
-static std::istream& operator>>(std::istream& stream, cxmf::SkinnedModel& model)
+static LegacyModelStream& operator>>(LegacyModelStream& stream, cxmf::SkinnedModel& model)
 {
 	readGenericModelFromStream(stream, model);
 
 	uint32_t vertexCount = 0;
 	uint32_t bonesCount = 0;
 	READ_PARAM(&vertexCount, sizeof(vertexCount));
-	READ_PARAM(&bonesCount, sizeof(vertexCount));
-	model.vertices.resize(vertexCount);
-	model.bones.resize(bonesCount);
-	for (uint32_t i = 0; i < vertexCount; ++i)
-		stream >> model.vertices[i];
-	for (uint32_t i = 0; i < bonesCount; ++i)
-		stream >> model.bones[i];
+	READ_PARAM(&bonesCount, sizeof(bonesCount));
+	stream.readArray(model.vertices, vertexCount);
+	readRecords(stream, model.bones, bonesCount);
 	return stream;
 }
 
-#undef WRITE_PARAM
 #undef READ_PARAM
 
 
@@ -471,7 +647,8 @@ constexpr inline uint32_t MAGIC = ((static_cast<uint32_t>('F') << 24) |	 //
 								   (static_cast<uint32_t>('X') << 8) |	 //
 								   static_cast<uint32_t>('C'));
 
-struct HEADER
+// CXMF 1.0: HEADER_1_0, model type (1 byte), zlib stream of the whole model
+struct HEADER_1_0
 {
 	uint32_t magic;
 	uint32_t version;
@@ -480,6 +657,119 @@ struct HEADER
 	uint32_t flags;
 };
 
+// CXMF 1.1+: HEADER, leading table of 'sectionCount' SECTIONs, sections aligned to SECTION_ALIGNMENT in the order
+// of the leading table, trailing table of 'sectionCount' SECTIONs at the end of the file.
+// The leading table has no offsets and stored sizes, sequential readers find each section right after the previous one.
+// The trailing table and block sizes follow the content, so the model is written in a single pass without seeking.
+struct HEADER
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t flags;
+	uint32_t sectionCount;
+	uint8_t modelType;
+	uint8_t vertexFormat;
+	uint8_t vertexLayout;
+	uint8_t reserved[5];
+};
+
+enum class SectionID : uint32_t
+{
+	MODEL = 0,	  // MODEL_RECORD
+	STRINGS = 1,  // String table, see 'StringTableWriter'
+	TEXTURES = 2,
+	SAMPLERS = 3,
+	MATERIALS = 4,
+	MESHES = 5,
+	MESH_NODES = 6,
+	BONES = 7,
+	VERTICES = 8,  // Vertex[], WeightedVertex[] or their packed versions, depends on model type and vertex format
+	MESHLETS = 9,
+	MESHLET_VERTICES = 10,
+	MESHLET_TRIANGLES = 11,
+	MESH_QUANTIZATION = 12,	 // QuantizationError per mesh, for 'VertexFormat::PACKED'
+	VERTEX_POSITIONS = 13,	 // Streams of 'VertexLayout::STREAMS' in 'VertexStream' order, VERTICES is empty then
+	VERTEX_NORMALS_TANGENTS = 14,
+	VERTEX_UVS = 15,
+	VERTEX_BONE_WEIGHTS = 16,
+	MESH_LODS = 17,		  // MeshLod[], levels of each mesh are referenced by 'MeshRecord::lodOffset'
+	CLUSTERS = 18,		  // Cluster[], hierarchy of each mesh is referenced by 'MeshRecord::clusterOffset'
+	CLUSTER_GROUPS = 19,  // ClusterGroup[]
+	MESHLET_CONES = 20,	  // MeshletCone[], empty or one per meshlet
+	MESHLET_SETS = 21,	  // MeshletLimits[] of each meshlet set, 'MeshRecord' ranges are of the first one
+	MESHLET_SET_RANGES = 22,  // MeshletRanges[] of each mesh in the sets after the first one, set by set
+	INDEX_BATCHES = 23,		  // IndexBatch[], batches of each mesh are referenced by 'MeshRecord::indexBatchOffset'
+	INDICES = 24,			  // uint32_t[] triangle lists of the index batches
+	MESH_STATISTICS = 25,	  // MeshStatistics[], empty or one per mesh
+	INDICES16 = 26			  // uint16_t[] triangle lists of the index batches, stored instead of INDICES
+};
+
+enum class SectionEncoding : uint32_t
+{
+	RAW = 0,			// Stored as is, can be used in place
+	DEFLATE = 1,		// Single zlib stream
+	DEFLATE_BLOCKS = 2,	// BLOCK_TABLE, independent zlib streams of 'blockSize' decoded bytes and their sizes, decoded in parallel
+	MESHOPT = 3			// CODEC_HEADER and meshoptimizer codec stream, stored with 'CODEC_HEADER::encoding'
+};
+
+enum class SectionCodec : uint32_t
+{
+	VERTEX_BUFFER = 0,	 // meshopt_encodeVertexBuffer
+	INDEX_SEQUENCE = 1,	 // meshopt_encodeIndexSequence of 32-bit indices
+	INDEX_BUFFER = 2	 // meshopt_encodeIndexBuffer of 16 or 32-bit triangle list indices, may rotate the triangles
+};
+
+struct SECTION
+{
+	SectionID id;
+	SectionEncoding encoding;
+	uint64_t offset;	// From the beginning of the file
+	uint64_t size;		// Stored size
+	uint64_t baseSize;	// Decoded size
+};
+
+// Followed by the blocks themselves and 'uint32_t' stored size of each block
+struct BLOCK_TABLE
+{
+	uint32_t blockSize;	 // Decoded size of each block except the last one
+	uint32_t blockCount;
+};
+
+struct CODEC_HEADER
+{
+	SectionCodec codec;
+	SectionEncoding encoding;  // Encoding of the codec stream, except MESHOPT
+	uint32_t elementSize;	   // Vertex or index size
+	uint32_t reserved;
+	uint64_t encodedSize;  // Codec stream size
+};
+
+struct MODEL_RECORD
+{
+	StringRef name;
+	StringRef copyright;
+	StringRef generator;
+	BoundingSphere bounds;
+};
+
+constexpr inline uint64_t SECTION_ALIGNMENT = 64;
+constexpr inline size_t VIEW_ALIGNMENT = alignof(uint64_t);	 // Of the view buffer, records in place hold 64-bit fields
+constexpr inline uint32_t DEFLATE_BLOCK_SIZE = 1024 * 1024;
+constexpr inline uint64_t MAX_DEFLATE_RATIO = 1032;  // Decoded to stored size of a zlib stream
+constexpr inline uint64_t MAX_CODEC_RATIO = 1024;	 // Decoded to encoded size, reached by the vertex codec on constant vertices
+
+static_assert(sizeof(HEADER) == 24 && sizeof(SECTION) == 32 && sizeof(BLOCK_TABLE) == 8 && sizeof(CODEC_HEADER) == 24 &&
+			  sizeof(MODEL_RECORD) == 28);
+static_assert(sizeof(Vertex) == 44 && sizeof(WeightedVertex) == 76 && sizeof(Meshlet) == 32 && sizeof(MeshLod) == 12);
+static_assert(sizeof(Cluster) == 12 && sizeof(ClusterGroup) == 20 && sizeof(MeshletCone) == 32);
+static_assert(sizeof(MeshletLimits) == 8 && sizeof(MeshletRanges) == 48 && sizeof(IndexBatch) == 16);
+static_assert(sizeof(MeshQuality) == 16 && sizeof(MeshStatistics) == 64);
+static_assert(sizeof(PackedVertex) == 20 && sizeof(PackedWeightedVertex) == 32 && sizeof(QuantizationError) == 20);
+static_assert(sizeof(TextureRecord) == 8 && sizeof(SamplerRecord) == 12 && sizeof(MaterialRecord) == 56);
+static_assert(sizeof(MeshRecord) == 96 && sizeof(MeshHierarchyRecord) == 76 && sizeof(BoneRecord) == 136);
+static_assert(std::is_trivially_copyable_v<MeshRecord> && std::is_trivially_copyable_v<MeshHierarchyRecord> &&
+			  std::is_trivially_copyable_v<BoneRecord> && std::is_trivially_copyable_v<MaterialRecord>);
+
 static void send_log_message(Logger* logger, const std::string& txt)
 {
 	if (logger && !txt.empty())
@@ -521,1281 +811,4993 @@ bool HasImporter()
 #endif
 }
 
-static constexpr size_t aligned_size(size_t size, size_t alignment)
+static constexpr uint64_t aligned_offset(uint64_t offset, uint64_t alignment)
 {
-	return (size + alignment - 1) & ~(alignment - 1);
+	return (offset + alignment - 1) & ~(alignment - 1);
 }
 
-static std::optional<std::string> load_file_content(const char* filename)
+static uint32_t resolve_thread_count(uint32_t threadCount)
 {
-	std::ifstream file(filename, std::ios::binary);
-	if (!file.is_open()) return std::nullopt;
+	if (threadCount > 0) return threadCount;
 
-	file.seekg(0, std::ios::end);
-	const size_t fileSize = static_cast<size_t>(file.tellg());
-	if (fileSize == 0) return std::string();
-
-	file.seekg(0, std::ios::beg);
-	std::string content(fileSize, '\0');
-	file.read(content.data(), fileSize);
-	return content;
+	const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 0 ? hardwareThreads : 1;
 }
 
-#ifdef CXMF_INCLUDE_IMPORTER
+static std::pmr::memory_resource* resolve_memory_resource(std::pmr::memory_resource* resource)
+{
+	return resource ? resource : std::pmr::get_default_resource();
+}
 
-class CXMFAssimpScopeLogStream final : public Assimp::LogStream
+// Worker threads shared by every 'parallel_for', started as calls ask for them and kept until exit.
+// A job is taken by the calling thread and by idle workers, each of them takes indices until none are left,
+// so uneven tasks balance out. The caller only waits for the workers that joined its job, so jobs can be nested.
+class WorkerPool
 {
-private:
-	static constexpr uint32_t ErrFlags = Assimp::Logger::ErrorSeverity::Warn | Assimp::Logger::ErrorSeverity::Err;
+public:
+	struct Job
+	{
+		void (*run)(const void* task, size_t index);
+		const void* task;
+		size_t count;
+		std::atomic<size_t> next;
+		uint32_t freeSlots;	 // Workers that may still join
+		uint32_t workers;	 // Workers running the job
+
+		void runAll()
+		{
+			size_t i = next.fetch_add(1, std::memory_order_relaxed);
+			for (; i < count; i = next.fetch_add(1, std::memory_order_relaxed)) run(task, i);
+		}
+	};
 
 private:
-	Logger* m_Logger;
+	std::mutex m_Mutex;
+	std::condition_variable m_JobQueued;
+	std::condition_variable m_JobFinished;
+	std::vector<Job*> m_Jobs;
+	std::vector<std::thread> m_Threads;
+	bool m_Stop;
 
 public:
-	CXMFAssimpScopeLogStream() = delete;
-
-	explicit CXMFAssimpScopeLogStream(Logger* logger)
-		: m_Logger(logger)
+	WorkerPool()
+		: m_Stop(false)
 	{
-		if (m_Logger) Assimp::DefaultLogger::get()->attachStream(this, ErrFlags);
+		//
 	}
 
-	~CXMFAssimpScopeLogStream() override
+	~WorkerPool()
 	{
-		if (m_Logger) Assimp::DefaultLogger::get()->detachStream(this, ErrFlags);
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_JobQueued.notify_all();
+		for (std::thread& thread : m_Threads) thread.join();
 	}
 
-	void write(const char* message) override
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	static WorkerPool& instance()
 	{
-		if (m_Logger) m_Logger->write(message);
+		static WorkerPool pool;
+		return pool;
 	}
-};
 
-
-
-enum class SamplerMagFilter : unsigned int
-{
-	SamplerMagFilter_Nearest = 9728,
-	SamplerMagFilter_Linear = 9729
+	// Start workers until there are 'threadCount' of them, return how many there are
+	size_t reserve(size_t threadCount)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		while (m_Threads.size() < threadCount)
+		{
+			try
+			{
+				m_Threads.emplace_back([this]() { workerLoop(); });
+			}
+			catch (const std::system_error&)
+			{
+				break;	// Work with threads already started
+			}
+		}
+		return m_Threads.size();
+	}
+
+	// Run the job on the calling thread and up to 'job.freeSlots' workers, return once every index is done
+	void run(Job& job)
+	{
+		const uint32_t slots = job.freeSlots;  // Workers change it once the job is queued
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push_back(&job);
+		}
+		if (slots == 1)
+			m_JobQueued.notify_one();
+		else
+			m_JobQueued.notify_all();
+
+		job.runAll();
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		remove(job);
+		m_JobFinished.wait(lock, [&]() { return job.workers == 0; });
+	}
+
+private:
+	void remove(Job& job)
+	{
+		const auto _It = std::find(m_Jobs.begin(), m_Jobs.end(), &job);
+		if (_It != m_Jobs.end()) m_Jobs.erase(_It);
+	}
+
+	void workerLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (true)
+		{
+			m_JobQueued.wait(lock, [&]() { return m_Stop || !m_Jobs.empty(); });
+			if (m_Stop) return;
+
+			Job& job = *m_Jobs.front();
+			if (--job.freeSlots == 0) remove(job);
+			++job.workers;
+
+			lock.unlock();
+			job.runAll();
+			lock.lock();
+
+			// All indices are taken once 'runAll' returns, nobody else needs to join
+			remove(job);
+			if (--job.workers == 0) m_JobFinished.notify_all();
+		}
+	}
 };
 
-enum class SamplerMinFilter : unsigned int
+// Run 'task(index)' for every index in [0, count) on up to 'threadCount' threads, including the calling one
+template <typename _Fn>
+static void parallel_for(size_t count, uint32_t threadCount, const _Fn& task)
 {
-	SamplerMinFilter_Nearest = 9728,
-	SamplerMinFilter_Linear = 9729,
-	SamplerMinFilter_Nearest_Mipmap_Nearest = 9984,
-	SamplerMinFilter_Linear_Mipmap_Nearest = 9985,
-	SamplerMinFilter_Nearest_Mipmap_Linear = 9986,
-	SamplerMinFilter_Linear_Mipmap_Linear = 9987
-};
+	size_t workerCount = std::min<size_t>(count, resolve_thread_count(threadCount));
+	if (workerCount > 1) workerCount = std::min(workerCount, WorkerPool::instance().reserve(workerCount - 1) + 1);
+	if (workerCount <= 1)
+	{
+		for (size_t i = 0; i < count; ++i) task(i);
+		return;
+	}
+
+	WorkerPool::Job job;
+	job.run = [](const void* fn, size_t index) { (*static_cast<const _Fn*>(fn))(index); };
+	job.task = &task;
+	job.count = count;
+	job.next.store(0, std::memory_order_relaxed);
+	job.freeSlots = static_cast<uint32_t>(workerCount - 1);
+	job.workers = 0;
+	WorkerPool::instance().run(job);
+}
 
 
 
-struct BoundingBox
+// Read-only memory-mapped file
+
+class MappedFile
 {
-	glm::vec3 min;
-	glm::vec3 max;
+private:
+	const uint8_t* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	HANDLE m_File;
+	HANDLE m_Mapping;
+#endif
 
-	BoundingBox()
-		: min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max())
+public:
+	MappedFile()
+		: m_Data(nullptr),
+		  m_Size(0)
+#ifdef _WIN32
+		  ,
+		  m_File(INVALID_HANDLE_VALUE),
+		  m_Mapping(nullptr)
+#endif
 	{}
 
-	BoundingSphere getSphere() const
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile()
 	{
-		const glm::vec3 center = (min + max) * 0.5F;
-		const float radius = glm::length((max - min) * 0.5F);
+		close();
+	}
 
-		BoundingSphere sphere;
-		sphere.center[0] = center[0];
-		sphere.center[1] = center[1];
-		sphere.center[2] = center[2];
-		sphere.radius = radius;
-		return sphere;
+	bool open(const char* filename)
+	{
+		close();
+
+#ifdef _WIN32
+		m_File = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_File == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(m_File, &fileSize))
+		{
+			close();
+			return false;
+		}
+
+		m_Size = static_cast<size_t>(fileSize.QuadPart);
+		if (m_Size == 0) return true;
+
+		m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_Mapping)
+		{
+			close();
+			return false;
+		}
+
+		m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!m_Data)
+		{
+			close();
+			return false;
+		}
+#else
+		const int fd = ::open(filename, O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			::close(fd);
+			return false;
+		}
+
+		m_Size = static_cast<size_t>(st.st_size);
+		if (m_Size > 0)
+		{
+			void* const mapping = ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapping == MAP_FAILED)
+			{
+				::close(fd);
+				m_Size = 0;
+				return false;
+			}
+			m_Data = static_cast<const uint8_t*>(mapping);
+		}
+		::close(fd);
+#endif
+		return true;
+	}
+
+	void close()
+	{
+#ifdef _WIN32
+		if (m_Data) UnmapViewOfFile(m_Data);
+		if (m_Mapping) CloseHandle(m_Mapping);
+		if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+		m_File = INVALID_HANDLE_VALUE;
+		m_Mapping = nullptr;
+#else
+		if (m_Data) ::munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	// Start reading the whole file in background, so later accesses don't block on page faults
+	void prefetch() const
+	{
+		if (!m_Data) return;
+#ifdef _WIN32
+	#if _WIN32_WINNT >= 0x0602
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = const_cast<uint8_t*>(m_Data);
+		range.NumberOfBytes = m_Size;
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	#endif
+#else
+		::madvise(const_cast<uint8_t*>(m_Data), m_Size, MADV_WILLNEED);
+#endif
+	}
+
+	const uint8_t* data() const
+	{
+		return m_Data;
+	}
+
+	size_t size() const
+	{
+		return m_Size;
 	}
 };
 
-static void convertAssimpMatrixToGLM(glm::mat4& mat, const aiMatrix4x4& assimpMat)
+static std::string trim_file_path(const char* filePath)
 {
-	for (int row = 0; row < 4; ++row)
+	std::string str = filePath;
+	while (!str.empty() && std::isspace(static_cast<unsigned char>(str.back())))
+		str.pop_back();
+	return str;
+}
+
+class DefaultOutputStream final : public OutputStream
+{
+private:
+	std::ostream& m_Stream;
+
+public:
+	explicit DefaultOutputStream(std::ostream& stream)
+		: m_Stream(stream)
+	{}
+
+	~DefaultOutputStream() override = default;
+
+	bool write(const void* data, size_t sizeBytes) override
 	{
-		for (int col = 0; col < 4; ++col)
+		m_Stream.write(static_cast<const char*>(data), sizeBytes);
+		return m_Stream.good();
+	}
+};
+
+
+
+// Sections
+
+// String table: 'uint32_t' string count, 'count + 1' 'uint32_t' offsets into the characters, characters of the strings.
+// String 'id' spans [offsets[id], offsets[id + 1]), identical strings are stored once and share their id.
+class StringTableWriter
+{
+private:
+	std::unordered_map<std::string, uint32_t> m_Ids;
+	std::vector<uint32_t> m_Offsets = {0};
+	std::string m_Characters;
+	std::string m_Content;
+
+public:
+	StringRef add(std::string_view str)
+	{
+		const auto [it, inserted] = m_Ids.try_emplace(std::string(str), static_cast<uint32_t>(m_Ids.size()));
+		if (inserted)
 		{
-			mat[col][row] = assimpMat[row][col];
+			m_Characters.append(str);
+			m_Offsets.push_back(static_cast<uint32_t>(m_Characters.length()));
 		}
+
+		StringRef ref;
+		ref.id = it->second;
+		return ref;
+	}
+
+	// Size of the characters of all unique strings
+	size_t length() const
+	{
+		return m_Characters.length();
+	}
+
+	// Serialize the table, call once all strings are added
+	const std::string& content()
+	{
+		const uint32_t count = static_cast<uint32_t>(m_Ids.size());
+		m_Content.clear();
+		m_Content.reserve(sizeof(uint32_t) * (count + 2) + m_Characters.length());
+		m_Content.append(reinterpret_cast<const char*>(&count), sizeof(count));
+		m_Content.append(reinterpret_cast<const char*>(m_Offsets.data()), m_Offsets.size() * sizeof(uint32_t));
+		m_Content.append(m_Characters);
+		return m_Content;
 	}
+};
+
+// Find string 'ref' in the serialized string table, false if the table is malformed or the id is out of it
+static bool find_string(std::string_view table, const StringRef& ref, std::string_view& out)
+{
+	uint32_t count = 0;
+	if (table.length() >= sizeof(count))  //
+		std::memcpy(&count, table.data(), sizeof(count));
+
+	const uint64_t charactersOffset = (static_cast<uint64_t>(count) + 2) * sizeof(uint32_t);
+	if (ref.id >= count || charactersOffset > table.length())  //
+		return false;
+
+	uint32_t range[2];
+	std::memcpy(range, table.data() + (static_cast<size_t>(ref.id) + 1) * sizeof(uint32_t), sizeof(range));
+
+	const std::string_view characters = table.substr(static_cast<size_t>(charactersOffset));
+	if (range[0] > range[1] || range[1] > characters.length())	//
+		return false;
+
+	out = characters.substr(range[0], range[1] - range[0]);
+	return true;
 }
 
-static void convertAssimpMatrixToCXMF(Mat4x4& mat, const aiMatrix4x4& assimpMat)
+template <typename _StrTy>
+static bool read_string(std::string_view table, const StringRef& ref, _StrTy& out)
 {
-	for (int row = 0; row < 4; ++row)
+	std::string_view str;
+	if (!find_string(table, ref, str))	//
+		return false;
+
+	out.assign(str);
+	return true;
+}
+
+static TextureRecord pack_record(const Texture& tex, StringTableWriter& strings)
+{
+	TextureRecord rec;
+	rec.path = strings.add(tex.path);
+	rec.samplerIndex = tex.samplerIndex;
+	return rec;
+}
+static bool unpack_record(const TextureRecord& rec, std::string_view strings, Texture& tex)
+{
+	tex.samplerIndex = rec.samplerIndex;
+	return read_string(strings, rec.path, tex.path);
+}
+
+static SamplerRecord pack_record(const Sampler& sampler, StringTableWriter& strings)
+{
+	SamplerRecord rec;
+	std::memset(&rec, 0, sizeof(rec));
+	rec.name = strings.add(sampler.name);
+	rec.magFilter = sampler.magFilter;
+	rec.minFilter = sampler.minFilter;
+	rec.mipmapMode = sampler.mipmapMode;
+	rec.addressModeU = sampler.addressModeU;
+	rec.addressModeV = sampler.addressModeV;
+	return rec;
+}
+static bool unpack_record(const SamplerRecord& rec, std::string_view strings, Sampler& sampler)
+{
+	sampler.magFilter = rec.magFilter;
+	sampler.minFilter = rec.minFilter;
+	sampler.mipmapMode = rec.mipmapMode;
+	sampler.addressModeU = rec.addressModeU;
+	sampler.addressModeV = rec.addressModeV;
+	return read_string(strings, rec.name, sampler.name);
+}
+
+static MaterialRecord pack_record(const Material& material, StringTableWriter& strings)
+{
+	MaterialRecord rec;
+	std::memset(&rec, 0, sizeof(rec));
+	rec.name = strings.add(material.name);
+	std::memcpy(rec.baseColorFactor, material.baseColorFactor, sizeof(rec.baseColorFactor));
+	rec.roughnessFactor = material.roughnessFactor;
+	rec.metallicFactor = material.metallicFactor;
+	rec.ambientOcclusionFactor = material.ambientOcclusionFactor;
+	std::memcpy(rec.emissiveFactor, material.emissiveFactor, sizeof(rec.emissiveFactor));
+	rec.textureIndex = material.textureIndex;
+	rec.alphaCutoff = material.alphaCutoff;
+	rec.alphaMode = material.alphaMode;
+	rec.doubleSided = material.doubleSided ? 1 : 0;
+	rec.shadeless = material.shadeless ? 1 : 0;
+	return rec;
+}
+static bool unpack_record(const MaterialRecord& rec, std::string_view strings, Material& material)
+{
+	std::memcpy(material.baseColorFactor, rec.baseColorFactor, sizeof(material.baseColorFactor));
+	material.roughnessFactor = rec.roughnessFactor;
+	material.metallicFactor = rec.metallicFactor;
+	material.ambientOcclusionFactor = rec.ambientOcclusionFactor;
+	std::memcpy(material.emissiveFactor, rec.emissiveFactor, sizeof(material.emissiveFactor));
+	material.textureIndex = rec.textureIndex;
+	material.alphaCutoff = rec.alphaCutoff;
+	material.alphaMode = rec.alphaMode;
+	material.doubleSided = rec.doubleSided != 0;
+	material.shadeless = rec.shadeless != 0;
+	return read_string(strings, rec.name, material.name);
+}
+
+static MeshRecord pack_record(const Mesh& mesh, StringTableWriter& strings)
+{
+	MeshRecord rec;
+	std::memset(&rec, 0, sizeof(rec));
+	rec.name = strings.add(mesh.name);
+	rec.bounds = mesh.bounds;
+	rec.vertexOffset = mesh.vertexOffset;
+	rec.meshletVertexOffset = mesh.meshletVertexOffset;
+	rec.meshletTriangleOffset = mesh.meshletTriangleOffset;
+	rec.vertexCount = mesh.vertexCount;
+	rec.meshletOffset = mesh.meshletOffset;
+	rec.meshletCount = mesh.meshletCount;
+	rec.materialIndex = mesh.materialIndex;
+	rec.lodOffset = mesh.lodOffset;
+	rec.lodCount = mesh.lodCount;
+	rec.clusterOffset = mesh.clusterOffset;
+	rec.clusterCount = mesh.clusterCount;
+	rec.clusterGroupOffset = mesh.clusterGroupOffset;
+	rec.clusterGroupCount = mesh.clusterGroupCount;
+	rec.indexBatchOffset = mesh.indexBatchOffset;
+	rec.indexBatchCount = mesh.indexBatchCount;
+	return rec;
+}
+static bool unpack_record(const MeshRecord& rec, std::string_view strings, Mesh& mesh)
+{
+	mesh.bounds = rec.bounds;
+	mesh.vertexOffset = rec.vertexOffset;
+	mesh.meshletVertexOffset = rec.meshletVertexOffset;
+	mesh.meshletTriangleOffset = rec.meshletTriangleOffset;
+	mesh.vertexCount = rec.vertexCount;
+	mesh.meshletOffset = rec.meshletOffset;
+	mesh.meshletCount = rec.meshletCount;
+	mesh.materialIndex = rec.materialIndex;
+	mesh.lodOffset = rec.lodOffset;
+	mesh.lodCount = rec.lodCount;
+	mesh.clusterOffset = rec.clusterOffset;
+	mesh.clusterCount = rec.clusterCount;
+	mesh.clusterGroupOffset = rec.clusterGroupOffset;
+	mesh.clusterGroupCount = rec.clusterGroupCount;
+	mesh.indexBatchOffset = rec.indexBatchOffset;
+	mesh.indexBatchCount = rec.indexBatchCount;
+	return read_string(strings, rec.name, mesh.name);
+}
+
+static MeshletRanges get_meshlet_ranges(const Mesh& mesh)
+{
+	MeshletRanges ranges;
+	ranges.meshletVertexOffset = mesh.meshletVertexOffset;
+	ranges.meshletTriangleOffset = mesh.meshletTriangleOffset;
+	ranges.meshletOffset = mesh.meshletOffset;
+	ranges.meshletCount = mesh.meshletCount;
+	ranges.lodOffset = mesh.lodOffset;
+	ranges.lodCount = mesh.lodCount;
+	ranges.clusterOffset = mesh.clusterOffset;
+	ranges.clusterCount = mesh.clusterCount;
+	ranges.clusterGroupOffset = mesh.clusterGroupOffset;
+	ranges.clusterGroupCount = mesh.clusterGroupCount;
+	return ranges;
+}
+static void set_meshlet_ranges(Mesh& mesh, const MeshletRanges& ranges)
+{
+	mesh.meshletVertexOffset = ranges.meshletVertexOffset;
+	mesh.meshletTriangleOffset = ranges.meshletTriangleOffset;
+	mesh.meshletOffset = ranges.meshletOffset;
+	mesh.meshletCount = ranges.meshletCount;
+	mesh.lodOffset = ranges.lodOffset;
+	mesh.lodCount = ranges.lodCount;
+	mesh.clusterOffset = ranges.clusterOffset;
+	mesh.clusterCount = ranges.clusterCount;
+	mesh.clusterGroupOffset = ranges.clusterGroupOffset;
+	mesh.clusterGroupCount = ranges.clusterGroupCount;
+}
+
+static MeshHierarchyRecord pack_record(const MeshHierarchy& mhi, StringTableWriter& strings)
+{
+	MeshHierarchyRecord rec;
+	rec.name = strings.add(mhi.name);
+	rec.localTransform = mhi.localTransform;
+	rec.meshIndex = mhi.meshIndex;
+	rec.parentIndex = mhi.parentIndex;
+	return rec;
+}
+static bool unpack_record(const MeshHierarchyRecord& rec, std::string_view strings, MeshHierarchy& mhi)
+{
+	mhi.localTransform = rec.localTransform;
+	mhi.meshIndex = rec.meshIndex;
+	mhi.parentIndex = rec.parentIndex;
+	return read_string(strings, rec.name, mhi.name);
+}
+
+static BoneRecord pack_record(const Bone& bone, StringTableWriter& strings)
+{
+	BoneRecord rec;
+	rec.name = strings.add(bone.name);
+	rec.inverseBindTransform = bone.inverseBindTransform;
+	rec.offsetMatrix = bone.offsetMatrix;
+	rec.parentIndex = bone.parentIndex;
+	return rec;
+}
+static bool unpack_record(const BoneRecord& rec, std::string_view strings, Bone& bone)
+{
+	bone.inverseBindTransform = rec.inverseBindTransform;
+	bone.offsetMatrix = rec.offsetMatrix;
+	bone.parentIndex = rec.parentIndex;
+	return read_string(strings, rec.name, bone.name);
+}
+
+template <typename _Ty>
+static auto pack_records(const std::pmr::vector<_Ty>& values, StringTableWriter& strings)
+{
+	std::vector<decltype(pack_record(values[0], strings))> records;
+	records.reserve(values.size());
+	for (const _Ty& v : values)
+		records.push_back(pack_record(v, strings));
+	return records;
+}
+
+
+
+// Vertex quantization
+
+// Index of the mesh each vertex of [firstVertex, firstVertex + vertexCount) belongs to,
+// the last mesh wins for shared vertices, INVALID_INDEX if there is no mesh
+template <typename _MeshTy>
+static std::vector<uint32_t> vertex_owners(std::span<const _MeshTy> meshes, size_t firstVertex, size_t vertexCount)
+{
+	std::vector<uint32_t> owners(vertexCount, INVALID_INDEX);
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const size_t first = std::max<size_t>(meshes[i].vertexOffset, firstVertex);
+		const size_t last = std::min<size_t>(static_cast<size_t>(meshes[i].vertexOffset) + meshes[i].vertexCount, firstVertex + vertexCount);
+		if (first < last) std::fill(owners.begin() + (first - firstVertex), owners.begin() + (last - firstVertex), static_cast<uint32_t>(i));
+	}
+	return owners;
+}
+
+static void decode_oct(const int8_t (&packed)[4], float (&out)[3])
+{
+	const float scale = packed[2] != 0 ? 1.0f / static_cast<float>(packed[2]) : 0.0f;
+	float x = static_cast<float>(packed[0]) * scale;
+	float y = static_cast<float>(packed[1]) * scale;
+	const float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+	const float t = std::max(-z, 0.0f);
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+
+	const float length = std::sqrt(x * x + y * y + z * z);
+	const float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+	out[0] = x * invLength;
+	out[1] = y * invLength;
+	out[2] = z * invLength;
+}
+
+static void encode_oct(const float (&vector)[3], int8_t (&out)[4])
+{
+	const float data[4] = {vector[0], vector[1], vector[2], 0.0f};
+	meshopt_encodeFilterOct(out, 1, sizeof(out), 8, data);
+}
+
+template <typename _PackedTy, typename _VertexTy>
+static void pack_common(const _VertexTy& vertex, const BoundingSphere& bounds, _PackedTy& packed)
+{
+	const float scale = bounds.radius > 0.0f ? 1.0f / bounds.radius : 0.0f;
+	for (int i = 0; i < 3; ++i)
+	{
+		packed.position[i] = static_cast<int16_t>(meshopt_quantizeSnorm((vertex.position[i] - bounds.center[i]) * scale, 16));
+	}
+	packed.position[3] = 0;
+
+	encode_oct(vertex.normal, packed.normal);
+	encode_oct(vertex.tangent, packed.tangent);
+	packed.uv[0] = meshopt_quantizeHalf(vertex.uv[0]);
+	packed.uv[1] = meshopt_quantizeHalf(vertex.uv[1]);
+}
+
+template <typename _VertexTy, typename _PackedTy>
+static void unpack_common(const _PackedTy& packed, const BoundingSphere& bounds, _VertexTy& vertex)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		vertex.position[i] = static_cast<float>(packed.position[i]) * (bounds.radius / 32767.0f) + bounds.center[i];
+	}
+
+	decode_oct(packed.normal, vertex.normal);
+	decode_oct(packed.tangent, vertex.tangent);
+	vertex.uv[0] = meshopt_dequantizeHalf(packed.uv[0]);
+	vertex.uv[1] = meshopt_dequantizeHalf(packed.uv[1]);
+}
+
+static void pack_vertex(const Vertex& vertex, const BoundingSphere& bounds, PackedVertex& packed)
+{
+	pack_common(vertex, bounds, packed);
+}
+
+static void pack_vertex(const WeightedVertex& vertex, const BoundingSphere& bounds, PackedWeightedVertex& packed)
+{
+	pack_common(vertex, bounds, packed);
+	for (int i = 0; i < 4; ++i)
+	{
+		packed.boneID[i] = vertex.boneID[i] == INVALID_INDEX ? INVALID_INDEX16 : static_cast<uint16_t>(vertex.boneID[i]);
+		packed.weight[i] = static_cast<uint8_t>(meshopt_quantizeUnorm(vertex.weight[i], 8));
+	}
+}
+
+Vertex Dequantize(const PackedVertex& vertex, const BoundingSphere& bounds)
+{
+	Vertex result;
+	unpack_common(vertex, bounds, result);
+	return result;
+}
+
+WeightedVertex Dequantize(const PackedWeightedVertex& vertex, const BoundingSphere& bounds)
+{
+	WeightedVertex result;
+	unpack_common(vertex, bounds, result);
+	for (int i = 0; i < 4; ++i)
+	{
+		result.boneID[i] = vertex.boneID[i] == INVALID_INDEX16 ? INVALID_INDEX : vertex.boneID[i];
+		result.weight[i] = static_cast<float>(vertex.weight[i]) / 255.0f;
+	}
+	return result;
+}
+
+static float vector_angle(const float (&a)[3], const float (&b)[3])
+{
+	const float lengths = std::sqrt((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * (b[0] * b[0] + b[1] * b[1] + b[2] * b[2]));
+	if (lengths <= 0.0f) return 0.0f;  // Missing vector, nothing to compare
+
+	const float cosine = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / lengths;
+	return std::acos(std::clamp(cosine, -1.0f, 1.0f));
+}
+
+template <typename _VertexTy>
+static void accumulate_error(const _VertexTy& source, const _VertexTy& restored, QuantizationError& error)
+{
+	const float dx = source.position[0] - restored.position[0];
+	const float dy = source.position[1] - restored.position[1];
+	const float dz = source.position[2] - restored.position[2];
+	error.position = std::max(error.position, std::sqrt(dx * dx + dy * dy + dz * dz));
+	error.normal = std::max(error.normal, vector_angle(source.normal, restored.normal));
+	error.tangent = std::max(error.tangent, vector_angle(source.tangent, restored.tangent));
+	error.uv = std::max({error.uv, std::fabs(source.uv[0] - restored.uv[0]), std::fabs(source.uv[1] - restored.uv[1])});
+
+	if constexpr (std::is_same_v<_VertexTy, WeightedVertex>)
+	{
+		for (int i = 0; i < 4; ++i) error.weight = std::max(error.weight, std::fabs(source.weight[i] - restored.weight[i]));
+	}
+}
+
+// Pack the vertices relative to the bounds of their meshes and measure the error of each mesh
+template <typename _PackedTy, typename _VertexTy>
+static void quantize_vertices(const std::pmr::vector<_VertexTy>& vertices, const Model& model, std::vector<_PackedTy>& out,
+							  std::vector<QuantizationError>& errors)
+{
+	const std::vector<uint32_t> owners = vertex_owners(std::span<const Mesh>(model.meshes), 0, vertices.size());
+
+	out.resize(vertices.size());
+	errors.assign(model.meshes.size(), QuantizationError());
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		const uint32_t owner = owners[i];
+		const BoundingSphere& bounds = owner != INVALID_INDEX ? model.meshes[owner].bounds : model.bounds;
+		pack_vertex(vertices[i], bounds, out[i]);
+
+		if (owner != INVALID_INDEX)	 //
+			accumulate_error(vertices[i], Dequantize(out[i], bounds), errors[owner]);
+	}
+}
+
+// Restore the vertices of the meshes in parallel, 'packed' starts at 'firstVertex' of the model
+template <typename _PackedTy, typename _MeshTy, typename _ArrayTy>
+static void dequantize_vertices(std::span<const _PackedTy> packed, size_t firstVertex, std::span<const _MeshTy> meshes,
+								const BoundingSphere& modelBounds, uint32_t threadCount, _ArrayTy& out)
+{
+	constexpr size_t chunkSize = 64 * 1024;
+
+	const std::vector<uint32_t> owners = vertex_owners(meshes, firstVertex, packed.size());
+	out.resize(packed.size());
+	parallel_for((packed.size() + chunkSize - 1) / chunkSize, threadCount,
+				 [&](size_t chunk)
+				 {
+					 const size_t last = std::min(packed.size(), (chunk + 1) * chunkSize);
+					 for (size_t i = chunk * chunkSize; i < last; ++i)
+					 {
+						 const uint32_t owner = owners[i];
+						 out[i] = Dequantize(packed[i], owner != INVALID_INDEX ? meshes[owner].bounds : modelBounds);
+					 }
+				 });
+}
+
+
+
+// Vertex streams
+
+constexpr inline uint32_t VERTEX_STREAM_COUNT = 4;
+
+// Fields of the vertex stored in a stream element, 'count' is 0 if the vertex has no such stream
+struct VertexStreamFields
+{
+	uint32_t count;
+	uint32_t offsets[2];
+	uint32_t sizes[2];
+
+	uint32_t stride() const
+	{
+		return sizes[0] + (count > 1 ? sizes[1] : 0);
+	}
+};
+
+template <typename _VertexTy>
+static VertexStreamFields vertex_stream_fields(VertexStream stream)
+{
+	switch (stream)
+	{
+		case VertexStream::POSITION:
+			return {1, {offsetof(_VertexTy, position), 0}, {sizeof(_VertexTy::position), 0}};
+		case VertexStream::NORMAL_TANGENT:
+			return {2, {offsetof(_VertexTy, normal), offsetof(_VertexTy, tangent)},
+					{sizeof(_VertexTy::normal), sizeof(_VertexTy::tangent)}};
+		case VertexStream::UV:
+			return {1, {offsetof(_VertexTy, uv), 0}, {sizeof(_VertexTy::uv), 0}};
+		case VertexStream::BONE_WEIGHT:
+		{
+			if constexpr (requires { _VertexTy::boneID; })
+				return {2, {offsetof(_VertexTy, boneID), offsetof(_VertexTy, weight)}, {sizeof(_VertexTy::boneID), sizeof(_VertexTy::weight)}};
+			else
+				return {0, {0, 0}, {0, 0}};
+		}
+		default:
+			return {0, {0, 0}, {0, 0}};
+	}
+}
+
+static VertexStreamFields vertex_stream_fields(ModelType type, VertexFormat format, VertexStream stream)
+{
+	if (type == ModelType::STATIC)
+		return format == VertexFormat::PACKED ? vertex_stream_fields<PackedVertex>(stream) : vertex_stream_fields<Vertex>(stream);
+	if (type == ModelType::SKINNED)
+	{
+		return format == VertexFormat::PACKED ? vertex_stream_fields<PackedWeightedVertex>(stream)
+											  : vertex_stream_fields<WeightedVertex>(stream);
+	}
+	return {0, {0, 0}, {0, 0}};
+}
+
+static SectionID vertex_stream_section(uint32_t stream)
+{
+	return static_cast<SectionID>(static_cast<uint32_t>(SectionID::VERTEX_POSITIONS) + stream);
+}
+
+size_t GetVertexStreamStride(ModelType type, VertexFormat format, VertexStream stream)
+{
+	return vertex_stream_fields(type, format, stream).stride();
+}
+
+// Gather the fields of 'count' vertices of 'vertexSize' bytes into the stream elements
+static void split_vertex_stream(const uint8_t* vertices, size_t vertexSize, size_t count, const VertexStreamFields& fields,
+								uint8_t* stream)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint8_t* const vertex = vertices + i * vertexSize;
+		for (uint32_t f = 0; f < fields.count; ++f)
+		{
+			std::memcpy(stream, vertex + fields.offsets[f], fields.sizes[f]);
+			stream += fields.sizes[f];
+		}
+	}
+}
+
+// Scatter the stream elements back into the fields of 'count' vertices
+static void merge_vertex_stream(const uint8_t* stream, size_t vertexSize, size_t count, const VertexStreamFields& fields,
+								uint8_t* vertices)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint8_t* const vertex = vertices + i * vertexSize;
+		for (uint32_t f = 0; f < fields.count; ++f)
+		{
+			std::memcpy(vertex + fields.offsets[f], stream, fields.sizes[f]);
+			stream += fields.sizes[f];
+		}
+	}
+}
+
+
+
+// Parsed CXMF 1.1+ container, points into the model data
+// Header and section table are copied out of the buffer, so it needs no alignment unless sections are used in place
+struct Container
+{
+	const uint8_t* data;
+	size_t dataSize;
+	HEADER header;
+	std::vector<SECTION> sections;
+	uint32_t threadCount;  // For sections decoded in parallel
+
+	const SECTION* find(SectionID id) const
+	{
+		for (const SECTION& section : sections)
+		{
+			if (section.id == id)  //
+				return &section;
+		}
+		return nullptr;
+	}
+};
+
+static bool is_legacy_version(uint32_t version)
+{
+	return ((version >> 16) & 0xFF) == 0;
+}
+
+static bool check_model_version(const void* data, size_t dataSize, uint32_t& version, Logger* logger)
+{
+	if (!data || dataSize < sizeof(HEADER_1_0))	 //
+		return false;
+
+	HEADER_1_0 header;
+	std::memcpy(&header, data, sizeof(HEADER_1_0));
+	if (header.magic != MAGIC)
+	{
+		CXMF_LOG(logger, "Invalid model magic!");
+		return false;
+	}
+
+	uint32_t major, minor, patch;
+	DecodeVersion(header.version, major, minor, patch);
+	if (major != CXMF_VERSION_MAJOR || minor > CXMF_VERSION_MINOR)
+	{
+		CXMF_LOG(logger, "Incorrect model version {}.{}.{} | Supported: {}.0.X - {}.{}.X",  //
+				 major, minor, patch, CXMF_VERSION_MAJOR, CXMF_VERSION_MAJOR, CXMF_VERSION_MINOR);
+		return false;
+	}
+
+	version = header.version;
+	return true;
+}
+
+static bool check_header(const HEADER& header, Logger* logger)
+{
+	switch (static_cast<ModelType>(header.modelType))
+	{
+		case ModelType::STATIC:
+		case ModelType::SKINNED:
+			break;
+		default:
+		{
+			CXMF_LOG(logger, "Invalid model type!");
+			return false;
+		}
+	}
+
+	switch (static_cast<VertexFormat>(header.vertexFormat))
+	{
+		case VertexFormat::FLOAT:
+		case VertexFormat::PACKED:
+			break;
+		default:
+		{
+			CXMF_LOG(logger, "Invalid model vertex format!");
+			return false;
+		}
+	}
+
+	switch (static_cast<VertexLayout>(header.vertexLayout))
+	{
+		case VertexLayout::INTERLEAVED:
+		case VertexLayout::STREAMS:
+			break;
+		default:
+		{
+			CXMF_LOG(logger, "Invalid model vertex layout!");
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool open_container(Container& container, const void* data, size_t dataSize, Logger* logger)
+{
+	if (dataSize < sizeof(HEADER))
+	{
+		CXMF_LOG(logger, "Invalid model size!");
+		return false;
+	}
+
+	container.data = static_cast<const uint8_t*>(data);
+	container.dataSize = dataSize;
+	std::memcpy(&container.header, container.data, sizeof(HEADER));
+	container.sections.clear();
+	container.threadCount = 1;
+
+	if (!check_header(container.header, logger)) return false;
+
+	const uint64_t tableSize = static_cast<uint64_t>(container.header.sectionCount) * sizeof(SECTION);
+	if (tableSize > dataSize - sizeof(HEADER) || (dataSize - tableSize) % alignof(SECTION) != 0)
+	{
+		CXMF_LOG(logger, "Invalid model size!");
+		return false;
+	}
+
+	const uint64_t contentEnd = dataSize - tableSize;
+	container.sections.resize(container.header.sectionCount);
+	std::memcpy(container.sections.data(), container.data + contentEnd, static_cast<size_t>(tableSize));
+	for (const SECTION& section : container.sections)
+	{
+		if (section.offset > contentEnd || section.size > contentEnd - section.offset)
+		{
+			CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+			return false;
+		}
+	}
+	return true;
+}
+
+// Inflate the blocks of DEFLATE_BLOCKS section overlapping [offset, offset + size) of the decoded content
+static bool inflate_blocks(const Container& container, const SECTION& section, uint64_t offset, size_t size, void* dst, Logger* logger)
+{
+	const uint8_t* const src = container.data + section.offset;
+
+	BLOCK_TABLE table;
+	if (section.size < sizeof(BLOCK_TABLE))
+	{
+		CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+		return false;
+	}
+	std::memcpy(&table, src, sizeof(BLOCK_TABLE));
+
+	const uint64_t tableSize = sizeof(BLOCK_TABLE) + static_cast<uint64_t>(table.blockCount) * sizeof(uint32_t);
+	if (table.blockSize == 0 ||											   //
+		table.blockCount != (section.baseSize + table.blockSize - 1) / table.blockSize ||  //
+		tableSize > section.size || offset + size > section.baseSize)
+	{
+		CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+		return false;
+	}
+
+	const uint8_t* const blockSizes = src + section.size - static_cast<uint64_t>(table.blockCount) * sizeof(uint32_t);
+	std::vector<uint64_t> blockOffsets(static_cast<size_t>(table.blockCount) + 1);
+	blockOffsets[0] = sizeof(BLOCK_TABLE);
+	for (uint32_t i = 0; i < table.blockCount; ++i)
+	{
+		uint32_t blockSize;
+		std::memcpy(&blockSize, blockSizes + i * sizeof(uint32_t), sizeof(uint32_t));
+		blockOffsets[i + 1] = blockOffsets[i] + blockSize;
+		if (blockOffsets[i + 1] > section.size - (tableSize - sizeof(BLOCK_TABLE)))
+		{
+			CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+			return false;
+		}
+	}
+
+	if (blockOffsets.back() != section.size - (tableSize - sizeof(BLOCK_TABLE)))
+	{
+		CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+		return false;
+	}
+
+	if (size == 0) return true;
+
+	// Whole blocks are inflated right into the destination, partially requested ones through a temporary block
+	const uint64_t firstBlock = offset / table.blockSize;
+	const uint64_t endBlock = (offset + size - 1) / table.blockSize + 1;
+	std::atomic<int> error(Z_OK);
+	parallel_for(static_cast<size_t>(endBlock - firstBlock), container.threadCount,
+				 [&](size_t index)
+				 {
+					 const size_t i = static_cast<size_t>(firstBlock) + index;
+					 const uint64_t blockBegin = static_cast<uint64_t>(i) * table.blockSize;
+					 const uLongf expectedSize = static_cast<uLongf>(std::min<uint64_t>(table.blockSize, section.baseSize - blockBegin));
+					 const uint64_t copyBegin = std::max(blockBegin, offset);
+					 const uint64_t copyEnd = std::min(blockBegin + expectedSize, offset + size);
+					 uint8_t* const out = static_cast<uint8_t*>(dst) + (copyBegin - offset);
+
+					 std::vector<uint8_t> partial;
+					 const bool isWhole = copyBegin == blockBegin && copyEnd == blockBegin + expectedSize;
+					 if (!isWhole) partial.resize(expectedSize);
+
+					 uLongf blockSize = expectedSize;
+					 int err = uncompress(isWhole ? out : partial.data(), &blockSize, src + blockOffsets[i],
+										  static_cast<uLong>(blockOffsets[i + 1] - blockOffsets[i]));
+					 if (err == Z_OK && blockSize != expectedSize) err = Z_DATA_ERROR;
+					 if (err != Z_OK)
+					 {
+						 int noError = Z_OK;
+						 error.compare_exchange_strong(noError, err);
+						 return;
+					 }
+
+					 if (!isWhole)	//
+						 std::memcpy(out, partial.data() + (copyBegin - blockBegin), static_cast<size_t>(copyEnd - copyBegin));
+				 });
+
+	if (error.load() != Z_OK)
+	{
+		CXMF_LOG(logger, "ERROR: inflate ({})", error.load());
+		return false;
+	}
+	return true;
+}
+
+static bool check_codec(const CODEC_HEADER& codec, SectionID id, size_t dstSize, Logger* logger)
+{
+	// Decoded size is whole elements, a zero element size would divide by zero in the bounds
+	if (codec.elementSize == 0 || dstSize % codec.elementSize != 0 || codec.encoding == SectionEncoding::MESHOPT)
+	{
+		CXMF_LOG(logger, "Invalid model section {} codec!", static_cast<uint32_t>(id));
+		return false;
+	}
+
+	const size_t elementCount = dstSize / codec.elementSize;
+	size_t encodedBound = 0;
+	switch (codec.codec)
+	{
+		case SectionCodec::VERTEX_BUFFER:
+		{
+			if (codec.elementSize % 4 == 0 && codec.elementSize <= 256)	 //
+				encodedBound = meshopt_encodeVertexBufferBound(elementCount, codec.elementSize);
+			break;
+		}
+		case SectionCodec::INDEX_SEQUENCE:
+		{
+			if (codec.elementSize == sizeof(uint32_t))	//
+				encodedBound = meshopt_encodeIndexSequenceBound(elementCount, ~0u);
+			break;
+		}
+		case SectionCodec::INDEX_BUFFER:
+		{
+			if ((codec.elementSize == sizeof(uint16_t) || codec.elementSize == sizeof(uint32_t)) && elementCount % 3 == 0)  //
+				encodedBound = meshopt_encodeIndexBufferBound(elementCount, ~0u);
+			break;
+		}
+	}
+
+	if (encodedBound == 0 || codec.encodedSize > encodedBound)
+	{
+		CXMF_LOG(logger, "Invalid model section {} codec!", static_cast<uint32_t>(id));
+		return false;
+	}
+	return true;
+}
+
+// Most that the stored bytes of the encoding can expand to
+static uint64_t max_decoded_size(SectionEncoding encoding, uint64_t storedSize)
+{
+	switch (encoding)
+	{
+		case SectionEncoding::RAW:
+			return storedSize;
+		case SectionEncoding::DEFLATE:
+		case SectionEncoding::DEFLATE_BLOCKS:
+			return storedSize * MAX_DEFLATE_RATIO;
+		default:
+			return 0;
+	}
+}
+
+// Decoded size is bounded by the stored size, checked before the decoded content is allocated
+static bool check_decoded_size(const Container& container, const SECTION& section, Logger* logger)
+{
+	uint64_t maxSize = max_decoded_size(section.encoding, section.size);
+	if (section.encoding == SectionEncoding::MESHOPT && section.size >= sizeof(CODEC_HEADER))
+	{
+		CODEC_HEADER codec;
+		std::memcpy(&codec, container.data + section.offset, sizeof(CODEC_HEADER));
+		if (codec.encodedSize <= max_decoded_size(codec.encoding, section.size - sizeof(CODEC_HEADER)))	 //
+			maxSize = codec.encodedSize * MAX_CODEC_RATIO;
+	}
+
+	if (section.baseSize > maxSize)
+	{
+		CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+		return false;
+	}
+	return true;
+}
+
+// Decode the codec stream checked by 'check_codec'
+static bool decode_codec(const CODEC_HEADER& codec, SectionID id, const uint8_t* encoded, void* dst, size_t dstSize, Logger* logger)
+{
+	const size_t elementCount = dstSize / codec.elementSize;
+	const size_t encodedSize = static_cast<size_t>(codec.encodedSize);
+	int err = 0;
+	if (codec.codec == SectionCodec::VERTEX_BUFFER)
+	{
+		err = meshopt_decodeVertexBuffer(dst, elementCount, codec.elementSize, encoded, encodedSize);
+	}
+	else if (codec.codec == SectionCodec::INDEX_SEQUENCE)
+	{
+		err = meshopt_decodeIndexSequence(dst, elementCount, sizeof(uint32_t), encoded, encodedSize);
+	}
+	else
+	{
+		err = meshopt_decodeIndexBuffer(dst, elementCount, codec.elementSize, encoded, encodedSize);
+	}
+
+	if (err != 0)
+	{
+		CXMF_LOG(logger, "ERROR: meshopt decode ({}) of model section {}", err, static_cast<uint32_t>(id));
+		return false;
+	}
+	return true;
+}
+
+static bool decode_section(const Container& container, const SECTION& section, void* dst, size_t dstSize, Logger* logger)
+{
+	if (section.baseSize != dstSize)
+	{
+		CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+		return false;
+	}
+
+	const uint8_t* const src = container.data + section.offset;
+	switch (section.encoding)
+	{
+		case SectionEncoding::RAW:
+		{
+			if (section.size != dstSize)
+			{
+				CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+				return false;
+			}
+			if (dstSize > 0) std::memcpy(dst, src, dstSize);
+			return true;
+		}
+		case SectionEncoding::DEFLATE:
+		{
+			z_stream zlibStream;
+			std::memset(&zlibStream, 0, sizeof(z_stream));
+			int err = inflateInit(&zlibStream);
+			if (err != Z_OK)
+			{
+				CXMF_LOG(logger, "ERROR: inflateInit ({})", err);
+				return false;
+			}
+
+			// zlib counts in uInt, drive it in windows so the section is decoded in one pass whatever its size
+			constexpr size_t window = std::numeric_limits<uInt>::max();
+			const uint8_t* in = src;
+			size_t inLeft = static_cast<size_t>(section.size);
+			uint8_t* out = static_cast<uint8_t*>(dst);
+			size_t outLeft = dstSize;
+
+			do
+			{
+				if (zlibStream.avail_in == 0 && inLeft > 0)
+				{
+					zlibStream.next_in = const_cast<Bytef*>(in);
+					zlibStream.avail_in = static_cast<uInt>(std::min(inLeft, window));
+					in += zlibStream.avail_in;
+					inLeft -= zlibStream.avail_in;
+				}
+				if (zlibStream.avail_out == 0 && outLeft > 0)
+				{
+					zlibStream.next_out = out;
+					zlibStream.avail_out = static_cast<uInt>(std::min(outLeft, window));
+					out += zlibStream.avail_out;
+					outLeft -= zlibStream.avail_out;
+				}
+				err = inflate(&zlibStream, Z_NO_FLUSH);
+			} while (err == Z_OK ||
+					 (err == Z_BUF_ERROR && ((zlibStream.avail_in == 0 && inLeft > 0) || (zlibStream.avail_out == 0 && outLeft > 0))));
+
+			inflateEnd(&zlibStream);
+
+			if (err != Z_STREAM_END || outLeft > 0 || zlibStream.avail_out > 0)
+			{
+				CXMF_LOG(logger, "ERROR: inflate ({})", err);
+				return false;
+			}
+			return true;
+		}
+		case SectionEncoding::DEFLATE_BLOCKS:
+		{
+			return inflate_blocks(container, section, 0, dstSize, dst, logger);
+		}
+		case SectionEncoding::MESHOPT:
+		{
+			CODEC_HEADER codec;
+			if (section.size < sizeof(CODEC_HEADER))
+			{
+				CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+				return false;
+			}
+			std::memcpy(&codec, src, sizeof(CODEC_HEADER));
+
+			if (!check_codec(codec, section.id, dstSize, logger)) return false;
+
+			SECTION stream = section;
+			stream.encoding = codec.encoding;
+			stream.offset += sizeof(CODEC_HEADER);
+			stream.size -= sizeof(CODEC_HEADER);
+			stream.baseSize = codec.encodedSize;
+
+			// Stored codec stream is decoded in place
+			std::vector<uint8_t> encoded;
+			const uint8_t* encodedData = src + sizeof(CODEC_HEADER);
+			if (stream.encoding != SectionEncoding::RAW)
+			{
+				encoded.resize(static_cast<size_t>(codec.encodedSize));
+				if (!decode_section(container, stream, encoded.data(), encoded.size(), logger))	 //
+					return false;
+
+				encodedData = encoded.data();
+			}
+			else if (stream.size != stream.baseSize)
+			{
+				CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+				return false;
+			}
+
+			return decode_codec(codec, section.id, encodedData, dst, dstSize, logger);
+		}
+		default:
+		{
+			CXMF_LOG(logger, "Unknown encoding of model section {}!", static_cast<uint32_t>(section.id));
+			return false;
+		}
+	}
+}
+
+// Grow the array to hold 'end' bytes from its beginning, return its first byte
+template <typename _ArrayTy, typename _Ty = typename _ArrayTy::value_type>
+static uint8_t* grow_array(_ArrayTy& out, size_t end)
+{
+	const size_t count = (end + sizeof(_Ty) - 1) / sizeof(_Ty);
+	if (out.size() < count) out.resize(count);
+	return reinterpret_cast<uint8_t*>(out.data());
+}
+
+// Decode the section at the reader position into the array from the byte 'offset', the stored content of each encoding
+// is read exactly once and in order. The array grows as the content arrives, so a corrupt decoded size
+// fails at the end of the stream instead of being allocated up front.
+template <typename _ArrayTy>
+static bool stream_section(StreamReader& reader, const SECTION& section, _ArrayTy& out, size_t offset, Logger* logger)
+{
+	const size_t size = static_cast<size_t>(section.baseSize);
+	const auto grow = [&out, offset](size_t begin, size_t count) { return grow_array(out, offset + begin + count) + offset + begin; };
+
+	switch (section.encoding)
+	{
+		case SectionEncoding::RAW:
+		{
+			for (size_t begin = 0; begin < size; begin += StreamReader::WindowSize)
+			{
+				const size_t count = std::min(size - begin, StreamReader::WindowSize);
+				if (!reader.read(grow(begin, count), count))
+				{
+					CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+					return false;
+				}
+			}
+			return true;
+		}
+		case SectionEncoding::DEFLATE:
+		{
+			const int err = reader.inflate(size, grow);
+			if (err != Z_OK)
+			{
+				CXMF_LOG(logger, "ERROR: inflate ({})", err);
+				return false;
+			}
+			return true;
+		}
+		case SectionEncoding::DEFLATE_BLOCKS:
+		{
+			BLOCK_TABLE table;
+			if (!reader.read(&table, sizeof(BLOCK_TABLE)) || table.blockSize == 0 ||	 //
+				table.blockCount != (section.baseSize + table.blockSize - 1) / table.blockSize)
+			{
+				CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+				return false;
+			}
+
+			// Blocks follow each other, so they are inflated one by one as they arrive
+			for (uint32_t i = 0; i < table.blockCount; ++i)
+			{
+				const size_t blockBegin = static_cast<size_t>(i) * table.blockSize;
+				const int err = reader.inflate(std::min<size_t>(table.blockSize, size - blockBegin),	//
+											   [&grow, blockBegin](size_t begin, size_t count) { return grow(blockBegin + begin, count); });
+				if (err != Z_OK)
+				{
+					CXMF_LOG(logger, "ERROR: inflate ({})", err);
+					return false;
+				}
+			}
+
+			// Block sizes are only needed for random access
+			if (!reader.skip(static_cast<uint64_t>(table.blockCount) * sizeof(uint32_t)))
+			{
+				CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+				return false;
+			}
+			return true;
+		}
+		case SectionEncoding::MESHOPT:
+		{
+			CODEC_HEADER codec;
+			if (!reader.read(&codec, sizeof(CODEC_HEADER)))
+			{
+				CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+				return false;
+			}
+
+			if (!check_codec(codec, section.id, size, logger)) return false;
+
+			SECTION stream = section;
+			stream.encoding = codec.encoding;
+			stream.baseSize = codec.encodedSize;
+
+			std::vector<uint8_t> encoded;
+			if (!stream_section(reader, stream, encoded, 0, logger))  //
+				return false;
+
+			// Codecs can't expand the stream beyond the ratio, the decoded size is checked before it is allocated
+			if (size / MAX_CODEC_RATIO > encoded.size())
+			{
+				CXMF_LOG(logger, "Invalid model section {} codec!", static_cast<uint32_t>(section.id));
+				return false;
+			}
+			return decode_codec(codec, section.id, encoded.data(), grow(0, size), size, logger);
+		}
+		default:
+		{
+			CXMF_LOG(logger, "Unknown encoding of model section {}!", static_cast<uint32_t>(section.id));
+			return false;
+		}
+	}
+}
+
+// Decode the section right into the array, missing section gives an empty array
+template <typename _ArrayTy, typename _Ty = typename _ArrayTy::value_type>
+requires std::is_trivially_copyable_v<_Ty>
+static bool read_array_section(const Container& container, SectionID id, _ArrayTy& out, Logger* logger)
+{
+	out.clear();
+
+	const SECTION* const section = container.find(id);
+	if (!section) return true;
+
+	if (section->baseSize % sizeof(_Ty) != 0)
+	{
+		CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(id));
+		return false;
+	}
+
+	if (!check_decoded_size(container, *section, logger)) return false;
+
+	out.resize(static_cast<size_t>(section->baseSize / sizeof(_Ty)));
+	return decode_section(container, *section, out.data(), out.size() * sizeof(_Ty), logger);
+}
+
+// Decode the section at the reader position right into the array
+template <typename _ArrayTy, typename _Ty = typename _ArrayTy::value_type>
+requires std::is_trivially_copyable_v<_Ty>
+static bool stream_array_section(StreamReader& reader, const SECTION& section, _ArrayTy& out, Logger* logger)
+{
+	if (section.baseSize % sizeof(_Ty) != 0)
+	{
+		CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+		return false;
+	}
+
+	out.clear();
+	return stream_section(reader, section, out, 0, logger);
+}
+
+template <typename _RecTy, typename _ArrayTy>
+static bool read_record_section(const Container& container, SectionID id, std::string_view strings,	 //
+								_ArrayTy& out, Logger* logger)
+{
+	std::vector<_RecTy> records;
+	if (!read_array_section(container, id, records, logger))  //
+		return false;
+
+	out.clear();
+	out.reserve(records.size());
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		if (!unpack_record(records[i], strings, emplace_record(out)))
+		{
+			CXMF_LOG(logger, "Invalid string reference in model section {}!", static_cast<uint32_t>(id));
+			return false;
+		}
+	}
+	return true;
+}
+
+// Point the span right into the section, only raw sections can be used in place
+template <typename _Ty>
+static bool view_section(const Container& container, SectionID id, std::span<const _Ty>& out, Logger* logger)
+{
+	out = std::span<const _Ty>();
+
+	const SECTION* const section = container.find(id);
+	if (!section) return true;
+
+	if (section->encoding != SectionEncoding::RAW)
+	{
+		CXMF_LOG(logger, "Model section {} is encoded, view requires 'CompressionLevel::NONE' without codecs!",	 //
+				 static_cast<uint32_t>(id));
+		return false;
+	}
+
+	const uint8_t* const pointer = container.data + section->offset;
+	if (section->size != section->baseSize || section->size % sizeof(_Ty) != 0 ||	//
+		reinterpret_cast<uintptr_t>(pointer) % alignof(_Ty) != 0)
+	{
+		CXMF_LOG(logger, "Invalid model section {} layout!", static_cast<uint32_t>(id));
+		return false;
+	}
+
+	out = std::span<const _Ty>(reinterpret_cast<const _Ty*>(pointer), static_cast<size_t>(section->size / sizeof(_Ty)));
+	return true;
+}
+
+
+
+static uint64_t section_element_count(const Container& container, SectionID id, size_t elementSize)
+{
+	const SECTION* const section = container.find(id);
+	return section ? section->baseSize / elementSize : 0;
+}
+
+// Range of 'count' elements from 'first' lies within the section, checked before the range is allocated
+static bool check_section_range(const Container& container, SectionID id, uint64_t first, uint64_t count, size_t elementSize,
+								Logger* logger)
+{
+	const uint64_t elementCount = section_element_count(container, id, elementSize);
+	if (first > elementCount || count > elementCount - first)
+	{
+		CXMF_LOG(logger, "Invalid model section {} range!", static_cast<uint32_t>(id));
+		return false;
+	}
+	return true;
+}
+
+static uint64_t vertex_count(const Container& container, size_t vertexSize)
+{
+	if (static_cast<VertexLayout>(container.header.vertexLayout) == VertexLayout::INTERLEAVED)  //
+		return section_element_count(container, SectionID::VERTICES, vertexSize);
+
+	const VertexStreamFields fields = vertex_stream_fields(static_cast<ModelType>(container.header.modelType),  //
+														   static_cast<VertexFormat>(container.header.vertexFormat),
+														   VertexStream::POSITION);
+	return section_element_count(container, SectionID::VERTEX_POSITIONS, fields.stride());
+}
+
+// Interleaved vertices of the model, merged from the stream sections for 'VertexLayout::STREAMS'
+template <typename _ArrayTy, typename _Ty = typename _ArrayTy::value_type>
+static bool read_vertex_section(const Container& container, _ArrayTy& out, Logger* logger)
+{
+	if (static_cast<VertexLayout>(container.header.vertexLayout) == VertexLayout::INTERLEAVED)  //
+		return read_array_section(container, SectionID::VERTICES, out, logger);
+
+	out.resize(static_cast<size_t>(vertex_count(container, sizeof(_Ty))));
+
+	std::vector<uint8_t> stream;
+	for (uint32_t i = 0; i < VERTEX_STREAM_COUNT; ++i)
+	{
+		const VertexStreamFields fields = vertex_stream_fields<_Ty>(static_cast<VertexStream>(i));
+		if (fields.count == 0) continue;
+
+		if (!read_array_section(container, vertex_stream_section(i), stream, logger)) return false;
+
+		if (stream.size() != out.size() * fields.stride())
+		{
+			CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(vertex_stream_section(i)));
+			return false;
+		}
+		merge_vertex_stream(stream.data(), sizeof(_Ty), out.size(), fields, reinterpret_cast<uint8_t*>(out.data()));
+	}
+	return true;
+}
+
+
+
+// Meshlet sets
+
+// Largest set within the limits, a zero limit doesn't restrict its field, INVALID_INDEX if none fits
+static uint32_t find_meshlet_set(std::span<const MeshletLimits> sets, const MeshletLimits& limits)
+{
+	const uint32_t maxVertices = limits.maxVertices != 0 ? limits.maxVertices : std::numeric_limits<uint32_t>::max();
+	const uint32_t maxTriangles = limits.maxTriangles != 0 ? limits.maxTriangles : std::numeric_limits<uint32_t>::max();
+
+	uint32_t result = INVALID_INDEX;
+	for (uint32_t i = 0; i < sets.size(); ++i)
+	{
+		const MeshletLimits& set = sets[i];
+		if (set.maxVertices > maxVertices || set.maxTriangles > maxTriangles) continue;
+
+		if (result == INVALID_INDEX || set.maxTriangles > sets[result].maxTriangles ||
+			(set.maxTriangles == sets[result].maxTriangles && set.maxVertices > sets[result].maxVertices))
+		{
+			result = i;
+		}
+	}
+	return result;
+}
+
+// The meshes take the ranges of the selected set, it becomes the only one.
+// Models without recorded sets are kept as is, their limits are unknown.
+template <typename _Ty>
+static bool selectMeshletRanges(_Ty& target, const MeshletLimits& limits, Logger* logger)
+{
+	if ((limits.maxVertices == 0 && limits.maxTriangles == 0) || target.meshletSets.empty())	//
+		return true;
+
+	const uint32_t set = find_meshlet_set(target.meshletSets, limits);
+	if (set == INVALID_INDEX)
+	{
+		CXMF_LOG(logger, "No meshlet set of the model fits {} vertices and {} triangles!", limits.maxVertices, limits.maxTriangles);
+		return false;
+	}
+
+	if (set != 0)
+	{
+		const size_t first = (set - 1) * target.meshes.size();
+		for (size_t i = 0; i < target.meshes.size(); ++i) set_meshlet_ranges(target.meshes[i], target.meshletSetRanges[first + i]);
+	}
+
+	const MeshletLimits selected = target.meshletSets[set];
+	target.meshletSets.assign(1, selected);
+	target.meshletSetRanges.clear();
+	return true;
+}
+
+// Range [begin, end) of the array elements used by a meshlet set
+struct MeshletSpan
+{
+	uint64_t begin = std::numeric_limits<uint64_t>::max();
+	uint64_t end = 0;
+
+	void add(uint64_t offset, uint64_t count)
+	{
+		if (count == 0) return;
+
+		begin = std::min(begin, offset);
+		end = std::max(end, offset + count);
+	}
+
+	// Base of ranges relative to it, even if nothing is used at the base itself
+	void addBase(uint64_t offset)
+	{
+		begin = std::min(begin, offset);
+		end = std::max(end, offset);
+	}
+
+	// Offset of a range moved along with the span, empty ranges start at 0
+	uint64_t rebase(uint64_t offset, uint64_t count) const
+	{
+		return count == 0 ? 0 : offset - begin;
+	}
+
+	template <typename _ArrayTy>
+	void keep(_ArrayTy& array) const
+	{
+		if (begin >= end)
+		{
+			array.clear();
+		}
+		else
+		{
+			array.erase(array.begin() + static_cast<ptrdiff_t>(end), array.end());
+			array.erase(array.begin(), array.begin() + static_cast<ptrdiff_t>(begin));
+		}
+		array.shrink_to_fit();
+	}
+};
+
+// Sets are stored one after another, so the spans of the meshes hold only their set and the rest of the arrays is dropped
+static bool dropMeshletSets(Model& model, Logger* logger)
+{
+	MeshletSpan meshlets, lods, clusters, groups;
+	for (const Mesh& mesh : model.meshes)
+	{
+		meshlets.add(mesh.meshletOffset, mesh.meshletCount);
+		lods.add(mesh.lodOffset, mesh.lodCount);
+		clusters.add(mesh.clusterOffset, mesh.clusterCount);
+		groups.add(mesh.clusterGroupOffset, mesh.clusterGroupCount);
+
+		for (uint32_t i = 0; i < mesh.lodCount; ++i)
+		{
+			const MeshLod& lod = model.meshLods[mesh.lodOffset + i];
+			meshlets.add(lod.meshletOffset, lod.meshletCount);
+		}
+		for (uint32_t i = 0; i < mesh.clusterCount; ++i) meshlets.add(model.clusters[mesh.clusterOffset + i].meshletIndex, 1);
+	}
+
+	if (meshlets.end > model.meshlets.size())
+	{
+		CXMF_LOG(logger, "Invalid model section {} range!", static_cast<uint32_t>(SectionID::MESHLETS));
+		return false;
+	}
+
+	// Meshlets address the meshlet vertices and triangles relative to the ranges of their mesh
+	MeshletSpan vertices, triangles;
+	for (const Mesh& mesh : model.meshes)
+	{
+		if (mesh.meshletCount == 0 && mesh.lodCount == 0 && mesh.clusterCount == 0) continue;
+
+		vertices.addBase(mesh.meshletVertexOffset);
+		triangles.addBase(mesh.meshletTriangleOffset);
+		const auto addMeshlets = [&](uint32_t offset, uint32_t count)
+		{
+			for (uint32_t i = offset; i < offset + count; ++i)
+			{
+				const Meshlet& meshlet = model.meshlets[i];
+				vertices.add(mesh.meshletVertexOffset + meshlet.vertexOffset, meshlet.vertexCount);
+				triangles.add(mesh.meshletTriangleOffset + meshlet.triangleOffset, static_cast<uint64_t>(meshlet.triangleCount) * 3);
+			}
+		};
+
+		addMeshlets(mesh.meshletOffset, mesh.meshletCount);
+		for (uint32_t i = 0; i < mesh.lodCount; ++i)
+		{
+			const MeshLod& lod = model.meshLods[mesh.lodOffset + i];
+			addMeshlets(lod.meshletOffset, lod.meshletCount);
+		}
+		for (uint32_t i = 0; i < mesh.clusterCount; ++i) addMeshlets(model.clusters[mesh.clusterOffset + i].meshletIndex, 1);
+	}
+
+	if (vertices.end > model.meshletVertices.size() || triangles.end > model.meshletTriangles.size())
+	{
+		CXMF_LOG(logger, "Invalid model section {} range!", static_cast<uint32_t>(SectionID::MESHLET_VERTICES));
+		return false;
+	}
+
+	// Meshlet ranges of the meshes are rebased before the levels and clusters they reference
+	for (Mesh& mesh : model.meshes)
+	{
+		const bool hasMeshlets = mesh.meshletCount > 0 || mesh.lodCount > 0 || mesh.clusterCount > 0;
+		mesh.meshletVertexOffset = hasMeshlets ? mesh.meshletVertexOffset - vertices.begin : 0;
+		mesh.meshletTriangleOffset = hasMeshlets ? mesh.meshletTriangleOffset - triangles.begin : 0;
+		mesh.meshletOffset = static_cast<uint32_t>(meshlets.rebase(mesh.meshletOffset, mesh.meshletCount));
+		mesh.lodOffset = static_cast<uint32_t>(lods.rebase(mesh.lodOffset, mesh.lodCount));
+		mesh.clusterOffset = static_cast<uint32_t>(clusters.rebase(mesh.clusterOffset, mesh.clusterCount));
+		mesh.clusterGroupOffset = static_cast<uint32_t>(groups.rebase(mesh.clusterGroupOffset, mesh.clusterGroupCount));
+	}
+
+	for (MeshLod& lod : model.meshLods)
+	{
+		if (lod.meshletCount > 0 && lod.meshletOffset >= meshlets.begin) lod.meshletOffset -= static_cast<uint32_t>(meshlets.begin);
+	}
+	for (Cluster& cluster : model.clusters)
+	{
+		if (cluster.meshletIndex >= meshlets.begin) cluster.meshletIndex -= static_cast<uint32_t>(meshlets.begin);
+		if (cluster.group != INVALID_INDEX && cluster.group >= groups.begin) cluster.group -= static_cast<uint32_t>(groups.begin);
+		if (cluster.parentGroup != INVALID_INDEX && cluster.parentGroup >= groups.begin)
+			cluster.parentGroup -= static_cast<uint32_t>(groups.begin);
+	}
+
+	meshlets.keep(model.meshlets);
+	if (!model.meshletCones.empty()) meshlets.keep(model.meshletCones);
+	vertices.keep(model.meshletVertices);
+	triangles.keep(model.meshletTriangles);
+	lods.keep(model.meshLods);
+	clusters.keep(model.clusters);
+	groups.keep(model.clusterGroups);
+	return true;
+}
+
+// Only the selected set is kept in the model arrays
+static bool selectMeshletSet(Model& model, const MeshletLimits& limits, Logger* logger)
+{
+	const size_t setCount = model.meshletSets.size();
+	if (!selectMeshletRanges(model, limits, logger)) return false;
+
+	return setCount <= 1 || model.meshletSets.size() > 1 || dropMeshletSets(model, logger);
+}
+
+
+
+#ifdef CXMF_INCLUDE_IMPORTER
+
+// Conversion settings, the import cache key depends on them
+constexpr inline uint32_t ASSIMP_IMPORT_FLAGS = aiProcess_CalcTangentSpace |		//
+												aiProcess_JoinIdenticalVertices |	//
+												aiProcess_Triangulate |				//
+												aiProcess_GenNormals |				//
+												aiProcess_LimitBoneWeights |		//
+												aiProcess_ValidateDataStructure |	//
+												// aiProcess_ImproveCacheLocality |		 //
+												aiProcess_RemoveRedundantMaterials |  //
+												aiProcess_PopulateArmatureData |	  //
+												aiProcess_SortByPType |				  //
+												// aiProcess_OptimizeMeshes |			  //
+												// aiProcess_OptimizeGraph |			  //
+												aiProcess_FlipUVs |	 //
+												aiProcess_GenBoundingBoxes;
+constexpr inline int ASSIMP_MAX_BONE_WEIGHTS = 4;
+constexpr inline int ASSIMP_REMOVED_PRIMITIVES = aiPrimitiveType_POINT | aiPrimitiveType_LINE;
+constexpr inline float ASSIMP_RIGID_TOLERANCE = 1e-4f;	// 'GeometryDeduplication::RIGID', relative to the mesh size for positions
+constexpr inline float ASSIMP_LOD_MIN_REDUCTION = 0.9f;	// Index count of a level relative to the previous one, the chain ends above it
+constexpr inline float ASSIMP_LOD_ATTRIBUTE_WEIGHTS[] = {0.5f, 0.5f, 0.5f, 0.5f, 0.5f};	 // Normal x, y, z and uv x, y
+constexpr inline uint32_t ASSIMP_CLUSTER_GROUP_SIZE = 8;	   // Target meshlets per group of the cluster hierarchy
+constexpr inline float ASSIMP_CLUSTER_MIN_REDUCTION = 0.85f;  // Index count of a simplified group relative to the source one
+constexpr inline uint32_t ASSIMP_MESHLET_VERTEX_LIMIT = 256;	// Of meshopt_buildMeshlets, meshlet triangles address vertices in 8 bits
+constexpr inline uint32_t ASSIMP_MESHLET_TRIANGLE_LIMIT = 512;
+constexpr inline uint32_t ASSIMP_INDEX16_VERTEX_LIMIT = 65535;	// Per index batch, 0xFFFF stays free for primitive restart
+constexpr inline uint32_t ASSIMP_ANALYZE_CACHE_SIZE = 16;		// FIFO vertex cache of 'MeshQuality::acmr'
+
+// Records the files opened by assimp, they are the dependencies of an import cache entry
+class CXMFAssimpRecordingIOSystem final : public Assimp::DefaultIOSystem
+{
+private:
+	std::vector<std::string>& m_Files;
+
+public:
+	explicit CXMFAssimpRecordingIOSystem(std::vector<std::string>& files)
+		: m_Files(files)
+	{}
+
+	Assimp::IOStream* Open(const char* file, const char* mode) override
+	{
+		Assimp::IOStream* const stream = DefaultIOSystem::Open(file, mode);
+		if (stream && std::find(m_Files.begin(), m_Files.end(), file) == m_Files.end())	 //
+			m_Files.emplace_back(file);
+		return stream;
+	}
+};
+
+class CXMFAssimpScopeLogStream final : public Assimp::LogStream
+{
+private:
+	static constexpr uint32_t ErrFlags = Assimp::Logger::ErrorSeverity::Warn | Assimp::Logger::ErrorSeverity::Err;
+
+private:
+	Logger* m_Logger;
+
+public:
+	CXMFAssimpScopeLogStream() = delete;
+
+	explicit CXMFAssimpScopeLogStream(Logger* logger)
+		: m_Logger(logger)
+	{
+		if (m_Logger) Assimp::DefaultLogger::get()->attachStream(this, ErrFlags);
+	}
+
+	~CXMFAssimpScopeLogStream() override
+	{
+		if (m_Logger) Assimp::DefaultLogger::get()->detachStream(this, ErrFlags);
+	}
+
+	void write(const char* message) override
+	{
+		if (m_Logger) m_Logger->write(message);
+	}
+};
+
+
+
+enum class SamplerMagFilter : unsigned int
+{
+	SamplerMagFilter_Nearest = 9728,
+	SamplerMagFilter_Linear = 9729
+};
+
+enum class SamplerMinFilter : unsigned int
+{
+	SamplerMinFilter_Nearest = 9728,
+	SamplerMinFilter_Linear = 9729,
+	SamplerMinFilter_Nearest_Mipmap_Nearest = 9984,
+	SamplerMinFilter_Linear_Mipmap_Nearest = 9985,
+	SamplerMinFilter_Nearest_Mipmap_Linear = 9986,
+	SamplerMinFilter_Linear_Mipmap_Linear = 9987
+};
+
+
+
+struct BoundingBox
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	BoundingBox()
+		: min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max())
+	{}
+
+	BoundingSphere getSphere() const
+	{
+		const glm::vec3 center = (min + max) * 0.5F;
+		const float radius = glm::length((max - min) * 0.5F);
+
+		BoundingSphere sphere;
+		sphere.center[0] = center[0];
+		sphere.center[1] = center[1];
+		sphere.center[2] = center[2];
+		sphere.radius = radius;
+		return sphere;
+	}
+};
+
+static void convertAssimpMatrixToGLM(glm::mat4& mat, const aiMatrix4x4& assimpMat)
+{
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int col = 0; col < 4; ++col)
+		{
+			mat[col][row] = assimpMat[row][col];
+		}
+	}
+}
+
+static void convertAssimpMatrixToCXMF(Mat4x4& mat, const aiMatrix4x4& assimpMat)
+{
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int col = 0; col < 4; ++col)
+		{
+			mat[col * 4 + row] = assimpMat[row][col];
+		}
+	}
+}
+
+static void convertGLMMatrixToCXMF(Mat4x4& mat, const glm::mat4& glmMat)
+{
+	for (int col = 0; col < 4; ++col)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			mat[col * 4 + row] = glmMat[col][row];
+		}
+	}
+}
+
+static glm::vec2 assimpVectorToGLM(const aiVector2D& vec)
+{
+	return glm::vec2(vec.x, vec.y);
+}
+
+static glm::vec3 assimpVectorToGLM(const aiVector3D& vec)
+{
+	return glm::vec3(vec.x, vec.y, vec.z);
+}
+
+struct ImportContext
+{
+	struct IntermediateVertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+		glm::vec3 tangent;
+		uint32_t boneID[4];
+		float weight[4];
+	};
+
+	// Meshlets of a mesh built with one of the meshlet limits
+	struct IntermediateMeshlets
+	{
+		MeshletLimits limits;
+		std::vector<uint32_t> meshletVertices;
+		std::vector<uint8_t> meshletTriangles;
+		std::vector<Meshlet> meshlets;
+		std::vector<MeshletCone> meshletCones;	// One per meshlet
+		std::vector<MeshLod> lods;	// Meshlet offsets are relative to 'meshlets'
+		std::vector<Cluster> clusters;	// Indices are relative to 'meshlets' and 'clusterGroups'
+		std::vector<ClusterGroup> clusterGroups;
+		uint32_t meshletCount = 0;	// Full-detail meshlets at the beginning of 'meshlets'
+	};
+
+	struct IntermediateMesh
+	{
+		std::string name;
+		std::vector<IntermediateVertex> vertices;
+		std::vector<uint32_t> indices;	// Relative to the base vertex of the batch once optimized
+		std::vector<IndexBatch> indexBatches;  // Offsets are relative to 'indices', empty without 'LoadOptions::indexBuffers'
+		std::vector<IntermediateMeshlets> meshletSets;	// In 'ImportContext::meshletSets' order
+		MeshStatistics statistics = {};
+		BoundingBox aabb;
+		uint32_t materialIndex;
+		uint32_t geometryMesh = INVALID_INDEX;	// Mesh whose geometry is shared, INVALID_INDEX for own geometry
+	};
+
+	struct MeshPlacement
+	{
+		glm::mat4 transform;  // From the shared geometry to the imported mesh
+		glm::mat4 inverse;
+	};
+
+	Logger* logger;
+	GeometryDeduplication deduplication;
+	bool meshStatistics;
+	bool indices16;	 // Batches of every mesh address at most 65535 vertices, see 'LoadOptions::indexBuffers16'
+	std::vector<MeshletLimits> meshletSets;
+	BoundingBox modelAABB;
+	std::string modelName;
+	std::string modelCopyright;
+	std::string modelGenerator;
+	std::vector<IntermediateMesh> meshes;
+	std::vector<MeshHierarchy> nodes;
+	std::vector<Texture> textures;
+	std::vector<Sampler> samplers;
+	std::vector<Material> materials;
+	std::vector<Bone> bones;
+	std::vector<std::string> sourceFiles;  // Opened by assimp, including the imported file
+
+	std::unordered_set<aiNode*> importedNodes;
+	std::unordered_map<aiMesh*, uint32_t> importedMeshes;
+	std::unordered_map<aiMaterial*, uint32_t> importedMaterials;
+	std::unordered_map<std::string, uint32_t> importedTextures;
+	std::unordered_map<uint64_t, uint32_t> importedSamplers;  // By 'sampler_key'
+	std::unordered_map<std::string, uint32_t> importedBones;
+	std::unordered_map<std::string, const aiBone*> sceneBones;	// First bone of each name in mesh order, like 'aiScene::findBone'
+	std::unordered_multimap<uint64_t, uint32_t> importedGeometry;  // Meshes with own geometry by 'geometry_hash'
+	std::unordered_map<aiMesh*, MeshPlacement> meshPlacements;	   // Meshes sharing geometry up to a rigid transform
+	uint32_t idCounter;
+
+	// Filtering and addressing of the sampler, samplers with the same key are shared by textures
+	static uint64_t sampler_key(const Sampler& s)
+	{
+		return static_cast<uint64_t>(static_cast<uint8_t>(s.magFilter)) |				//
+			   (static_cast<uint64_t>(static_cast<uint8_t>(s.minFilter)) << 8) |		//
+			   (static_cast<uint64_t>(static_cast<uint8_t>(s.mipmapMode)) << 16) |		//
+			   (static_cast<uint64_t>(static_cast<uint8_t>(s.addressModeU)) << 24) |	//
+			   (static_cast<uint64_t>(static_cast<uint8_t>(s.addressModeV)) << 32);
+	}
+
+	bool hasNode(aiNode* node) const
+	{
+		return importedNodes.contains(node);
+	}
+	uint32_t getMeshIndex(aiMesh* mesh) const
+	{
+		const auto _It = importedMeshes.find(mesh);
+		if (_It != importedMeshes.end())  //
+			return _It->second;
+		return INVALID_INDEX;
+	}
+	uint32_t getMaterialIndex(aiMaterial* material) const
+	{
+		const auto _It = importedMaterials.find(material);
+		if (_It != importedMaterials.end())	 //
+			return _It->second;
+		return INVALID_INDEX;
+	}
+	uint32_t getBoneIndex(const std::string& boneName) const
+	{
+		const auto _It = importedBones.find(boneName);
+		if (_It != importedBones.end())	 //
+			return _It->second;
+		return INVALID_INDEX;
+	}
+	uint32_t getTextureIndex(const std::string& path) const
+	{
+		const auto _It = importedTextures.find(path);
+		if (_It != importedTextures.end())	//
+			return _It->second;
+		return INVALID_INDEX;
+	}
+	uint32_t getSamplerIndex(const Sampler& s) const
+	{
+		const auto _It = importedSamplers.find(sampler_key(s));
+		if (_It != importedSamplers.end())	//
+			return _It->second;
+		return INVALID_INDEX;
+	}
+	const MeshPlacement* getMeshPlacement(aiMesh* mesh) const
+	{
+		const auto _It = meshPlacements.find(mesh);
+		if (_It != meshPlacements.end())  //
+			return &_It->second;
+		return nullptr;
+	}
+	const aiBone* findSceneBone(const aiString& name) const
+	{
+		const auto _It = sceneBones.find(name.C_Str());
+		if (_It != sceneBones.end())  //
+			return _It->second;
+		return nullptr;
+	}
+	bool hasBones() const
+	{
+		return !bones.empty();
+	}
+
+	ImportContext()
+		: logger(nullptr),
+		  deduplication(GeometryDeduplication::NONE),
+		  meshStatistics(false),
+		  modelAABB(),
+		  modelName(),
+		  modelCopyright(),
+		  modelGenerator(),
+		  meshes(),
+		  nodes(),
+		  textures(),
+		  samplers(),
+		  materials(),
+		  bones(),
+		  importedNodes(),
+		  importedMeshes(),
+		  importedMaterials(),
+		  importedTextures(),
+		  importedSamplers(),
+		  importedBones(),
+		  sceneBones(),
+		  importedGeometry(),
+		  meshPlacements(),
+		  idCounter(0)
+	{}
+
+	std::string genDummyName()
+	{
+		return std::string("unnamed") + std::to_string(idCounter++);
+	}
+};
+
+
+
+// Meshlets of the triangles are appended to the set, their offsets are relative to the meshlet arrays of the set
+static void appendMeshlets(const ImportContext::IntermediateMesh& mesh, ImportContext::IntermediateMeshlets& set,
+						   const std::vector<uint32_t>& indices, size_t index_count, const LoadOptions& options)
+{
+	using vertex_t = ImportContext::IntermediateVertex;
+
+	const size_t vertex_count = mesh.vertices.size();
+	const size_t max_meshlets = meshopt_buildMeshletsBound(index_count, set.limits.maxVertices, set.limits.maxTriangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<uint32_t> meshlet_vertices(index_count);
+	std::vector<uint8_t> meshlet_triangles(index_count + max_meshlets * 3);
+	const size_t meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(),					   //
+													   meshlet_triangles.data(), indices.data(), index_count,		   //
+													   &mesh.vertices[0].position[0], vertex_count, sizeof(vertex_t),  //
+													   set.limits.maxVertices, set.limits.maxTriangles,				   //
+													   std::clamp(options.meshletConeWeight, 0.0F, 1.0F));
+	{
+		const meshopt_Meshlet& last = meshlets[meshlet_count - 1];
+		meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
+		meshlet_triangles.resize(last.triangle_offset + last.triangle_count * 3);
+		meshlets.resize(meshlet_count);
+	}
+
+	const uint32_t vertexBase = static_cast<uint32_t>(set.meshletVertices.size());
+	const uint32_t triangleBase = static_cast<uint32_t>(set.meshletTriangles.size());
+	set.meshlets.reserve(set.meshlets.size() + meshlet_count);
+	set.meshletCones.reserve(set.meshletCones.size() + meshlet_count);
+	for (const meshopt_Meshlet& m : meshlets)
+	{
+		uint32_t* const m_vertices = meshlet_vertices.data() + m.vertex_offset;
+		uint8_t* const m_triangles = meshlet_triangles.data() + m.triangle_offset;
+		meshopt_optimizeMeshlet(m_vertices, m_triangles, m.triangle_count, m.vertex_count);
+
+		const meshopt_Bounds bounds = meshopt_computeMeshletBounds(m_vertices, m_triangles, m.triangle_count,	  //
+																   &mesh.vertices[0].position[0], vertex_count,  //
+																   sizeof(vertex_t));
+
+		Meshlet& newMeshlet = set.meshlets.emplace_back();
+		newMeshlet.bounds.center[0] = bounds.center[0];
+		newMeshlet.bounds.center[1] = bounds.center[1];
+		newMeshlet.bounds.center[2] = bounds.center[2];
+		newMeshlet.bounds.radius = bounds.radius;
+		newMeshlet.vertexOffset = vertexBase + m.vertex_offset;
+		newMeshlet.triangleOffset = triangleBase + m.triangle_offset;
+		newMeshlet.vertexCount = m.vertex_count;
+		newMeshlet.triangleCount = m.triangle_count;
+
+		MeshletCone& newCone = set.meshletCones.emplace_back();
+		std::copy(std::begin(bounds.cone_apex), std::end(bounds.cone_apex), newCone.apex);
+		std::copy(std::begin(bounds.cone_axis), std::end(bounds.cone_axis), newCone.axis);
+		newCone.cutoff = bounds.cone_cutoff;
+		std::copy(std::begin(bounds.cone_axis_s8), std::end(bounds.cone_axis_s8), newCone.axisS8);
+		newCone.cutoffS8 = bounds.cone_cutoff_s8;
+	}
+
+	set.meshletVertices.insert(set.meshletVertices.end(), meshlet_vertices.begin(), meshlet_vertices.end());
+	set.meshletTriangles.insert(set.meshletTriangles.end(), meshlet_triangles.begin(), meshlet_triangles.end());
+}
+
+struct LodIndices
+{
+	std::vector<uint32_t> indices;
+	float error;  // In model units
+};
+
+// Every level is simplified from the full-detail mesh, so its error is measured against it and doesn't accumulate.
+// Normals and uvs are kept along with the shape, the vertices are shared with the full-detail mesh.
+// Levels don't depend on the meshlet limits, each meshlet set splits the same ones.
+static std::vector<LodIndices> simplifyMeshLods(const ImportContext::IntermediateMesh& mesh, const std::vector<uint32_t>& indices,
+												const LoadOptions& options)
+{
+	using vertex_t = ImportContext::IntermediateVertex;
+	static_assert(offsetof(vertex_t, uv) == offsetof(vertex_t, normal) + sizeof(glm::vec3));
+
+	const size_t index_count = indices.size();
+	const size_t vertex_count = mesh.vertices.size();
+	const float scale = meshopt_simplifyScale(&mesh.vertices[0].position[0], vertex_count, sizeof(vertex_t));
+
+	std::vector<LodIndices> lods;
+	std::vector<uint32_t> tmpIndices(index_count);
+	size_t previousCount = index_count;
+	for (uint32_t i_lod = 0; i_lod < options.lodCount; ++i_lod)
+	{
+		const size_t target_count = static_cast<size_t>(static_cast<float>(previousCount) * options.lodRatio) / 3 * 3;
+		float error = 0.0F;
+		const size_t lod_count = meshopt_simplifyWithAttributes(
+			tmpIndices.data(), indices.data(), index_count, &mesh.vertices[0].position[0], vertex_count, sizeof(vertex_t),
+			&mesh.vertices[0].normal[0], sizeof(vertex_t), ASSIMP_LOD_ATTRIBUTE_WEIGHTS, std::size(ASSIMP_LOD_ATTRIBUTE_WEIGHTS),
+			nullptr, target_count, options.lodMaxError, 0, &error);
+		if (lod_count == 0 || static_cast<float>(lod_count) > static_cast<float>(previousCount) * ASSIMP_LOD_MIN_REDUCTION)  //
+			break;
+
+		LodIndices& lod = lods.emplace_back();
+		lod.indices.resize(lod_count);
+		lod.error = error * scale;
+		meshopt_optimizeVertexCache(lod.indices.data(), tmpIndices.data(), lod_count, vertex_count);
+
+		previousCount = lod_count;
+	}
+	return lods;
+}
+
+static void appendMeshLods(const ImportContext::IntermediateMesh& mesh, ImportContext::IntermediateMeshlets& set,
+						   const std::vector<LodIndices>& lods, const LoadOptions& options)
+{
+	for (const LodIndices& lodIndices : lods)
+	{
+		MeshLod& lod = set.lods.emplace_back();
+		lod.meshletOffset = static_cast<uint32_t>(set.meshlets.size());
+		lod.error = lodIndices.error;
+		appendMeshlets(mesh, set, lodIndices.indices, lodIndices.indices.size(), options);
+		lod.meshletCount = static_cast<uint32_t>(set.meshlets.size()) - lod.meshletOffset;
+	}
+}
+
+// Triangles of the meshlet as indices of the mesh vertices
+static void meshlet_indices(const ImportContext::IntermediateMeshlets& set, const Meshlet& meshlet, std::vector<uint32_t>& out)
+{
+	for (uint32_t i = 0; i < meshlet.triangleCount * 3; ++i)
+	{
+		out.push_back(set.meshletVertices[meshlet.vertexOffset + set.meshletTriangles[meshlet.triangleOffset + i]]);
+	}
+}
+
+// Levels are built bottom-up from the full-detail meshlets: the meshlets of a level are partitioned into groups
+// of neighbours, each group is simplified with its outer border locked and split into the meshlets of the next level.
+// Locked borders keep adjacent groups watertight whichever of them is drawn coarser.
+// A group that can't be reduced leaves its meshlets as the coarsest ones.
+static void appendClusterHierarchy(const ImportContext::IntermediateMesh& mesh, ImportContext::IntermediateMeshlets& set,
+								   const LoadOptions& options)
+{
+	using vertex_t = ImportContext::IntermediateVertex;
+
+	const size_t vertex_count = mesh.vertices.size();
+	const float* const positions = &mesh.vertices[0].position[0];
+
+	// Own bounds and error of each cluster, full-detail meshlets have their own bounds and no error
+	std::vector<BoundingSphere> clusterBounds;
+	std::vector<float> clusterErrors;
+	std::vector<uint32_t> level;
+	for (uint32_t i = 0; i < set.meshletCount; ++i)
+	{
+		set.clusters.push_back({i, INVALID_INDEX, INVALID_INDEX});
+		clusterBounds.push_back(set.meshlets[i].bounds);
+		clusterErrors.push_back(0.0F);
+		level.push_back(i);
+	}
+
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> indexCounts;
+	std::vector<uint32_t> partition;
+	while (level.size() > 1)
+	{
+		indices.clear();
+		indexCounts.clear();
+		for (const uint32_t cluster : level)
+		{
+			const size_t begin = indices.size();
+			meshlet_indices(set, set.meshlets[set.clusters[cluster].meshletIndex], indices);
+			indexCounts.push_back(static_cast<uint32_t>(indices.size() - begin));
+		}
+
+		partition.resize(level.size());
+		const size_t group_count = meshopt_partitionClusters(partition.data(), indices.data(), indices.size(), indexCounts.data(),
+															 level.size(), positions, vertex_count, sizeof(vertex_t),
+															 ASSIMP_CLUSTER_GROUP_SIZE);
+
+		std::vector<std::vector<uint32_t>> groups(group_count);
+		for (size_t i = 0; i < level.size(); ++i) groups[partition[i]].push_back(level[i]);
+
+		std::vector<uint32_t> nextLevel;
+		for (const std::vector<uint32_t>& group : groups)
+		{
+			std::vector<uint32_t> groupIndices;
+			for (const uint32_t cluster : group) meshlet_indices(set, set.meshlets[set.clusters[cluster].meshletIndex], groupIndices);
+
+			std::vector<uint32_t> simplified(groupIndices.size());
+			float error = 0.0F;
+			const size_t target_count = groupIndices.size() / 6 * 3;
+			const size_t simplified_count = meshopt_simplify(
+				simplified.data(), groupIndices.data(), groupIndices.size(), positions, vertex_count, sizeof(vertex_t), target_count,
+				std::numeric_limits<float>::max(), meshopt_SimplifyLockBorder | meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute,
+				&error);
+			if (simplified_count == 0 ||
+				static_cast<float>(simplified_count) > static_cast<float>(groupIndices.size()) * ASSIMP_CLUSTER_MIN_REDUCTION)
+			{
+				continue;
+			}
+
+			// The group covers the clusters it is made of, so bounds and errors never shrink up the hierarchy
+			const uint32_t groupIndex = static_cast<uint32_t>(set.clusterGroups.size());
+			ClusterGroup& newGroup = set.clusterGroups.emplace_back();
+			std::vector<BoundingSphere> spheres;
+			for (const uint32_t cluster : group)
+			{
+				spheres.push_back(clusterBounds[cluster]);
+				error = std::max(error, clusterErrors[cluster]);
+				set.clusters[cluster].parentGroup = groupIndex;
+			}
+			const meshopt_Bounds bounds = meshopt_computeSphereBounds(spheres[0].center, spheres.size(), sizeof(BoundingSphere),
+																	  &spheres[0].radius, sizeof(BoundingSphere));
+			newGroup.bounds.center[0] = bounds.center[0];
+			newGroup.bounds.center[1] = bounds.center[1];
+			newGroup.bounds.center[2] = bounds.center[2];
+			newGroup.bounds.radius = bounds.radius;
+			newGroup.error = error;
+
+			const uint32_t meshletsBegin = static_cast<uint32_t>(set.meshlets.size());
+			appendMeshlets(mesh, set, simplified, simplified_count, options);
+			for (uint32_t i = meshletsBegin; i < set.meshlets.size(); ++i)
+			{
+				nextLevel.push_back(static_cast<uint32_t>(set.clusters.size()));
+				set.clusters.push_back({i, groupIndex, INVALID_INDEX});
+				clusterBounds.push_back(newGroup.bounds);
+				clusterErrors.push_back(newGroup.error);
+			}
+		}
+		level = std::move(nextLevel);
+	}
+}
+
+// Triangles are taken in order, a batch ends once the next triangle would bring it over ASSIMP_INDEX16_VERTEX_LIMIT vertices.
+// Each batch gets its own contiguous copy of the vertices it uses, so the vertices shared by two batches are duplicated.
+// Indices stay relative to the mesh, so meshlets and levels are built over the new vertices as before.
+static void splitIndexBatches(ImportContext::IntermediateMesh& mesh, std::vector<uint32_t>& indices)
+{
+	using vertex_t = ImportContext::IntermediateVertex;
+
+	std::vector<vertex_t> vertices;
+	vertices.reserve(mesh.vertices.size());
+	std::vector<uint32_t> remap(mesh.vertices.size(), INVALID_INDEX);	 // Source vertex to its index in the batch
+	std::vector<uint32_t> batchVertices;								 // Source vertices of the batch
+	IndexBatch batch = {0, 0, 0};
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		size_t newVertices = 0;
+		for (size_t k = 0; k < 3; ++k) newVertices += remap[indices[i + k]] == INVALID_INDEX ? 1 : 0;
+
+		if (batchVertices.size() + newVertices > ASSIMP_INDEX16_VERTEX_LIMIT)
+		{
+			batch.indexCount = static_cast<uint32_t>(i - batch.indexOffset);
+			mesh.indexBatches.push_back(batch);
+			for (const uint32_t vertex : batchVertices) remap[vertex] = INVALID_INDEX;
+			batchVertices.clear();
+			batch = {i, 0, static_cast<uint32_t>(vertices.size())};
+		}
+
+		for (size_t k = 0; k < 3; ++k)
+		{
+			uint32_t& local = remap[indices[i + k]];
+			if (local == INVALID_INDEX)
+			{
+				local = static_cast<uint32_t>(batchVertices.size());
+				batchVertices.push_back(indices[i + k]);
+				vertices.push_back(mesh.vertices[indices[i + k]]);
+			}
+			indices[i + k] = batch.baseVertex + local;
+		}
+	}
+
+	batch.indexCount = static_cast<uint32_t>(indices.size() - batch.indexOffset);
+	mesh.indexBatches.push_back(batch);
+	mesh.vertices = std::move(vertices);
+}
+
+// Efficiency of the triangle list over the vertices, 'vertexSize' is of the vertices stored in the model
+static MeshQuality analyze_mesh(const std::vector<uint32_t>& indices, const std::vector<ImportContext::IntermediateVertex>& vertices,
+								size_t vertexSize)
+{
+	MeshQuality quality = {};
+	if (indices.empty()) return quality;
+
+	const meshopt_VertexCacheStatistics cache =
+		meshopt_analyzeVertexCache(indices.data(), indices.size(), vertices.size(), ASSIMP_ANALYZE_CACHE_SIZE, 0, 0);
+	quality.acmr = cache.acmr;
+	quality.atvr = cache.atvr;
+	quality.overfetch = meshopt_analyzeVertexFetch(indices.data(), indices.size(), vertices.size(), vertexSize).overfetch;
+	quality.overdraw = meshopt_analyzeOverdraw(indices.data(), indices.size(), &vertices[0].position[0], vertices.size(),
+											   sizeof(ImportContext::IntermediateVertex))
+						   .overdraw;
+	return quality;
+}
+
+static void optimizeMesh(ImportContext::IntermediateMesh& mesh, std::span<const MeshletLimits> limits, size_t vertexSize,
+						 const LoadOptions& options)
+{
+	using vertex_t = ImportContext::IntermediateVertex;
+
+	const size_t index_count = mesh.indices.size();
+	const size_t unindexed_vertex_count = mesh.vertices.size();
+	std::vector<uint32_t> remap(unindexed_vertex_count);
+	const size_t vertex_count = meshopt_generateVertexRemap(remap.data(), mesh.indices.data(),	//
+															index_count, mesh.vertices.data(),	//
+															unindexed_vertex_count, sizeof(vertex_t));
+
+	std::vector<uint32_t> newIndexBuffer(index_count);
+	std::vector<vertex_t> newVertexBuffer(vertex_count);
+	meshopt_remapIndexBuffer(newIndexBuffer.data(), mesh.indices.data(), index_count, remap.data());
+	meshopt_remapVertexBuffer(newVertexBuffer.data(), mesh.vertices.data(), unindexed_vertex_count,	 //
+							  sizeof(vertex_t), remap.data());
+
+	// Statistics are taken after each stage, the overdraw pass reorders the cache-optimized triangles in place
+	MeshStatistics& statistics = mesh.statistics;
+	if (options.meshStatistics) statistics.source = analyze_mesh(newIndexBuffer, newVertexBuffer, vertexSize);
+	{
+		std::vector<uint32_t> tmpIndices(index_count);
+		std::vector<vertex_t> tmpVertices(vertex_count);
+		meshopt_optimizeVertexCache(tmpIndices.data(), newIndexBuffer.data(), index_count, vertex_count);
+		if (options.meshStatistics) statistics.vertexCache = analyze_mesh(tmpIndices, newVertexBuffer, vertexSize);
+
+		if (options.overdrawThreshold > 0.0F)
+		{
+			meshopt_optimizeOverdraw(tmpIndices.data(), tmpIndices.data(), index_count, &newVertexBuffer[0].position[0],
+									 vertex_count, sizeof(vertex_t), options.overdrawThreshold);
+		}
+		if (options.meshStatistics)
+		{
+			statistics.overdraw = options.overdrawThreshold > 0.0F ? analyze_mesh(tmpIndices, newVertexBuffer, vertexSize)
+																   : statistics.vertexCache;
+		}
+
+		meshopt_optimizeVertexFetch(tmpVertices.data(), tmpIndices.data(), index_count,	 //
+									newVertexBuffer.data(), vertex_count, sizeof(vertex_t));
+
+		newIndexBuffer = std::move(tmpIndices);
+		newVertexBuffer = std::move(tmpVertices);
+	}
+
+	mesh.vertices = std::move(newVertexBuffer);
+
+	// Split after the vertex fetch order, so the batches take mostly contiguous vertices and few of them are duplicated
+	if (options.indexBuffers && options.indexBuffers16 && vertex_count > ASSIMP_INDEX16_VERTEX_LIMIT)
+		splitIndexBatches(mesh, newIndexBuffer);
+	else if (options.indexBuffers)
+		mesh.indexBatches.push_back({0, static_cast<uint32_t>(index_count), 0});
+
+	if (options.meshStatistics) statistics.vertexFetch = analyze_mesh(newIndexBuffer, mesh.vertices, vertexSize);
+
+	std::vector<LodIndices> lods;
+	if (options.lodCount > 0) lods = simplifyMeshLods(mesh, newIndexBuffer, options);
+
+	mesh.meshletSets.resize(limits.size());
+	for (size_t i = 0; i < limits.size(); ++i)
+	{
+		ImportContext::IntermediateMeshlets& set = mesh.meshletSets[i];
+		set.limits = limits[i];
+		appendMeshlets(mesh, set, newIndexBuffer, index_count, options);
+		set.meshletCount = static_cast<uint32_t>(set.meshlets.size());
+		appendMeshLods(mesh, set, lods, options);
+		if (options.clusterLod) appendClusterHierarchy(mesh, set, options);
+	}
+
+	for (const IndexBatch& batch : mesh.indexBatches)
+	{
+		for (uint32_t i = 0; i < batch.indexCount; ++i) newIndexBuffer[batch.indexOffset + i] -= batch.baseVertex;
+	}
+	mesh.indices = options.indexBuffers ? std::move(newIndexBuffer) : std::vector<uint32_t>();
+}
+
+
+
+// The bone and its missing ancestors are added walking up the armature, each one before its parent
+static uint32_t parseAssimpBone(ImportContext& ctx, const aiBone& assimpBone)
+{
+	uint32_t boneIndex = ctx.getBoneIndex(assimpBone.mName.C_Str());
+	if (boneIndex != INVALID_INDEX)	 //
+		return boneIndex;
+
+	boneIndex = static_cast<uint32_t>(ctx.bones.size());
+	uint32_t childIndex = INVALID_INDEX;  // Added on the previous step, waits for its parent index
+	for (const aiBone* current = &assimpBone; current != nullptr;)
+	{
+		const std::string boneName = current->mName.C_Str();
+		const uint32_t existingIndex = ctx.getBoneIndex(boneName);
+		if (existingIndex != INVALID_INDEX)
+		{
+			ctx.bones[childIndex].parentIndex = existingIndex != childIndex ? existingIndex : INVALID_INDEX;
+			break;
+		}
+
+		const aiNode& boneNode = *current->mNode;
+
+		const uint32_t currentIndex = static_cast<uint32_t>(ctx.bones.size());
+		ctx.importedBones.insert({boneName, currentIndex});
+		Bone& bone = ctx.bones.emplace_back();
+		bone.name = boneName;
+		convertAssimpMatrixToCXMF(bone.inverseBindTransform, boneNode.mTransformation);
+		convertAssimpMatrixToCXMF(bone.offsetMatrix, current->mOffsetMatrix);
+		bone.parentIndex = INVALID_INDEX;
+		if (childIndex != INVALID_INDEX) ctx.bones[childIndex].parentIndex = currentIndex;
+
+		childIndex = currentIndex;
+		current = boneNode.mParent ? ctx.findSceneBone(boneNode.mParent->mName) : nullptr;
+	}
+	return boneIndex;
+}
+
+static uint32_t parseAssimpTexture(ImportContext& ctx, aiMaterial* assimpMaterial)
+{
+	aiTextureType textureType = aiTextureType_BASE_COLOR;
+	aiString str;
+	aiReturn result = assimpMaterial->Get(AI_MATKEY_TEXTURE(textureType, 0), str);
+	if (result != aiReturn_SUCCESS || str.length == 0)
+	{
+		textureType = aiTextureType_DIFFUSE;
+		result = assimpMaterial->Get(AI_MATKEY_TEXTURE(textureType, 0), str);
+	}
+
+	if (result != aiReturn_SUCCESS || str.length == 0)	//
+		return INVALID_INDEX;
+
+	const std::string texName = str.C_Str();
+	uint32_t textureIndex = ctx.getTextureIndex(texName);
+	if (textureIndex != INVALID_INDEX)	//
+		return textureIndex;
+
+	textureIndex = static_cast<uint32_t>(ctx.textures.size());
+	ctx.importedTextures.insert({texName, textureIndex});
+
+	Texture& tex = ctx.textures.emplace_back();
+	tex.path = texName;
+	tex.samplerIndex = INVALID_INDEX;
+
+	Sampler sampler;
+	aiTextureMapMode mapU, mapV;
+	int filterMag, filterMin;
+
+	const auto convAddressMode = [](aiTextureMapMode mode) -> Sampler::AddressMode
+	{
+		switch (mode)
+		{
+			case aiTextureMapMode_Clamp:
+				return Sampler::AddressMode::CLAMP_TO_EDGE;
+			case aiTextureMapMode_Mirror:
+				return Sampler::AddressMode::MIRRORED_REPEAT;
+			default:
+				return Sampler::AddressMode::REPEAT;
+		}
+	};
+
+	result = assimpMaterial->Get(AI_MATKEY_MAPPINGMODE_U(textureType, 0), mapU);
+	if (result == aiReturn_SUCCESS)
+	{
+		sampler.addressModeU = convAddressMode(mapU);
+	}
+	else
+	{
+		sampler.addressModeU = Sampler::AddressMode::REPEAT;
+	}
+
+	result = assimpMaterial->Get(AI_MATKEY_MAPPINGMODE_V(textureType, 0), mapV);
+	if (result == aiReturn_SUCCESS)
+	{
+		sampler.addressModeV = convAddressMode(mapV);
+	}
+	else
+	{
+		sampler.addressModeV = Sampler::AddressMode::REPEAT;
+	}
+
+	result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGFILTER_MAG(textureType, 0), filterMag);
+	if (result == aiReturn_SUCCESS)
+	{
+		if (static_cast<SamplerMagFilter>(filterMag) == SamplerMagFilter::SamplerMagFilter_Linear)
+			sampler.magFilter = Sampler::Filter::LINEAR;
+		else
+			sampler.magFilter = Sampler::Filter::NEAREST;
+	}
+	else
+	{
+		sampler.magFilter = Sampler::Filter::NEAREST;
+	}
+
+	result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGFILTER_MIN(textureType, 0), filterMin);
+	if (result == aiReturn_SUCCESS)
+	{
+		switch (static_cast<SamplerMinFilter>(filterMin))
+		{
+			case SamplerMinFilter::SamplerMinFilter_Linear:
+			{
+				sampler.minFilter = Sampler::Filter::LINEAR;
+				sampler.mipmapMode = Sampler::MipmapMode::NONE;
+				break;
+			}
+			case SamplerMinFilter::SamplerMinFilter_Nearest_Mipmap_Nearest:
+			{
+				sampler.minFilter = Sampler::Filter::NEAREST;
+				sampler.mipmapMode = Sampler::MipmapMode::NEAREST;
+				break;
+			}
+			case SamplerMinFilter::SamplerMinFilter_Linear_Mipmap_Nearest:
+			{
+				sampler.minFilter = Sampler::Filter::LINEAR;
+				sampler.mipmapMode = Sampler::MipmapMode::NEAREST;
+				break;
+			}
+			case SamplerMinFilter::SamplerMinFilter_Nearest_Mipmap_Linear:
+			{
+				sampler.minFilter = Sampler::Filter::NEAREST;
+				sampler.mipmapMode = Sampler::MipmapMode::LINEAR;
+				break;
+			}
+			case SamplerMinFilter::SamplerMinFilter_Linear_Mipmap_Linear:
+			{
+				sampler.minFilter = Sampler::Filter::LINEAR;
+				sampler.mipmapMode = Sampler::MipmapMode::LINEAR;
+				break;
+			}
+			default:
+			{
+				sampler.minFilter = Sampler::Filter::NEAREST;
+				sampler.mipmapMode = Sampler::MipmapMode::NONE;
+				break;
+			}
+		}
+	}
+	else
+	{
+		sampler.minFilter = Sampler::Filter::NEAREST;
+		sampler.mipmapMode = Sampler::MipmapMode::NONE;
+	}
+
+
+
+	tex.samplerIndex = ctx.getSamplerIndex(sampler);
+	if (tex.samplerIndex != INVALID_INDEX)	//
+		return textureIndex;
+
+	aiString samplerName;
+	result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGNAME(textureType, 0), samplerName);
+	if (result == aiReturn_SUCCESS && samplerName.length > 0)
+	{
+		aiString samplerID;
+		result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGID(textureType, 0), samplerID);
+		if (result == aiReturn_SUCCESS && samplerID.length > 0)
+		{
+			sampler.name = std::string(samplerName.C_Str()) + std::string(samplerID.C_Str());
+		}
+		else
+		{
+			sampler.name = std::string(samplerName.C_Str()) + std::to_string(ctx.idCounter++);
+		}
+	}
+	else
+	{
+		sampler.name = ctx.genDummyName();
+	}
+
+	tex.samplerIndex = static_cast<uint32_t>(ctx.samplers.size());
+	ctx.importedSamplers.insert({ImportContext::sampler_key(sampler), tex.samplerIndex});
+	ctx.samplers.push_back(std::move(sampler));
+	return textureIndex;
+}
+
+static uint32_t parseAssimpMaterial(ImportContext& ctx, aiMaterial* assimpMaterial)
+{
+	uint32_t materialIndex = ctx.getMaterialIndex(assimpMaterial);
+	if (materialIndex != INVALID_INDEX)	 //
+		return materialIndex;
+
+	const aiString materialName = assimpMaterial->GetName();
+
+	materialIndex = static_cast<uint32_t>(ctx.materials.size());
+	ctx.importedMaterials.insert({assimpMaterial, materialIndex});
+
+	Material& mat = ctx.materials.emplace_back();
+	mat.name = materialName.C_Str();
+	if (mat.name.empty()) mat.name = ctx.genDummyName();
+	mat.textureIndex = parseAssimpTexture(ctx, assimpMaterial);
+
+	aiColor4D baseColorFactor;
+	aiReturn result = assimpMaterial->Get(AI_MATKEY_BASE_COLOR, baseColorFactor);
+	if (result != aiReturn_SUCCESS)
+	{
+		result = assimpMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, baseColorFactor);
+	}
+	if (result == aiReturn_SUCCESS)
+	{
+		mat.baseColorFactor[0] = glm::clamp<float>(baseColorFactor[0], 0.0F, 1.0F);
+		mat.baseColorFactor[1] = glm::clamp<float>(baseColorFactor[1], 0.0F, 1.0F);
+		mat.baseColorFactor[2] = glm::clamp<float>(baseColorFactor[2], 0.0F, 1.0F);
+		mat.baseColorFactor[3] = glm::clamp<float>(baseColorFactor[3], 0.0F, 1.0F);
+	}
+	else
+	{
+		mat.baseColorFactor[0] = 1.0F;
+		mat.baseColorFactor[1] = 1.0F;
+		mat.baseColorFactor[2] = 1.0F;
+		mat.baseColorFactor[3] = 1.0F;
+	}
+
+	float roughnessFactor;
+	result = assimpMaterial->Get(AI_MATKEY_ROUGHNESS_FACTOR, roughnessFactor);
+	if (result == aiReturn_SUCCESS)
+	{
+		mat.roughnessFactor = glm::clamp<float>(roughnessFactor, 0.0F, 1.0F);
+	}
+	else
+	{
+		mat.roughnessFactor = 1.0F;
+	}
+
+	float metallicFactor;
+	result = assimpMaterial->Get(AI_MATKEY_METALLIC_FACTOR, metallicFactor);
+	if (result == aiReturn_SUCCESS)
+	{
+		mat.metallicFactor = glm::clamp<float>(metallicFactor, 0.0F, 1.0F);
+	}
+	else
+	{
+		mat.metallicFactor = 1.0F;
+	}
+
+	float ambientOcclusionFactor;
+	result = assimpMaterial->Get(AI_MATKEY_LIGHTMAP_FACTOR, ambientOcclusionFactor);
+	if (result == aiReturn_SUCCESS)
+	{
+		mat.ambientOcclusionFactor = glm::clamp<float>(ambientOcclusionFactor, 0.0F, 1.0F);
+	}
+	else
+	{
+		mat.ambientOcclusionFactor = 1.0F;
+	}
+
+	aiColor3D emissiveFactor;
+	result = assimpMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, emissiveFactor);
+	if (result == aiReturn_SUCCESS)
+	{
+		mat.emissiveFactor[0] = glm::clamp<float>(emissiveFactor[0], 0.0F, 1.0F);
+		mat.emissiveFactor[1] = glm::clamp<float>(emissiveFactor[1], 0.0F, 1.0F);
+		mat.emissiveFactor[2] = glm::clamp<float>(emissiveFactor[2], 0.0F, 1.0F);
+	}
+	else
+	{
+		mat.emissiveFactor[0] = 0.0F;
+		mat.emissiveFactor[1] = 0.0F;
+		mat.emissiveFactor[2] = 0.0F;
+	}
+
+	aiString alphaMode;
+	result = assimpMaterial->Get(AI_MATKEY_GLTF_ALPHAMODE, alphaMode);
+	if (result == aiReturn_SUCCESS)
+	{
+		if (std::strcmp(alphaMode.C_Str(), "OPAQUE") == 0)
+		{
+			mat.alphaMode = Material::AlphaMode::OPAQUE;
+			mat.alphaCutoff = 0.0F;
+		}
+		else if (std::strcmp(alphaMode.C_Str(), "MASK") == 0)
+		{
+			mat.alphaMode = Material::AlphaMode::MASK;
+			float alphaCutoff;
+			result = assimpMaterial->Get(AI_MATKEY_GLTF_ALPHACUTOFF, alphaCutoff);
+			if (result == aiReturn_SUCCESS)
+			{
+				mat.alphaCutoff = glm::clamp<float>(alphaCutoff, 0.0F, 1.0F);
+			}
+			else
+			{
+				mat.alphaCutoff = 0.5F;
+			}
+		}
+		else if (std::strcmp(alphaMode.C_Str(), "BLEND") == 0)
+		{
+			mat.alphaMode = Material::AlphaMode::BLEND;
+			mat.alphaCutoff = 0.0F;
+		}
+		else
+		{
+			mat.alphaMode = Material::AlphaMode::OPAQUE;
+			mat.alphaCutoff = 0.0F;
+		}
+	}
+	else
+	{
+		mat.alphaMode = Material::AlphaMode::OPAQUE;
+		mat.alphaCutoff = 0.0F;
+	}
+
+	bool doubleSided;
+	result = assimpMaterial->Get(AI_MATKEY_TWOSIDED, doubleSided);
+	if (result == aiReturn_SUCCESS)
+	{
+		mat.doubleSided = doubleSided;
+	}
+	else
+	{
+		mat.doubleSided = false;
+	}
+
+	aiShadingMode shadingMode;
+	result = assimpMaterial->Get(AI_MATKEY_SHADING_MODEL, shadingMode);
+	if (result == aiReturn_SUCCESS)
+	{
+		mat.shadeless = (shadingMode == aiShadingMode_Unlit);
+	}
+	else
+	{
+		mat.shadeless = false;
+	}
+	return materialIndex;
+}
+
+// Hash of the geometry, for 'GeometryDeduplication::RIGID' only of the parts a rigid transform keeps
+static uint64_t geometry_hash(const ImportContext::IntermediateMesh& mesh, bool rigid)
+{
+	using vertex_t = ImportContext::IntermediateVertex;
+
+	const std::hash<std::string_view> hasher;
+	const auto bytes = [](const auto& array)
+	{ return std::string_view(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(array[0])); };
+
+	uint64_t hash = hasher(bytes(mesh.indices));
+	if (!rigid)
+	{
+		hash = hash * 31 + hasher(bytes(mesh.vertices));
+		return hash;
+	}
+
+	struct RigidInvariant
+	{
+		glm::vec2 uv;
+		uint32_t boneID[4];
+		float weight[4];
+	};
+	std::vector<RigidInvariant> invariants(mesh.vertices.size());
+	for (size_t i = 0; i < mesh.vertices.size(); ++i)
+	{
+		const vertex_t& vertex = mesh.vertices[i];
+		invariants[i].uv = vertex.uv;
+		std::memcpy(invariants[i].boneID, vertex.boneID, sizeof(vertex.boneID));
+		std::memcpy(invariants[i].weight, vertex.weight, sizeof(vertex.weight));
+	}
+	hash = hash * 31 + hasher(bytes(invariants));
+	return hash;
+}
+
+// Rotation and translation from the vertices of 'from' to the vertices of 'to', found from a frame of the vertices
+// farthest from the center and checked against every vertex. Skinned vertices are bound to their bones and never match.
+static bool fit_rigid_transform(const std::vector<ImportContext::IntermediateVertex>& from,
+								const std::vector<ImportContext::IntermediateVertex>& to, glm::mat4& transform)
+{
+	using vertex_t = ImportContext::IntermediateVertex;
+
+	const size_t count = from.size();
+	glm::dvec3 fromSum(0.0), toSum(0.0);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const vertex_t& a = from[i];
+		const vertex_t& b = to[i];
+		if (a.boneID[0] != INVALID_INDEX || a.uv != b.uv ||	 //
+			std::memcmp(a.boneID, b.boneID, sizeof(a.boneID)) != 0 || std::memcmp(a.weight, b.weight, sizeof(a.weight)) != 0)
+		{
+			return false;
+		}
+		fromSum += glm::dvec3(a.position);
+		toSum += glm::dvec3(b.position);
+	}
+	if (count < 3) return false;
+
+	const glm::vec3 fromCenter = glm::vec3(fromSum / static_cast<double>(count));
+	const glm::vec3 toCenter = glm::vec3(toSum / static_cast<double>(count));
+
+	size_t first = 0;
+	for (size_t i = 1; i < count; ++i)
+	{
+		if (glm::length(from[i].position - fromCenter) > glm::length(from[first].position - fromCenter)) first = i;
+	}
+	const float radius = glm::length(from[first].position - fromCenter);
+	const glm::vec3 axis = (from[first].position - fromCenter) / radius;
+
+	size_t second = 0;
+	for (size_t i = 1; i < count; ++i)
+	{
+		if (glm::length(glm::cross(from[i].position - fromCenter, axis)) >
+			glm::length(glm::cross(from[second].position - fromCenter, axis)))
+		{
+			second = i;
+		}
+	}
+	// A point or a line has no unique rotation
+	if (!(radius > 0.0f) || glm::length(glm::cross(from[second].position - fromCenter, axis)) <= radius * 1e-3f) return false;
+
+	const auto frame = [](const glm::vec3& u, const glm::vec3& v)
+	{
+		const glm::vec3 x = glm::normalize(u);
+		const glm::vec3 y = glm::normalize(v - glm::dot(v, x) * x);
+		return glm::mat3(x, y, glm::cross(x, y));
+	};
+	const glm::mat3 rotation = frame(to[first].position - toCenter, to[second].position - toCenter) *
+							   glm::transpose(frame(from[first].position - fromCenter, from[second].position - fromCenter));
+	const glm::vec3 translation = toCenter - rotation * fromCenter;
+
+	const float tolerance = radius * ASSIMP_RIGID_TOLERANCE;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const vertex_t& a = from[i];
+		const vertex_t& b = to[i];
+		if (glm::length(rotation * a.position + translation - b.position) > tolerance ||
+			glm::length(rotation * a.normal - b.normal) > ASSIMP_RIGID_TOLERANCE ||	 //
+			glm::length(rotation * a.tangent - b.tangent) > ASSIMP_RIGID_TOLERANCE)
+		{
+			return false;
+		}
+	}
+
+	transform = glm::mat4(rotation);
+	transform[3] = glm::vec4(translation, 1.0f);
+	return true;
+}
+
+// Look for an earlier mesh with the same geometry, the last added mesh is dropped if its material is the same too,
+// otherwise it keeps its record and shares the geometry
+static uint32_t deduplicateMesh(ImportContext& ctx, aiMesh* assimpMesh, uint32_t meshIndex)
+{
+	const bool rigid = ctx.deduplication == GeometryDeduplication::RIGID;
+	ImportContext::IntermediateMesh& mesh = ctx.meshes[meshIndex];
+	const uint64_t hash = geometry_hash(mesh, rigid);
+
+	const auto range = ctx.importedGeometry.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const uint32_t sourceIndex = it->second;
+		const ImportContext::IntermediateMesh& source = ctx.meshes[sourceIndex];
+		if (source.vertices.size() != mesh.vertices.size() || source.indices != mesh.indices)  //
+			continue;
+
+		glm::mat4 transform(1.0f);
+		const bool isCopy = std::memcmp(source.vertices.data(), mesh.vertices.data(),	//
+										mesh.vertices.size() * sizeof(ImportContext::IntermediateVertex)) == 0;
+		if (!isCopy && (!rigid || !fit_rigid_transform(source.vertices, mesh.vertices, transform)))  //
+			continue;
+
+		if (!isCopy) ctx.meshPlacements.insert({assimpMesh, {transform, glm::inverse(transform)}});
+
+		if (source.materialIndex == mesh.materialIndex)
+		{
+			ctx.meshes.pop_back();
+			ctx.importedMeshes[assimpMesh] = sourceIndex;
+			return sourceIndex;
+		}
+
+		mesh.geometryMesh = sourceIndex;
+		mesh.aabb = source.aabb;
+		mesh.vertices = std::vector<ImportContext::IntermediateVertex>();
+		mesh.indices = std::vector<uint32_t>();
+		return meshIndex;
+	}
+
+	ctx.importedGeometry.emplace(hash, meshIndex);
+	return meshIndex;
+}
+
+static uint32_t parseAssimpMesh(ImportContext& ctx, const aiScene& scene, aiMesh* assimpMesh)
+{
+	uint32_t meshIndex = ctx.getMeshIndex(assimpMesh);
+	if (meshIndex != INVALID_INDEX)	 //
+		return meshIndex;
+
+	using vertex_t = ImportContext::IntermediateVertex;
+	using mesh_t = ImportContext::IntermediateMesh;
+
+	const bool hasTextureCoords = assimpMesh->HasTextureCoords(0);
+
+	meshIndex = static_cast<uint32_t>(ctx.meshes.size());
+	ctx.importedMeshes.insert({assimpMesh, meshIndex});
+	mesh_t& mesh = ctx.meshes.emplace_back();
+	mesh.name = assimpMesh->mName.C_Str();
+	if (mesh.name.empty()) mesh.name = ctx.genDummyName();
+
+	mesh.aabb.min = assimpVectorToGLM(assimpMesh->mAABB.mMin);
+	mesh.aabb.max = assimpVectorToGLM(assimpMesh->mAABB.mMax);
+	ctx.modelAABB.min = glm::min(ctx.modelAABB.min, mesh.aabb.min);
+	ctx.modelAABB.max = glm::max(ctx.modelAABB.max, mesh.aabb.max);
+
+	// Vertices
+	mesh.vertices.resize(assimpMesh->mNumVertices);
+	for (uint32_t i_vertex = 0; i_vertex < assimpMesh->mNumVertices; ++i_vertex)
+	{
+		vertex_t& vert = mesh.vertices[i_vertex];
+		vert.position = assimpVectorToGLM(assimpMesh->mVertices[i_vertex]);
+		vert.normal = assimpVectorToGLM(assimpMesh->mNormals[i_vertex]);
+		vert.tangent = assimpVectorToGLM(assimpMesh->mTangents[i_vertex]);
+
+		if (hasTextureCoords)
+		{
+			const aiVector3D& uv = assimpMesh->mTextureCoords[0][i_vertex];
+			vert.uv[0] = uv[0];
+			vert.uv[1] = uv[1];
+		}
+		else
+		{
+			vert.uv[0] = 0.0F;
+			vert.uv[1] = 0.0F;
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			vert.boneID[i] = INVALID_INDEX;
+			vert.weight[i] = 0.0F;
+		}
+	}
+
+	// Indices
+	mesh.indices.resize(static_cast<size_t>(assimpMesh->mNumFaces) * 3);
+	for (uint32_t i_face = 0; i_face < assimpMesh->mNumFaces; ++i_face)
+	{
+		const aiFace& face = assimpMesh->mFaces[i_face];
+		const uint32_t offset = i_face * 3;
+		mesh.indices[offset + 0] = face.mIndices[0];
+		mesh.indices[offset + 1] = face.mIndices[1];
+		mesh.indices[offset + 2] = face.mIndices[2];
+	}
+
+	// Bones
+	if (assimpMesh->mNumBones > 0)
+	{
+		for (uint32_t i_bone = 0; i_bone < assimpMesh->mNumBones; ++i_bone)
+		{
+			parseAssimpBone(ctx, *assimpMesh->mBones[i_bone]);
+		}
+
+		std::vector<uint32_t> influenceOnVerticies(mesh.vertices.size(), 0);
+		std::string boneName;
+		for (uint32_t i_bone = 0; i_bone < assimpMesh->mNumBones; ++i_bone)
+		{
+			const aiBone& bone = *assimpMesh->mBones[i_bone];
+			boneName = bone.mName.C_Str();
+			const uint32_t boneIndex = ctx.importedBones[boneName];
+
+			for (uint32_t i_weight = 0; i_weight < bone.mNumWeights; ++i_weight)
+			{
+				const aiVertexWeight& assimpWeight = bone.mWeights[i_weight];
+				vertex_t& vert = mesh.vertices[assimpWeight.mVertexId];
+				uint32_t& coord = influenceOnVerticies[assimpWeight.mVertexId];
+				if (coord < 4)
+				{
+					vert.boneID[coord] = boneIndex;
+					vert.weight[coord] = assimpWeight.mWeight;
+					++coord;
+				}
+			}
+		}
+
+		// Normalize weights
+		float goodWeights[4];
+		int maxGoodWeights;
+		for (uint32_t i_vertex = 0; i_vertex < assimpMesh->mNumVertices; ++i_vertex)
+		{
+			maxGoodWeights = 0;
+			vertex_t& vert = mesh.vertices[i_vertex];
+			for (int i = 0; i < 4; ++i)
+			{
+				if (vert.boneID[i] == INVALID_INDEX)  //
+					break;
+
+				goodWeights[maxGoodWeights++] = vert.weight[i];
+			}
+
+			if (maxGoodWeights > 0)
+			{
+				float mag = 0.0F;
+				for (int i = 0; i < maxGoodWeights; ++i)
+					mag += goodWeights[i];
+
+				if (mag > 0.00001F)
+				{
+					for (int i = 0; i < maxGoodWeights; ++i)
+						vert.weight[i] = goodWeights[i] / mag;
+				}
+			}
+		}
+	}
+
+	// Material
+	if (assimpMesh->mMaterialIndex < scene.mNumMaterials)
+	{
+		mesh.materialIndex = parseAssimpMaterial(ctx, scene.mMaterials[assimpMesh->mMaterialIndex]);
+	}
+	else
+	{
+		mesh.materialIndex = INVALID_INDEX;
+	}
+
+	if (ctx.deduplication != GeometryDeduplication::NONE)  //
+		return deduplicateMesh(ctx, assimpMesh, meshIndex);
+	return meshIndex;
+}
+
+// Depth-first in child order with an explicit stack, so deep hierarchies don't exhaust the call stack.
+// Nodes without a mesh are skipped, their children are attached to the closest mesh node above them.
+// A node of a mesh placed over shared geometry takes the placement, its children are moved back by the inverse.
+static void parseAssimpMeshNode(ImportContext& ctx, const aiScene& scene, aiNode* root, uint32_t parentIndex)
+{
+	struct PendingNode
+	{
+		aiNode* node;
+		uint32_t parentIndex;
+		const ImportContext::MeshPlacement* parentPlacement;
+	};
+
+	std::vector<PendingNode> pending;
+	pending.push_back({root, parentIndex, nullptr});
+	while (!pending.empty())
+	{
+		const auto [assimpNode, nodeParentIndex, parentPlacement] = pending.back();
+		pending.pop_back();
+
+		if (!assimpNode || !ctx.importedNodes.insert(assimpNode).second)  //
+			continue;
+
+		uint32_t childParentIndex = nodeParentIndex;
+		const ImportContext::MeshPlacement* childPlacement = parentPlacement;
+		if (assimpNode->mNumMeshes != 0)
+		{
+			if (assimpNode->mNumMeshes != 1)
+			{
+				CXMF_LOG(ctx.logger, "FATAL ERROR: Node '{}' has more than one mesh!", assimpNode->mName.C_Str());
+				std::abort();
+			}
+
+			childParentIndex = static_cast<uint32_t>(ctx.nodes.size());
+			MeshHierarchy& node = ctx.nodes.emplace_back();
+
+			node.name = assimpNode->mName.C_Str();
+			if (node.name.empty()) node.name = ctx.genDummyName();
+			node.parentIndex = nodeParentIndex;
+
+			aiMesh* const assimpMesh = scene.mMeshes[assimpNode->mMeshes[0]];
+			node.meshIndex = parseAssimpMesh(ctx, scene, assimpMesh);
+
+			childPlacement = ctx.getMeshPlacement(assimpMesh);
+			if (parentPlacement || childPlacement)
+			{
+				glm::mat4 localTransform;
+				convertAssimpMatrixToGLM(localTransform, assimpNode->mTransformation);
+				if (parentPlacement) localTransform = parentPlacement->inverse * localTransform;
+				if (childPlacement) localTransform = localTransform * childPlacement->transform;
+				convertGLMMatrixToCXMF(node.localTransform, localTransform);
+			}
+			else
+			{
+				convertAssimpMatrixToCXMF(node.localTransform, assimpNode->mTransformation);
+			}
+		}
+
+		// Reversed, so the first child is visited next
+		for (uint32_t i_node = assimpNode->mNumChildren; i_node > 0; --i_node)
+		{
+			pending.push_back({assimpNode->mChildren[i_node - 1], childParentIndex, childPlacement});
+		}
+	}
+}
+
+static void parseAssimpMetaData(ImportContext& ctx, const aiScene& scene)
+{
+	ctx.modelCopyright.clear();
+	ctx.modelGenerator.clear();
+
+	bool hasCopyright = false;
+	bool hasGenerator = false;
+	for (uint32_t i = 0; i < scene.mMetaData->mNumProperties; ++i)
+	{
+		const aiString& key = scene.mMetaData->mKeys[i];
+		const aiMetadataEntry& entry = scene.mMetaData->mValues[i];
+		if (std::strcmp(key.C_Str(), AI_METADATA_SOURCE_COPYRIGHT) == 0)
+		{
+			hasCopyright = true;
+			if (entry.mType == AI_AISTRING)
+			{
+				const aiString& copyright = *static_cast<aiString*>(entry.mData);
+				if (copyright.length > 0)
+				{
+					ctx.modelCopyright = copyright.C_Str();
+				}
+			}
+		}
+		else if (std::strcmp(key.C_Str(), AI_METADATA_SOURCE_GENERATOR) == 0)
+		{
+			hasGenerator = true;
+			if (entry.mType == AI_AISTRING)
+			{
+				const aiString& generator = *static_cast<aiString*>(entry.mData);
+				if (generator.length > 0)
+				{
+					ctx.modelGenerator = generator.C_Str();
+				}
+			}
+		}
+
+		if (hasCopyright && hasGenerator)  //
+			break;
+	}
+}
+
+static bool parseAssimp(const char* filename, ImportContext& ctx)
+{
+	if (Assimp::DefaultLogger::isNullLogger())
+	{
+		Assimp::DefaultLogger::create(nullptr, Assimp::Logger::LogSeverity::NORMAL, 0, nullptr);
+	}
+
+	CXMFAssimpScopeLogStream logStream(ctx.logger);
+	Assimp::Importer importer;
+	importer.SetIOHandler(new CXMFAssimpRecordingIOSystem(ctx.sourceFiles));
+	importer.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
+	importer.SetPropertyInteger(AI_CONFIG_PP_LBW_MAX_WEIGHTS, ASSIMP_MAX_BONE_WEIGHTS);
+	importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, ASSIMP_REMOVED_PRIMITIVES);
+
+	const aiScene* const scene = importer.ReadFile(filename, ASSIMP_IMPORT_FLAGS);
+	if (!scene)
+	{
+		CXMF_LOG(ctx.logger, "Failed to import '{}' | {}", filename, importer.GetErrorString());
+		return false;
+	}
+
+	if (!scene->HasMeshes())
+	{
+		CXMF_LOG(ctx.logger, "Scene no meshes '{}'", filename);
+		return false;
+	}
+
+	parseAssimpMetaData(ctx, *scene);
+
+	if (scene->mName.length > 0)
+	{
+		ctx.modelName = scene->mName.C_Str();
+	}
+	else
+	{
+		ctx.modelName = ctx.genDummyName();
+	}
+
+	for (uint32_t i_mesh = 0; i_mesh < scene->mNumMeshes; ++i_mesh)
+	{
+		const aiMesh* const assimpMesh = scene->mMeshes[i_mesh];
+		for (uint32_t i_bone = 0; assimpMesh && i_bone < assimpMesh->mNumBones; ++i_bone)
+		{
+			const aiBone* const assimpBone = assimpMesh->mBones[i_bone];
+			if (assimpBone) ctx.sceneBones.try_emplace(assimpBone->mName.C_Str(), assimpBone);
+		}
+	}
+
+	parseAssimpMeshNode(ctx, *scene, scene->mRootNode, INVALID_INDEX);
+	return true;
+}
+
+// Import context records use the default resource, they are copied to the resource of the model
+template <typename _FromTy, typename _Ty>
+static void copy_records(const _FromTy& from, std::pmr::vector<_Ty>& to)
+{
+	to.reserve(from.size());
+	for (const _Ty& record : from) emplace_record(to) = record;
+}
+
+// Meshlets keep their offsets and vertex indices local to the mesh, the ranges record where the set of the mesh begins
+static MeshletRanges append_meshlet_set(Model& model, const ImportContext::IntermediateMeshlets& set)
+{
+	MeshletRanges ranges;
+	ranges.meshletVertexOffset = model.meshletVertices.size();
+	ranges.meshletTriangleOffset = model.meshletTriangles.size();
+	ranges.meshletOffset = static_cast<uint32_t>(model.meshlets.size());
+	ranges.meshletCount = set.meshletCount;
+	ranges.lodOffset = static_cast<uint32_t>(model.meshLods.size());
+	ranges.lodCount = static_cast<uint32_t>(set.lods.size());
+	ranges.clusterOffset = static_cast<uint32_t>(model.clusters.size());
+	ranges.clusterCount = static_cast<uint32_t>(set.clusters.size());
+	ranges.clusterGroupOffset = static_cast<uint32_t>(model.clusterGroups.size());
+	ranges.clusterGroupCount = static_cast<uint32_t>(set.clusterGroups.size());
+
+	for (const MeshLod& lod : set.lods)
+	{
+		MeshLod& meshLod = model.meshLods.emplace_back(lod);
+		meshLod.meshletOffset += ranges.meshletOffset;
+	}
+	for (const Cluster& cluster : set.clusters)
+	{
+		Cluster& meshCluster = model.clusters.emplace_back(cluster);
+		meshCluster.meshletIndex += ranges.meshletOffset;
+		if (meshCluster.group != INVALID_INDEX) meshCluster.group += ranges.clusterGroupOffset;
+		if (meshCluster.parentGroup != INVALID_INDEX) meshCluster.parentGroup += ranges.clusterGroupOffset;
+	}
+	model.clusterGroups.insert(model.clusterGroups.end(), set.clusterGroups.begin(), set.clusterGroups.end());
+
+	model.meshletVertices.insert(model.meshletVertices.end(), set.meshletVertices.begin(), set.meshletVertices.end());
+	model.meshletTriangles.insert(model.meshletTriangles.end(), set.meshletTriangles.begin(), set.meshletTriangles.end());
+	model.meshlets.insert(model.meshlets.end(), set.meshlets.begin(), set.meshlets.end());
+	model.meshletCones.insert(model.meshletCones.end(), set.meshletCones.begin(), set.meshletCones.end());
+	return ranges;
+}
+
+static size_t makeCXMFGeneral(Model& model, ImportContext& ctx)
+{
+	model.name = ctx.modelName;
+	model.bounds = ctx.modelAABB.getSphere();
+	model.copyright = ctx.modelCopyright;
+	model.generator = ctx.modelGenerator;
+	model.flags = 0;
+	model.version = GetVersion();
+
+	copy_records(ctx.textures, model.textures);
+	copy_records(ctx.samplers, model.samplers);
+	copy_records(ctx.materials, model.materials);
+	copy_records(ctx.nodes, model.meshNodes);
+
+	uint64_t totalVertices = 0;
+	size_t totalIndices = 0;
+	size_t totalMeshlets = 0;
+	size_t totalMeshletVertices = 0;
+	size_t totalMeshletTriangles = 0;
+	model.meshes.reserve(ctx.meshes.size());
+	for (const ImportContext::IntermediateMesh& m : ctx.meshes)
+	{
+		Mesh& mesh = emplace_record(model.meshes);
+		mesh.name = m.name;
+		mesh.bounds = m.aabb.getSphere();
+		mesh.vertexOffset = totalVertices;
+		mesh.vertexCount = static_cast<uint32_t>(m.vertices.size());
+		mesh.materialIndex = m.materialIndex;
+		mesh.indexBatchOffset = static_cast<uint32_t>(model.indexBatches.size());
+		mesh.indexBatchCount = static_cast<uint32_t>(m.indexBatches.size());
+		totalVertices += m.vertices.size();
+
+		for (const IndexBatch& batch : m.indexBatches)
+		{
+			IndexBatch& meshBatch = model.indexBatches.emplace_back(batch);
+			meshBatch.indexOffset += totalIndices;
+		}
+		totalIndices += m.indices.size();
+
+		for (const ImportContext::IntermediateMeshlets& set : m.meshletSets)
+		{
+			totalMeshlets += set.meshlets.size();
+			totalMeshletVertices += set.meshletVertices.size();
+			totalMeshletTriangles += set.meshletTriangles.size();
+		}
+	}
+
+	model.meshlets.reserve(totalMeshlets);
+	model.meshletCones.reserve(totalMeshlets);
+	model.meshletVertices.reserve(totalMeshletVertices);
+	model.meshletTriangles.reserve(totalMeshletTriangles);
+	if (ctx.indices16)
+	{
+		model.indices16.reserve(totalIndices);
+		for (const ImportContext::IntermediateMesh& m : ctx.meshes)
+		{
+			for (const uint32_t index : m.indices) model.indices16.push_back(static_cast<uint16_t>(index));
+		}
+	}
+	else
+	{
+		model.indices.reserve(totalIndices);
+		for (const ImportContext::IntermediateMesh& m : ctx.meshes)
+			model.indices.insert(model.indices.end(), m.indices.begin(), m.indices.end());
+	}
+
+	// Sets follow each other in the model arrays, so the data of one set is contiguous and the rest can be dropped on load
+	const size_t meshesCount = ctx.meshes.size();
+	std::vector<MeshletRanges> ranges(meshesCount * ctx.meshletSets.size());
+	for (size_t i_set = 0; i_set < ctx.meshletSets.size(); ++i_set)
+	{
+		for (size_t i_mesh = 0; i_mesh < meshesCount; ++i_mesh)
+		{
+			const ImportContext::IntermediateMesh& m = ctx.meshes[i_mesh];
+			if (m.geometryMesh == INVALID_INDEX) ranges[i_set * meshesCount + i_mesh] = append_meshlet_set(model, m.meshletSets[i_set]);
+		}
+	}
+
+	// Meshes over shared geometry take the ranges of their source, it always comes first
+	for (size_t i_mesh = 0; i_mesh < meshesCount; ++i_mesh)
+	{
+		const uint32_t geometryMesh = ctx.meshes[i_mesh].geometryMesh;
+		if (geometryMesh == INVALID_INDEX) continue;
+
+		const Mesh& source = model.meshes[geometryMesh];
+		Mesh& mesh = model.meshes[i_mesh];
+		mesh.bounds = source.bounds;
+		mesh.vertexOffset = source.vertexOffset;
+		mesh.vertexCount = source.vertexCount;
+		mesh.indexBatchOffset = source.indexBatchOffset;
+		mesh.indexBatchCount = source.indexBatchCount;
+		ctx.meshes[i_mesh].statistics = ctx.meshes[geometryMesh].statistics;
+		for (size_t i_set = 0; i_set < ctx.meshletSets.size(); ++i_set)
+		{
+			ranges[i_set * meshesCount + i_mesh] = ranges[i_set * meshesCount + geometryMesh];
+		}
+	}
+
+	for (size_t i_mesh = 0; i_mesh < meshesCount; ++i_mesh) set_meshlet_ranges(model.meshes[i_mesh], ranges[i_mesh]);
+
+	if (ctx.meshStatistics)
+	{
+		model.meshStatistics.reserve(meshesCount);
+		for (const ImportContext::IntermediateMesh& m : ctx.meshes) model.meshStatistics.push_back(m.statistics);
+	}
+
+	model.meshletSets.assign(ctx.meshletSets.begin(), ctx.meshletSets.end());
+	model.meshletSetRanges.assign(ranges.begin() + static_cast<ptrdiff_t>(meshesCount), ranges.end());
+	return static_cast<size_t>(totalVertices);
+}
+
+template <typename _VertTy>
+requires (std::is_same_v<_VertTy, Vertex> || std::is_same_v<_VertTy, WeightedVertex>)
+static void makeCXMFVertices(std::pmr::vector<_VertTy>& outVertices,	 //
+							 const std::vector<ImportContext::IntermediateMesh>& ctxMeshes)
+{
+	size_t vertexOffset = 0;
+	for (const ImportContext::IntermediateMesh& m : ctxMeshes)
+	{
+		const uint32_t meshVertexCount = static_cast<uint32_t>(m.vertices.size());
+		for (uint32_t i = 0; i < meshVertexCount; ++i)
+		{
+			const ImportContext::IntermediateVertex& inV = m.vertices[i];
+			_VertTy& outV = outVertices[vertexOffset + i];
+			for (int i = 0; i < 3; ++i)
+			{
+				outV.position[i] = inV.position[i];
+				outV.normal[i] = inV.normal[i];
+				outV.tangent[i] = inV.tangent[i];
+			}
+			for (int i = 0; i < 2; ++i)
+			{
+				outV.uv[i] = inV.uv[i];
+			}
+
+			if constexpr (std::is_same_v<_VertTy, WeightedVertex>)
+			{
+				for (int i = 0; i < 4; ++i)
+				{
+					outV.boneID[i] = inV.boneID[i];
+					outV.weight[i] = inV.weight[i];
+				}
+			}
+		}
+		vertexOffset += meshVertexCount;
+	}
+}
+
+static SkinnedModel* makeCXMFSkinned(ImportContext& ctx, std::pmr::memory_resource* resource)
+{
+	SkinnedModel* const model = new SkinnedModel(resource);
+	const size_t totalVertices = makeCXMFGeneral(*model, ctx);
+	model->vertices.resize(totalVertices);
+	makeCXMFVertices(model->vertices, ctx.meshes);
+
+	copy_records(ctx.bones, model->bones);
+	return model;
+}
+
+static StaticModel* makeCXMFStatic(ImportContext& ctx, std::pmr::memory_resource* resource)
+{
+	StaticModel* const model = new StaticModel(resource);
+	const size_t totalVertices = makeCXMFGeneral(*model, ctx);
+	model->vertices.resize(totalVertices);
+	makeCXMFVertices(model->vertices, ctx.meshes);
+	return model;
+}
+
+// Meshes are optimized in parallel, each one only touches its own arrays and the model is assembled in mesh order,
+// so the result is the same for any thread count
+static Model* importModel(const char* filename, const LoadOptions& options, std::span<const MeshletLimits> meshletSets,
+						  Logger* logger, std::vector<std::string>* sourceFiles = nullptr)
+{
+	ImportContext ctx;
+	ctx.logger = logger;
+	ctx.deduplication = options.geometryDeduplication;
+	ctx.meshStatistics = options.meshStatistics;
+	ctx.indices16 = options.indexBuffers && options.indexBuffers16;
+	ctx.meshletSets.assign(meshletSets.begin(), meshletSets.end());
+	if (!parseAssimp(filename, ctx))  //
+		return nullptr;
+
+	if (sourceFiles) *sourceFiles = std::move(ctx.sourceFiles);
+
+	// Biggest meshes are taken first so a large one doesn't start last and leave the other threads idle
+	std::vector<uint32_t> order;
+	order.reserve(ctx.meshes.size());
+	for (uint32_t i = 0; i < ctx.meshes.size(); ++i)
+	{
+		if (ctx.meshes[i].geometryMesh == INVALID_INDEX) order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(),
+					 [&](uint32_t a, uint32_t b) { return ctx.meshes[a].indices.size() > ctx.meshes[b].indices.size(); });
+
+	const size_t vertexSize = ctx.hasBones() ? sizeof(WeightedVertex) : sizeof(Vertex);
+	parallel_for(order.size(), options.threadCount,
+				 [&](size_t i) { optimizeMesh(ctx.meshes[order[i]], ctx.meshletSets, vertexSize, options); });
+
+	std::pmr::memory_resource* const resource = resolve_memory_resource(options.memoryResource);
+	if (ctx.hasBones())
+	{
+		return makeCXMFSkinned(ctx, resource);
+	}
+	else
+	{
+		return makeCXMFStatic(ctx, resource);
+	}
+}
+
+
+
+// Import cache
+
+// Content address of the import cache entries: FNV-1a 64, CRC-32 and the size of the hashed bytes
+class ContentHash
+{
+private:
+	uint64_t m_Fnv;
+	uLong m_Crc;
+	uint64_t m_Size;
+
+public:
+	ContentHash()
+		: m_Fnv(14695981039346656037ULL),
+		  m_Crc(crc32(0L, Z_NULL, 0)),
+		  m_Size(0)
+	{}
+
+	void update(const void* data, size_t size)
 	{
-		for (int col = 0; col < 4; ++col)
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		m_Size += size;
+		for (size_t i = 0; i < size; ++i) m_Fnv = (m_Fnv ^ bytes[i]) * 1099511628211ULL;
+
+		while (size > 0)
 		{
-			mat[col * 4 + row] = assimpMat[row][col];
+			const uInt chunk = static_cast<uInt>(std::min<size_t>(size, std::numeric_limits<uInt>::max()));
+			m_Crc = crc32(m_Crc, bytes, chunk);
+			bytes += chunk;
+			size -= chunk;
 		}
 	}
-}
 
-static void convertGLMMatrixToCXMF(Mat4x4& mat, const glm::mat4& glmMat)
-{
-	for (int col = 0; col < 4; ++col)
+	bool updateFile(const char* filePath)
 	{
-		for (int row = 0; row < 4; ++row)
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file.is_open()) return false;
+
+		std::vector<char> buffer(1024 * 1024);
+		while (file)
 		{
-			mat[col * 4 + row] = glmMat[col][row];
+			file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			update(buffer.data(), static_cast<size_t>(file.gcount()));
 		}
+		return file.eof();
 	}
-}
 
-static glm::vec2 assimpVectorToGLM(const aiVector2D& vec)
+	std::string str() const
+	{
+		return std::format("{:016x}{:08x}{:016x}", m_Fnv, m_Crc, m_Size);
+	}
+};
+
+// Key of the imported file and the importer settings, it names the list of the files the import references
+static std::string import_cache_key(const std::string& filePath, const LoadOptions& options,
+									std::span<const MeshletLimits> meshletSets)
 {
-	return glm::vec2(vec.x, vec.y);
+	const uint32_t settings[] = {GetVersion(),
+								 ASSIMP_IMPORT_FLAGS,
+								 static_cast<uint32_t>(ASSIMP_MAX_BONE_WEIGHTS),
+								 static_cast<uint32_t>(ASSIMP_REMOVED_PRIMITIVES),
+								 static_cast<uint32_t>(options.geometryDeduplication),
+								 options.lodCount,
+								 std::bit_cast<uint32_t>(options.lodRatio),
+								 std::bit_cast<uint32_t>(options.lodMaxError),
+								 static_cast<uint32_t>(options.clusterLod),
+								 std::bit_cast<uint32_t>(options.meshletConeWeight),
+								 static_cast<uint32_t>(options.indexBuffers),
+								 static_cast<uint32_t>(options.indexBuffers16),
+								 std::bit_cast<uint32_t>(options.overdrawThreshold),
+								 static_cast<uint32_t>(options.meshStatistics)};
+	const std::string extension = std::filesystem::path(filePath).extension().string();
+
+	ContentHash hash;
+	hash.update(settings, sizeof(settings));
+	hash.update(meshletSets.data(), meshletSets.size_bytes());
+	hash.update(extension.data(), extension.size());
+	if (!hash.updateFile(filePath.c_str())) return std::string();
+	return hash.str();
 }
 
-static glm::vec3 assimpVectorToGLM(const aiVector3D& vec)
+// Referenced files of the imported file are lines of paths relative to its directory,
+// so the same content imported from another directory is checked against its own files
+static bool read_import_dependencies(const std::filesystem::path& dependenciesPath, std::vector<std::string>& dependencies)
 {
-	return glm::vec3(vec.x, vec.y, vec.z);
+	std::ifstream file(dependenciesPath);
+	if (!file.is_open()) return false;
+
+	std::string line;
+	while (std::getline(file, line)) dependencies.push_back(std::move(line));
+	return file.eof();
 }
 
-struct ImportContext
+// Key of the stored model, the import key and the content of every referenced file.
+// A changed buffer or texture selects another entry, entries of its earlier contents stay valid.
+static std::string import_model_key(const std::string& importKey, const std::filesystem::path& sourceDirectory,
+									const std::vector<std::string>& dependencies)
 {
-	struct IntermediateVertex
-	{
-		glm::vec3 position;
-		glm::vec3 normal;
-		glm::vec2 uv;
-		glm::vec3 tangent;
-		uint32_t boneID[4];
-		float weight[4];
-	};
-
-	struct IntermediateMesh
+	ContentHash hash;
+	hash.update(importKey.data(), importKey.size());
+	for (const std::string& dependency : dependencies)
 	{
-		std::string name;
-		std::vector<IntermediateVertex> vertices;
-		std::vector<uint32_t> indices;
-		std::vector<uint32_t> meshletVertices;
-		std::vector<uint8_t> meshletTriangles;
-		std::vector<Meshlet> meshlets;
-		BoundingBox aabb;
-		uint32_t materialIndex;
-	};
+		ContentHash fileHash;
+		const std::filesystem::path path = sourceDirectory / std::filesystem::path(dependency);
+		if (!fileHash.updateFile(path.string().c_str())) return std::string();
 
-	Logger* logger;
-	BoundingBox modelAABB;
-	std::string modelName;
-	std::string modelCopyright;
-	std::string modelGenerator;
-	std::vector<IntermediateMesh> meshes;
-	std::vector<MeshHierarchy> nodes;
-	std::vector<Texture> textures;
-	std::vector<Sampler> samplers;
-	std::vector<Material> materials;
-	std::list<Bone> bones;
+		const std::string fileKey = fileHash.str();
+		hash.update(dependency.c_str(), dependency.size() + 1);	 // Terminator separates the path from the content
+		hash.update(fileKey.data(), fileKey.size());
+	}
+	return hash.str();
+}
 
-	std::vector<aiNode*> importedNodes;
-	std::unordered_map<aiMesh*, uint32_t> importedMeshes;
-	std::unordered_map<aiMaterial*, uint32_t> importedMaterials;
-	std::unordered_map<std::string, uint32_t> importedTextures;
-	std::unordered_map<std::string, uint32_t> importedBones;
-	uint32_t idCounter;
+// Files are written under temporary names and renamed, so concurrent imports never see a partial entry.
+// The model goes first, an entry exists once its dependencies are in place.
+static bool storeImport(const std::filesystem::path& directory, const std::string& importKey, const Model& model,
+						const std::string& filePath, const std::vector<std::string>& sourceFiles, uint32_t threadCount,
+						Logger* logger)
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
 
-	bool hasNode(aiNode* node) const
+	const std::filesystem::path sourceDirectory = std::filesystem::absolute(filePath, error).parent_path();
+	std::vector<std::string> dependencies;
+	for (const std::string& sourceFile : sourceFiles)
 	{
-		const std::vector<aiNode*>::const_iterator _End = importedNodes.cend();
-		return std::find(importedNodes.cbegin(), _End, node) != _End;
+		if (sourceFile == filePath) continue;
+
+		const std::filesystem::path absolutePath = std::filesystem::absolute(sourceFile, error);
+		std::filesystem::path relativePath = absolutePath.lexically_relative(sourceDirectory);
+		if (relativePath.empty()) relativePath = absolutePath;
+		dependencies.push_back(relativePath.generic_string());
 	}
-	uint32_t getMeshIndex(aiMesh* mesh) const
+
+	const std::string modelKey = import_model_key(importKey, sourceDirectory, dependencies);
+	if (modelKey.empty()) return false;
+
+	const std::filesystem::path modelPath = directory / (modelKey + ".cxmf");
+	const std::filesystem::path dependenciesPath = directory / (importKey + ".deps");
+
+	const std::string suffix = std::format(".{:x}{:x}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()),
+										   std::chrono::steady_clock::now().time_since_epoch().count());
+	const std::filesystem::path modelTemp = modelPath.string() + suffix;
+	const std::filesystem::path dependenciesTemp = dependenciesPath.string() + suffix;
+
+	bool result = false;
 	{
-		const auto _It = importedMeshes.find(mesh);
-		if (_It != importedMeshes.end())  //
-			return _It->second;
-		return INVALID_INDEX;
+		std::ofstream file(modelTemp, std::ios::binary | std::ios::trunc);
+		DefaultOutputStream stream(file);
+
+		// Entries are stored raw, loading them is bound by reading the file
+		SaveOptions options;
+		options.level = CompressionLevel::NONE;
+		options.threadCount = threadCount;
+		result = file.is_open() && SaveToStream(model, stream, options, logger);
 	}
-	uint32_t getMaterialIndex(aiMaterial* material) const
+
+	if (result)
 	{
-		const auto _It = importedMaterials.find(material);
-		if (_It != importedMaterials.end())	 //
-			return _It->second;
-		return INVALID_INDEX;
+		std::ofstream file(dependenciesTemp, std::ios::trunc);
+		for (const std::string& dependency : dependencies) file << dependency << '\n';
+		result = file.good();
 	}
-	uint32_t getBoneIndex(const std::string& boneName) const
+
+	if (result)
 	{
-		const auto _It = importedBones.find(boneName);
-		if (_It != importedBones.end())	 //
-			return _It->second;
-		return INVALID_INDEX;
+		std::filesystem::rename(modelTemp, modelPath, error);
+		if (!error) std::filesystem::rename(dependenciesTemp, dependenciesPath, error);
+		result = !error;
 	}
-	uint32_t getTextureIndex(const std::string& path) const
+
+	std::filesystem::remove(modelTemp, error);
+	std::filesystem::remove(dependenciesTemp, error);
+	return result;
+}
+
+// Limits of the meshlet sets built for imported meshes, the build limits by default
+static bool import_meshlet_sets(const LoadOptions& options, std::vector<MeshletLimits>& meshletSets, Logger* logger)
+{
+	if (options.meshletSets.empty())
 	{
-		const auto _It = importedTextures.find(path);
-		if (_It != importedTextures.end())	//
-			return _It->second;
-		return INVALID_INDEX;
+		meshletSets.assign(1, MeshletLimits{CXMF_MAX_MESHLET_VERTICES, CXMF_MAX_MESHLET_TRIANGLES});
+		return true;
 	}
-	uint32_t getSamplerIndex(const Sampler& s) const
+
+	for (const MeshletLimits& limits : options.meshletSets)
 	{
-		const uint32_t _Sz = static_cast<uint32_t>(samplers.size());
-		for (uint32_t i = 0; i < _Sz; ++i)
+		if (limits.maxVertices < 3 || limits.maxVertices > ASSIMP_MESHLET_VERTEX_LIMIT || limits.maxTriangles < 4 ||
+			limits.maxTriangles > ASSIMP_MESHLET_TRIANGLE_LIMIT || limits.maxTriangles % 4 != 0)
 		{
-			const Sampler& v = samplers[i];
-			if (v.magFilter == s.magFilter &&		 //
-				v.minFilter == s.minFilter &&		 //
-				v.mipmapMode == s.mipmapMode &&		 //
-				v.addressModeU == s.addressModeU &&	 //
-				v.addressModeV == s.addressModeV)
-			{
-				return i;
-			}
+			CXMF_LOG(logger, "Invalid meshlet limits of {} vertices and {} triangles!", limits.maxVertices, limits.maxTriangles);
+			return false;
 		}
-		return INVALID_INDEX;
-	}
-	bool hasBones() const
-	{
-		return !bones.empty();
 	}
+	meshletSets.assign(options.meshletSets.begin(), options.meshletSets.end());
+	return true;
+}
 
-	ImportContext()
-		: logger(nullptr),
-		  modelAABB(),
-		  modelName(),
-		  modelCopyright(),
-		  modelGenerator(),
-		  meshes(),
-		  nodes(),
-		  textures(),
-		  samplers(),
-		  materials(),
-		  bones(),
-		  importedNodes(),
-		  importedMeshes(),
-		  importedMaterials(),
-		  importedTextures(),
-		  importedBones(),
-		  idCounter(0)
-	{}
-
-	std::string genDummyName()
+// All meshlet sets are imported and stored, the selected one is taken after that
+static Model* select_imported_set(Model* model, const LoadOptions& options, Logger* logger)
+{
+	if (model && !selectMeshletSet(*model, options.meshletLimits, logger))
 	{
-		return std::string("unnamed") + std::to_string(idCounter++);
+		delete model;
+		return nullptr;
 	}
-};
-
-
+	return model;
+}
 
-static void optimizeMesh(ImportContext::IntermediateMesh& mesh)
+static Model* importCachedModel(const std::string& filePath, const LoadOptions& options, Logger* logger)
 {
-	using vertex_t = ImportContext::IntermediateVertex;
-
-	const size_t index_count = mesh.indices.size();
-	const size_t unindexed_vertex_count = mesh.vertices.size();
-	std::vector<uint32_t> remap(unindexed_vertex_count);
-	const size_t vertex_count = meshopt_generateVertexRemap(remap.data(), mesh.indices.data(),	//
-															index_count, mesh.vertices.data(),	//
-															unindexed_vertex_count, sizeof(vertex_t));
+	std::vector<MeshletLimits> meshletSets;
+	if (!import_meshlet_sets(options, meshletSets, logger))	 //
+		return nullptr;
 
-	std::vector<uint32_t> newIndexBuffer(index_count);
-	std::vector<vertex_t> newVertexBuffer(vertex_count);
-	meshopt_remapIndexBuffer(newIndexBuffer.data(), mesh.indices.data(), index_count, remap.data());
-	meshopt_remapVertexBuffer(newVertexBuffer.data(), mesh.vertices.data(), unindexed_vertex_count,	 //
-							  sizeof(vertex_t), remap.data());
+	if (!options.importCacheDirectory)	//
+		return select_imported_set(importModel(filePath.c_str(), options, meshletSets, logger), options, logger);
 
+	const std::string key = import_cache_key(filePath, options, meshletSets);
+	if (key.empty())
 	{
-		std::vector<uint32_t> tmpIndices(index_count);
-		std::vector<vertex_t> tmpVertices(vertex_count);
-		meshopt_optimizeVertexCache(tmpIndices.data(), newIndexBuffer.data(), index_count, vertex_count);
-
-		meshopt_optimizeVertexFetch(tmpVertices.data(), tmpIndices.data(), index_count,	 //
-									newVertexBuffer.data(), vertex_count, sizeof(vertex_t));
-
-		newIndexBuffer = std::move(tmpIndices);
-		newVertexBuffer = std::move(tmpVertices);
+		CXMF_LOG(logger, "Can't open '{}'", filePath);
+		return nullptr;
 	}
 
-	const size_t max_meshlets = meshopt_buildMeshletsBound(index_count, CXMF_MAX_MESHLET_VERTICES, CXMF_MAX_MESHLET_TRIANGLES);
-	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
-	std::vector<uint32_t> meshlet_vertices(index_count);
-	std::vector<uint8_t> meshlet_triangles(index_count + max_meshlets * 3);
-	const size_t meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(),						 //
-													   meshlet_triangles.data(), newIndexBuffer.data(), index_count,	 //
-													   &newVertexBuffer[0].position[0], vertex_count, sizeof(vertex_t),	 //
-													   CXMF_MAX_MESHLET_VERTICES, CXMF_MAX_MESHLET_TRIANGLES, 0.0F);
+	const std::filesystem::path directory = options.importCacheDirectory;
+	std::vector<std::string> dependencies;
+	if (read_import_dependencies(directory / (key + ".deps"), dependencies))
 	{
-		const meshopt_Meshlet& last = meshlets[meshlet_count - 1];
-		meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
-		meshlet_triangles.resize(last.triangle_offset + last.triangle_count * 3);
-		meshlets.resize(meshlet_count);
+		std::error_code error;
+		const std::filesystem::path sourceDirectory = std::filesystem::absolute(filePath, error).parent_path();
+		const std::string modelKey = import_model_key(key, sourceDirectory, dependencies);
+		const std::filesystem::path modelPath = directory / (modelKey + ".cxmf");
+		Model* const model = modelKey.empty() || !std::filesystem::exists(modelPath, error)
+								 ? nullptr
+								 : LoadFromFile(modelPath.string().c_str(), options, logger);
+		if (model) return model;
 	}
 
-	mesh.meshlets.reserve(meshlet_count);
-	for (const meshopt_Meshlet& m : meshlets)
-	{
-		uint32_t* const m_vertices = meshlet_vertices.data() + m.vertex_offset;
-		uint8_t* const m_triangles = meshlet_triangles.data() + m.triangle_offset;
-		meshopt_optimizeMeshlet(m_vertices, m_triangles, m.triangle_count, m.vertex_count);
-
-		const meshopt_Bounds bounds = meshopt_computeMeshletBounds(m_vertices, m_triangles, m.triangle_count,	   //
-																   &newVertexBuffer[0].position[0], vertex_count,  //
-																   sizeof(vertex_t));
-
-		Meshlet& newMeshlet = mesh.meshlets.emplace_back();
-		newMeshlet.bounds.center[0] = bounds.center[0];
-		newMeshlet.bounds.center[1] = bounds.center[1];
-		newMeshlet.bounds.center[2] = bounds.center[2];
-		newMeshlet.bounds.radius = bounds.radius;
-		newMeshlet.vertexOffset = m.vertex_offset;
-		newMeshlet.triangleOffset = m.triangle_offset;
-		newMeshlet.vertexCount = m.vertex_count;
-		newMeshlet.triangleCount = m.triangle_count;
-	}
+	std::vector<std::string> sourceFiles;
+	Model* const model = importModel(filePath.c_str(), options, meshletSets, logger, &sourceFiles);
+	if (!model) return nullptr;
 
-	mesh.vertices = std::move(newVertexBuffer);
-	mesh.indices.clear();  // Unused
-	mesh.meshletVertices = std::move(meshlet_vertices);
-	mesh.meshletTriangles = std::move(meshlet_triangles);
+	if (!storeImport(directory, key, *model, filePath, sourceFiles, options.threadCount, logger))
+		CXMF_LOG(logger, "WARNING: Can't store '{}' in the import cache '{}'", filePath, directory.string());
+	return select_imported_set(model, options, logger);
 }
 
+#endif	// CXMF_INCLUDE_IMPORTER
 
+Model* LoadFromFile(const char* filePath, Logger* logger)
+{
+	return LoadFromFile(filePath, LoadOptions(), logger);
+}
 
-static uint32_t parseAssimpBone(ImportContext& ctx, const aiScene& scene, const aiBone& assimpBone)
+Model* LoadFromFile(const char* filePath, const LoadOptions& options, Logger* logger)
 {
-	const std::string boneName = assimpBone.mName.C_Str();
-	uint32_t boneIndex = ctx.getBoneIndex(boneName);
-	if (boneIndex != INVALID_INDEX)	 //
-		return boneIndex;
+	if (!filePath) return nullptr;
 
-	const aiNode& boneNode = *assimpBone.mNode;
+	const std::string str = trim_file_path(filePath);
+	if (str.empty()) return nullptr;
 
-	boneIndex = static_cast<uint32_t>(ctx.bones.size());
-	ctx.importedBones.insert({boneName, boneIndex});
-	Bone& bone = ctx.bones.emplace_back();
-	bone.name = boneName;
-	convertAssimpMatrixToCXMF(bone.inverseBindTransform, boneNode.mTransformation);
-	convertAssimpMatrixToCXMF(bone.offsetMatrix, assimpBone.mOffsetMatrix);
-	if (boneNode.mParent == nullptr)
-	{
-		bone.parentIndex = INVALID_INDEX;
-	}
-	else
+	if (str.ends_with(".cxmf"))
 	{
-		const aiBone* const parentBone = scene.findBone(boneNode.mParent->mName);
-		if (parentBone == nullptr)
+		MappedFile file;
+		if (!file.open(str.c_str()))
 		{
-			bone.parentIndex = INVALID_INDEX;
-		}
-		else
-		{
-			bone.parentIndex = parseAssimpBone(ctx, scene, *parentBone);
-			if (bone.parentIndex == boneIndex)
-			{
-				bone.parentIndex = INVALID_INDEX;
-			}
+			CXMF_LOG(logger, "Can't open '{}'", str.c_str());
+			return nullptr;
 		}
+		return LoadFromMemory(file.data(), file.size(), options, logger);
 	}
-	return boneIndex;
-}
-
-static uint32_t parseAssimpTexture(ImportContext& ctx, aiMaterial* assimpMaterial)
-{
-	aiTextureType textureType = aiTextureType_BASE_COLOR;
-	aiString str;
-	aiReturn result = assimpMaterial->Get(AI_MATKEY_TEXTURE(textureType, 0), str);
-	if (result != aiReturn_SUCCESS || str.length == 0)
+#ifdef CXMF_INCLUDE_IMPORTER
+	else if (str.ends_with(".gltf") || str.ends_with(".glb"))
 	{
-		textureType = aiTextureType_DIFFUSE;
-		result = assimpMaterial->Get(AI_MATKEY_TEXTURE(textureType, 0), str);
+		return importCachedModel(str, options, logger);
 	}
-
-	if (result != aiReturn_SUCCESS || str.length == 0)	//
-		return INVALID_INDEX;
-
-	const std::string texName = str.C_Str();
-	uint32_t textureIndex = ctx.getTextureIndex(texName);
-	if (textureIndex != INVALID_INDEX)	//
-		return textureIndex;
-
-	textureIndex = static_cast<uint32_t>(ctx.textures.size());
-	ctx.importedTextures.insert({texName, textureIndex});
-
-	Texture& tex = ctx.textures.emplace_back();
-	tex.path = texName;
-	tex.samplerIndex = INVALID_INDEX;
-
-	Sampler sampler;
-	aiTextureMapMode mapU, mapV;
-	int filterMag, filterMin;
-
-	const auto convAddressMode = [](aiTextureMapMode mode) -> Sampler::AddressMode
+#endif
+	else
 	{
-		switch (mode)
-		{
-			case aiTextureMapMode_Clamp:
-				return Sampler::AddressMode::CLAMP_TO_EDGE;
-			case aiTextureMapMode_Mirror:
-				return Sampler::AddressMode::MIRRORED_REPEAT;
-			default:
-				return Sampler::AddressMode::REPEAT;
-		}
-	};
+		CXMF_LOG(logger, "Invalid input file extension name '{}'", str.c_str());
+		return nullptr;
+	}
+}
 
-	result = assimpMaterial->Get(AI_MATKEY_MAPPINGMODE_U(textureType, 0), mapU);
-	if (result == aiReturn_SUCCESS)
+static Model* readLegacyModel(LegacyModelStream& modelStream, const HEADER_1_0& header, ModelType modelType,
+							  std::pmr::memory_resource* resource, Logger* logger)
+{
+	switch (modelType)
 	{
-		sampler.addressModeU = convAddressMode(mapU);
+		case ModelType::STATIC:
+		case ModelType::SKINNED:
+			break;
+		default:
+		{
+			CXMF_LOG(logger, "Invalid model type!");
+			return nullptr;
+		}
 	}
-	else
+
+	if (!modelStream.good())
 	{
-		sampler.addressModeU = Sampler::AddressMode::REPEAT;
+		CXMF_LOG(logger, "ERROR: inflateInit ({})", modelStream.error());
+		return nullptr;
 	}
 
-	result = assimpMaterial->Get(AI_MATKEY_MAPPINGMODE_V(textureType, 0), mapV);
-	if (result == aiReturn_SUCCESS)
+	Model* outModel = nullptr;
+	if (modelType == ModelType::STATIC)
 	{
-		sampler.addressModeV = convAddressMode(mapV);
+		StaticModel* const model = new StaticModel(resource);
+		modelStream >> *model;
+		outModel = model;
 	}
-	else
+	else if (modelType == ModelType::SKINNED)
 	{
-		sampler.addressModeV = Sampler::AddressMode::REPEAT;
+		SkinnedModel* const model = new SkinnedModel(resource);
+		modelStream >> *model;
+		outModel = model;
 	}
 
-	result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGFILTER_MAG(textureType, 0), filterMag);
-	if (result == aiReturn_SUCCESS)
+	if (!modelStream.good())
 	{
-		if (static_cast<SamplerMagFilter>(filterMag) == SamplerMagFilter::SamplerMagFilter_Linear)
-			sampler.magFilter = Sampler::Filter::LINEAR;
+		if (modelStream.error() != Z_OK && modelStream.error() != Z_STREAM_END)
+			CXMF_LOG(logger, "ERROR: inflate ({})", modelStream.error());
 		else
-			sampler.magFilter = Sampler::Filter::NEAREST;
-	}
-	else
-	{
-		sampler.magFilter = Sampler::Filter::NEAREST;
+			CXMF_LOG(logger, "Invalid model size!");
+		delete outModel;
+		return nullptr;
 	}
 
-	result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGFILTER_MIN(textureType, 0), filterMin);
-	if (result == aiReturn_SUCCESS)
+	outModel->flags = header.flags;
+	outModel->version = header.version;
+	return outModel;
+}
+
+static Model* loadLegacyModel(const void* data, size_t dataSize, std::pmr::memory_resource* resource, Logger* logger)
+{
+	if (dataSize <= (sizeof(HEADER_1_0) + 1))  //
+		return nullptr;
+
+	const uint8_t* pointer = static_cast<const uint8_t*>(data);
+	HEADER_1_0 header;
+	std::memcpy(&header, pointer, sizeof(HEADER_1_0));
+	pointer += sizeof(HEADER_1_0);
+
+	if (header.baseSize == 0 ||		   //
+		header.compressedSize == 0 ||  //
+		static_cast<size_t>(header.compressedSize) > (dataSize - (sizeof(HEADER_1_0) + 1)))
 	{
-		switch (static_cast<SamplerMinFilter>(filterMin))
-		{
-			case SamplerMinFilter::SamplerMinFilter_Linear:
-			{
-				sampler.minFilter = Sampler::Filter::LINEAR;
-				sampler.mipmapMode = Sampler::MipmapMode::NONE;
-				break;
-			}
-			case SamplerMinFilter::SamplerMinFilter_Nearest_Mipmap_Nearest:
-			{
-				sampler.minFilter = Sampler::Filter::NEAREST;
-				sampler.mipmapMode = Sampler::MipmapMode::NEAREST;
-				break;
-			}
-			case SamplerMinFilter::SamplerMinFilter_Linear_Mipmap_Nearest:
-			{
-				sampler.minFilter = Sampler::Filter::LINEAR;
-				sampler.mipmapMode = Sampler::MipmapMode::NEAREST;
-				break;
-			}
-			case SamplerMinFilter::SamplerMinFilter_Nearest_Mipmap_Linear:
-			{
-				sampler.minFilter = Sampler::Filter::NEAREST;
-				sampler.mipmapMode = Sampler::MipmapMode::LINEAR;
-				break;
-			}
-			case SamplerMinFilter::SamplerMinFilter_Linear_Mipmap_Linear:
-			{
-				sampler.minFilter = Sampler::Filter::LINEAR;
-				sampler.mipmapMode = Sampler::MipmapMode::LINEAR;
-				break;
-			}
-			default:
-			{
-				sampler.minFilter = Sampler::Filter::NEAREST;
-				sampler.mipmapMode = Sampler::MipmapMode::NONE;
-				break;
-			}
-		}
+		CXMF_LOG(logger, "Invalid model size!");
+		return nullptr;
 	}
-	else
+
+	const ModelType modelType = static_cast<ModelType>(*pointer);
+	pointer += 1;
+
+	LegacyModelStream modelStream(pointer, header.compressedSize, header.baseSize);
+	return readLegacyModel(modelStream, header, modelType, resource, logger);
+}
+
+// Compressed size is not checked up front, truncated content fails in inflate
+static Model* loadLegacyModel(StreamReader& reader, const HEADER_1_0& header, std::pmr::memory_resource* resource, Logger* logger)
+{
+	uint8_t modelType;
+	if (header.baseSize == 0 || header.compressedSize == 0 || !reader.read(&modelType, sizeof(uint8_t)))
 	{
-		sampler.minFilter = Sampler::Filter::NEAREST;
-		sampler.mipmapMode = Sampler::MipmapMode::NONE;
+		CXMF_LOG(logger, "Invalid model size!");
+		return nullptr;
 	}
 
+	LegacyModelStream modelStream(reader, header.baseSize);
+	return readLegacyModel(modelStream, header, static_cast<ModelType>(modelType), resource, logger);
+}
 
+// Range of 'count' elements from 'offset' lies within 'size' elements
+static bool is_valid_range(uint32_t offset, uint32_t count, size_t size)
+{
+	return offset <= size && count <= size - offset;
+}
 
-	tex.samplerIndex = ctx.getSamplerIndex(sampler);
-	if (tex.samplerIndex != INVALID_INDEX)	//
-		return textureIndex;
-
-	aiString samplerName;
-	result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGNAME(textureType, 0), samplerName);
-	if (result == aiReturn_SUCCESS && samplerName.length > 0)
+// Levels and clusters of a mesh lie within the model arrays
+template <typename _Ty>
+static bool check_meshlet_ranges(const MeshletRanges& ranges, const _Ty& target, Logger* logger)
+{
+	if (!is_valid_range(ranges.lodOffset, ranges.lodCount, target.meshLods.size()))
 	{
-		aiString samplerID;
-		result = assimpMaterial->Get(AI_MATKEY_GLTF_MAPPINGID(textureType, 0), samplerID);
-		if (result == aiReturn_SUCCESS && samplerID.length > 0)
-		{
-			sampler.name = std::string(samplerName.C_Str()) + std::string(samplerID.C_Str());
-		}
-		else
-		{
-			sampler.name = std::string(samplerName.C_Str()) + std::to_string(ctx.idCounter++);
-		}
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESH_LODS));
+		return false;
 	}
-	else
+
+	if (!is_valid_range(ranges.clusterOffset, ranges.clusterCount, target.clusters.size()) ||
+		!is_valid_range(ranges.clusterGroupOffset, ranges.clusterGroupCount, target.clusterGroups.size()))
 	{
-		sampler.name = ctx.genDummyName();
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::CLUSTERS));
+		return false;
 	}
 
-	tex.samplerIndex = static_cast<uint32_t>(ctx.samplers.size());
-	ctx.samplers.push_back(std::move(sampler));
-	return textureIndex;
+	// Groups of the clusters are checked here, so per-mesh loading can rebase them without checks
+	for (uint32_t i = 0; i < ranges.clusterCount; ++i)
+	{
+		const Cluster& cluster = target.clusters[ranges.clusterOffset + i];
+		for (const uint32_t group : {cluster.group, cluster.parentGroup})
+		{
+			const bool isMeshGroup = group >= ranges.clusterGroupOffset && group - ranges.clusterGroupOffset < ranges.clusterGroupCount;
+			if (group != INVALID_INDEX && !isMeshGroup)
+			{
+				CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::CLUSTERS));
+				return false;
+			}
+		}
+	}
+	return true;
 }
 
-static uint32_t parseAssimpMaterial(ImportContext& ctx, aiMaterial* assimpMaterial)
+// Everything except geometry, shared by models and model infos
+template <typename _Ty, typename _BonesTy>
+static bool readMetadataSections(const Container& container, _Ty& target, _BonesTy* bones, Logger* logger)
 {
-	uint32_t materialIndex = ctx.getMaterialIndex(assimpMaterial);
-	if (materialIndex != INVALID_INDEX)	 //
-		return materialIndex;
-
-	const aiString materialName = assimpMaterial->GetName();
+	std::vector<char> strings;
+	if (!read_array_section(container, SectionID::STRINGS, strings, logger))  //
+		return false;
 
-	materialIndex = static_cast<uint32_t>(ctx.materials.size());
-	ctx.importedMaterials.insert({assimpMaterial, materialIndex});
+	const std::string_view stringsView(strings.data(), strings.size());
 
-	Material& mat = ctx.materials.emplace_back();
-	mat.name = materialName.C_Str();
-	if (mat.name.empty()) mat.name = ctx.genDummyName();
-	mat.textureIndex = parseAssimpTexture(ctx, assimpMaterial);
+	std::vector<MODEL_RECORD> modelRecord;
+	if (!read_array_section(container, SectionID::MODEL, modelRecord, logger))	//
+		return false;
 
-	aiColor4D baseColorFactor;
-	aiReturn result = assimpMaterial->Get(AI_MATKEY_BASE_COLOR, baseColorFactor);
-	if (result != aiReturn_SUCCESS)
+	if (modelRecord.size() != 1 ||									 //
+		!read_string(stringsView, modelRecord[0].name, target.name) ||	 //
+		!read_string(stringsView, modelRecord[0].copyright, target.copyright) ||
+		!read_string(stringsView, modelRecord[0].generator, target.generator))
 	{
-		result = assimpMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, baseColorFactor);
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MODEL));
+		return false;
 	}
-	if (result == aiReturn_SUCCESS)
+	target.bounds = modelRecord[0].bounds;
+
+	const bool result =
+		read_record_section<TextureRecord>(container, SectionID::TEXTURES, stringsView, target.textures, logger) &&
+		read_record_section<SamplerRecord>(container, SectionID::SAMPLERS, stringsView, target.samplers, logger) &&
+		read_record_section<MaterialRecord>(container, SectionID::MATERIALS, stringsView, target.materials, logger) &&
+		read_record_section<MeshRecord>(container, SectionID::MESHES, stringsView, target.meshes, logger) &&
+		read_record_section<MeshHierarchyRecord>(container, SectionID::MESH_NODES, stringsView, target.meshNodes, logger) &&
+		(!bones || read_record_section<BoneRecord>(container, SectionID::BONES, stringsView, *bones, logger));
+	if (!result) return false;
+
+	if (static_cast<VertexFormat>(container.header.vertexFormat) == VertexFormat::PACKED)
 	{
-		mat.baseColorFactor[0] = glm::clamp<float>(baseColorFactor[0], 0.0F, 1.0F);
-		mat.baseColorFactor[1] = glm::clamp<float>(baseColorFactor[1], 0.0F, 1.0F);
-		mat.baseColorFactor[2] = glm::clamp<float>(baseColorFactor[2], 0.0F, 1.0F);
-		mat.baseColorFactor[3] = glm::clamp<float>(baseColorFactor[3], 0.0F, 1.0F);
+		std::vector<QuantizationError> errors;
+		if (!read_array_section(container, SectionID::MESH_QUANTIZATION, errors, logger))  //
+			return false;
+
+		if (errors.size() != target.meshes.size())
+		{
+			CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESH_QUANTIZATION));
+			return false;
+		}
+
+		for (size_t i = 0; i < errors.size(); ++i) target.meshes[i].quantizationError = errors[i];
 	}
-	else
+
+	if (!read_array_section(container, SectionID::MESH_LODS, target.meshLods, logger) ||
+		!read_array_section(container, SectionID::CLUSTERS, target.clusters, logger) ||
+		!read_array_section(container, SectionID::CLUSTER_GROUPS, target.clusterGroups, logger) ||
+		!read_array_section(container, SectionID::MESHLET_SETS, target.meshletSets, logger) ||
+		!read_array_section(container, SectionID::MESHLET_SET_RANGES, target.meshletSetRanges, logger) ||
+		!read_array_section(container, SectionID::INDEX_BATCHES, target.indexBatches, logger) ||
+		!read_array_section(container, SectionID::MESH_STATISTICS, target.meshStatistics, logger))
 	{
-		mat.baseColorFactor[0] = 1.0F;
-		mat.baseColorFactor[1] = 1.0F;
-		mat.baseColorFactor[2] = 1.0F;
-		mat.baseColorFactor[3] = 1.0F;
+		return false;
 	}
 
-	float roughnessFactor;
-	result = assimpMaterial->Get(AI_MATKEY_ROUGHNESS_FACTOR, roughnessFactor);
-	if (result == aiReturn_SUCCESS)
+	if (!target.meshStatistics.empty() && target.meshStatistics.size() != target.meshes.size())
 	{
-		mat.roughnessFactor = glm::clamp<float>(roughnessFactor, 0.0F, 1.0F);
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESH_STATISTICS));
+		return false;
 	}
-	else
+
+	const size_t extraSets = target.meshletSets.empty() ? 0 : target.meshletSets.size() - 1;
+	if (target.meshletSetRanges.size() != extraSets * target.meshes.size())
 	{
-		mat.roughnessFactor = 1.0F;
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESHLET_SET_RANGES));
+		return false;
 	}
 
-	float metallicFactor;
-	result = assimpMaterial->Get(AI_MATKEY_METALLIC_FACTOR, metallicFactor);
-	if (result == aiReturn_SUCCESS)
+	for (const Mesh& mesh : target.meshes)
 	{
-		mat.metallicFactor = glm::clamp<float>(metallicFactor, 0.0F, 1.0F);
+		if (!check_meshlet_ranges(get_meshlet_ranges(mesh), target, logger)) return false;
+
+		if (!is_valid_range(mesh.indexBatchOffset, mesh.indexBatchCount, target.indexBatches.size()))
+		{
+			CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::INDEX_BATCHES));
+			return false;
+		}
 	}
-	else
+	for (const MeshletRanges& ranges : target.meshletSetRanges)
 	{
-		mat.metallicFactor = 1.0F;
+		if (!check_meshlet_ranges(ranges, target, logger)) return false;
 	}
+	return true;
+}
 
-	float ambientOcclusionFactor;
-	result = assimpMaterial->Get(AI_MATKEY_LIGHTMAP_FACTOR, ambientOcclusionFactor);
-	if (result == aiReturn_SUCCESS)
+// Loading of a sectioned model is split in stages: metadata, vertices and meshlets, 'LoadAsync' suspends between them
+static Model* allocate_model(ModelType type, std::pmr::memory_resource* resource)
+{
+	if (type == ModelType::STATIC) return new StaticModel(resource);
+	return new SkinnedModel(resource);
+}
+
+static bool readModelMetadata(const Container& container, Model& model, Logger* logger)
+{
+	std::pmr::vector<Bone>* const bones = model.GetType() == ModelType::SKINNED ? &model.SkinnedModelCast()->bones : nullptr;
+	if (!readMetadataSections(container, model, bones, logger))	 //
+		return false;
+
+	model.flags = container.header.flags;
+	model.version = container.header.version;
+	return true;
+}
+
+static Model* createModel(const Container& container, std::pmr::memory_resource* resource, Logger* logger)
+{
+	Model* const model = allocate_model(static_cast<ModelType>(container.header.modelType), resource);
+	if (!readModelMetadata(container, *model, logger))
 	{
-		mat.ambientOcclusionFactor = glm::clamp<float>(ambientOcclusionFactor, 0.0F, 1.0F);
+		delete model;
+		return nullptr;
 	}
-	else
+	return model;
+}
+
+// Cones are optional, but once stored every meshlet has one
+static bool check_meshlet_cones(const Model& model, Logger* logger)
+{
+	if (model.meshletCones.empty() || model.meshletCones.size() == model.meshlets.size()) return true;
+
+	CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESHLET_CONES));
+	return false;
+}
+
+static bool readMeshletSections(const Container& container, Model& model, Logger* logger)
+{
+	return read_array_section(container, SectionID::MESHLETS, model.meshlets, logger) &&
+		   read_array_section(container, SectionID::MESHLET_CONES, model.meshletCones, logger) &&
+		   read_array_section(container, SectionID::MESHLET_VERTICES, model.meshletVertices, logger) &&
+		   read_array_section(container, SectionID::MESHLET_TRIANGLES, model.meshletTriangles, logger) &&
+		   check_meshlet_cones(model, logger);
+}
+
+// Batches are whole triangle lists within the 16-bit index buffer if the model has one, otherwise within the 32-bit one,
+// their values are checked per mesh by 'ModelStream'
+static bool check_index_batches(std::span<const IndexBatch> batches, uint64_t indexCount32, uint64_t indexCount16, Logger* logger)
+{
+	if (indexCount32 != 0 && indexCount16 != 0)
 	{
-		mat.ambientOcclusionFactor = 1.0F;
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::INDICES16));
+		return false;
 	}
 
-	aiColor3D emissiveFactor;
-	result = assimpMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, emissiveFactor);
-	if (result == aiReturn_SUCCESS)
+	const uint64_t indexCount = indexCount16 != 0 ? indexCount16 : indexCount32;
+	for (const IndexBatch& batch : batches)
 	{
-		mat.emissiveFactor[0] = glm::clamp<float>(emissiveFactor[0], 0.0F, 1.0F);
-		mat.emissiveFactor[1] = glm::clamp<float>(emissiveFactor[1], 0.0F, 1.0F);
-		mat.emissiveFactor[2] = glm::clamp<float>(emissiveFactor[2], 0.0F, 1.0F);
+		if (batch.indexCount % 3 != 0 || batch.indexOffset > indexCount || batch.indexCount > indexCount - batch.indexOffset)
+		{
+			CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::INDEX_BATCHES));
+			return false;
+		}
 	}
+	return true;
+}
+
+static bool readIndexSection(const Container& container, Model& model, Logger* logger)
+{
+	return read_array_section(container, SectionID::INDICES, model.indices, logger) &&
+		   read_array_section(container, SectionID::INDICES16, model.indices16, logger) &&
+		   check_index_batches(model.indexBatches, model.indices.size(), model.indices16.size(), logger);
+}
+
+// Packed vertices are restored relative to the bounds of the meshes, so they must be read first
+template <typename _VertexTy, typename _PackedTy>
+static bool readVertexSection(const Container& container, Model& model, std::pmr::vector<_VertexTy>& vertices, Logger* logger)
+{
+	if (static_cast<VertexFormat>(container.header.vertexFormat) == VertexFormat::FLOAT)	//
+		return read_vertex_section(container, vertices, logger);
+
+	std::vector<_PackedTy> packed;
+	if (!read_vertex_section(container, packed, logger))  //
+		return false;
+
+	dequantize_vertices(std::span<const _PackedTy>(packed), 0, std::span<const Mesh>(model.meshes), model.bounds,
+						container.threadCount, vertices);
+	return true;
+}
+
+static bool readVertexSections(const Container& container, Model& model, Logger* logger)
+{
+	if (model.GetType() == ModelType::STATIC)
+		return readVertexSection<Vertex, PackedVertex>(container, model, model.StaticModelCast()->vertices, logger);
 	else
+		return readVertexSection<WeightedVertex, PackedWeightedVertex>(container, model, model.SkinnedModelCast()->vertices, logger);
+}
+
+Model* LoadFromMemory(const void* data, size_t dataSize, Logger* logger)
+{
+	return LoadFromMemory(data, dataSize, LoadOptions(), logger);
+}
+
+Model* LoadFromMemory(const void* data, size_t dataSize, const LoadOptions& options, Logger* logger)
+{
+	uint32_t version;
+	if (!check_model_version(data, dataSize, version, logger))	//
+		return nullptr;
+
+	if (is_legacy_version(version))	 //
+		return loadLegacyModel(data, dataSize, resolve_memory_resource(options.memoryResource), logger);
+
+	Container container;
+	if (!open_container(container, data, dataSize, logger))	 //
+		return nullptr;
+
+	container.threadCount = options.threadCount;
+
+	std::unique_ptr<Model> model(createModel(container, resolve_memory_resource(options.memoryResource), logger));
+	if (!model) return nullptr;
+
+	if (!readVertexSections(container, *model, logger) || !readMeshletSections(container, *model, logger) ||
+		!readIndexSection(container, *model, logger) || !selectMeshletSet(*model, options.meshletLimits, logger))
 	{
-		mat.emissiveFactor[0] = 0.0F;
-		mat.emissiveFactor[1] = 0.0F;
-		mat.emissiveFactor[2] = 0.0F;
+		return nullptr;
 	}
+	return model.release();
+}
 
-	aiString alphaMode;
-	result = assimpMaterial->Get(AI_MATKEY_GLTF_ALPHAMODE, alphaMode);
-	if (result == aiReturn_SUCCESS)
+
+
+// Sections are decoded in the stored order, geometry goes right into the model arrays,
+// the rest is gathered raw into a container and read like a model in memory
+static bool streamModel(StreamReader& reader, const HEADER& header, std::span<const SECTION> sections, Model& model,
+						uint32_t threadCount, Logger* logger)
+{
+	// Packed or split vertices are gathered with the rest and restored once the meshes are read
+	const bool isDirect = static_cast<VertexFormat>(header.vertexFormat) == VertexFormat::FLOAT &&
+						  static_cast<VertexLayout>(header.vertexLayout) == VertexLayout::INTERLEAVED;
+	std::vector<uint8_t> content;
+	std::vector<SECTION> stored;
+
+	for (const SECTION& section : sections)
 	{
-		if (std::strcmp(alphaMode.C_Str(), "OPAQUE") == 0)
+		if (!reader.skip(aligned_offset(reader.position(), SECTION_ALIGNMENT) - reader.position()))
 		{
-			mat.alphaMode = Material::AlphaMode::OPAQUE;
-			mat.alphaCutoff = 0.0F;
+			CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(section.id));
+			return false;
 		}
-		else if (std::strcmp(alphaMode.C_Str(), "MASK") == 0)
+
+		bool result;
+		if (section.id == SectionID::VERTICES && isDirect)
 		{
-			mat.alphaMode = Material::AlphaMode::MASK;
-			float alphaCutoff;
-			result = assimpMaterial->Get(AI_MATKEY_GLTF_ALPHACUTOFF, alphaCutoff);
-			if (result == aiReturn_SUCCESS)
-			{
-				mat.alphaCutoff = glm::clamp<float>(alphaCutoff, 0.0F, 1.0F);
-			}
+			if (model.GetType() == ModelType::STATIC)
+				result = stream_array_section(reader, section, model.StaticModelCast()->vertices, logger);
 			else
-			{
-				mat.alphaCutoff = 0.5F;
-			}
+				result = stream_array_section(reader, section, model.SkinnedModelCast()->vertices, logger);
 		}
-		else if (std::strcmp(alphaMode.C_Str(), "BLEND") == 0)
+		else if (section.id == SectionID::MESHLETS)
 		{
-			mat.alphaMode = Material::AlphaMode::BLEND;
-			mat.alphaCutoff = 0.0F;
+			result = stream_array_section(reader, section, model.meshlets, logger);
+		}
+		else if (section.id == SectionID::MESHLET_CONES)
+		{
+			result = stream_array_section(reader, section, model.meshletCones, logger);
+		}
+		else if (section.id == SectionID::MESHLET_VERTICES)
+		{
+			result = stream_array_section(reader, section, model.meshletVertices, logger);
+		}
+		else if (section.id == SectionID::MESHLET_TRIANGLES)
+		{
+			result = stream_array_section(reader, section, model.meshletTriangles, logger);
+		}
+		else if (section.id == SectionID::INDICES)
+		{
+			result = stream_array_section(reader, section, model.indices, logger);
+		}
+		else if (section.id == SectionID::INDICES16)
+		{
+			result = stream_array_section(reader, section, model.indices16, logger);
 		}
 		else
 		{
-			mat.alphaMode = Material::AlphaMode::OPAQUE;
-			mat.alphaCutoff = 0.0F;
+			SECTION& raw = stored.emplace_back(section);
+			raw.encoding = SectionEncoding::RAW;
+			raw.offset = content.size();
+			raw.size = section.baseSize;
+			result = stream_section(reader, section, content, static_cast<size_t>(raw.offset), logger);
 		}
-	}
-	else
-	{
-		mat.alphaMode = Material::AlphaMode::OPAQUE;
-		mat.alphaCutoff = 0.0F;
-	}
 
-	bool doubleSided;
-	result = assimpMaterial->Get(AI_MATKEY_TWOSIDED, doubleSided);
-	if (result == aiReturn_SUCCESS)
-	{
-		mat.doubleSided = doubleSided;
-	}
-	else
-	{
-		mat.doubleSided = false;
+		if (!result) return false;
 	}
 
-	aiShadingMode shadingMode;
-	result = assimpMaterial->Get(AI_MATKEY_SHADING_MODEL, shadingMode);
-	if (result == aiReturn_SUCCESS)
-	{
-		mat.shadeless = (shadingMode == aiShadingMode_Unlit);
-	}
-	else
+	Container container;
+	container.data = content.data();
+	container.dataSize = content.size();
+	container.header = header;
+	container.header.sectionCount = static_cast<uint32_t>(stored.size());
+	container.sections = std::move(stored);
+	container.threadCount = threadCount;
+
+	if (!readModelMetadata(container, model, logger) || !check_meshlet_cones(model, logger) ||
+		!check_index_batches(model.indexBatches, model.indices.size(), model.indices16.size(), logger))
 	{
-		mat.shadeless = false;
+		return false;
 	}
-	return materialIndex;
+
+	return isDirect || readVertexSections(container, model, logger);
 }
 
-static uint32_t parseAssimpMesh(ImportContext& ctx, const aiScene& scene, aiMesh* assimpMesh)
+Model* LoadFromStream(InputStream& stream, Logger* logger)
 {
-	uint32_t meshIndex = ctx.getMeshIndex(assimpMesh);
-	if (meshIndex != INVALID_INDEX)	 //
-		return meshIndex;
+	return LoadFromStream(stream, LoadOptions(), logger);
+}
 
-	using vertex_t = ImportContext::IntermediateVertex;
-	using mesh_t = ImportContext::IntermediateMesh;
+Model* LoadFromStream(InputStream& stream, const LoadOptions& options, Logger* logger)
+{
+	std::pmr::memory_resource* const resource = resolve_memory_resource(options.memoryResource);
+	StreamReader reader(stream);
 
-	const bool hasTextureCoords = assimpMesh->HasTextureCoords(0);
+	HEADER_1_0 legacyHeader;
+	if (!reader.read(&legacyHeader, sizeof(HEADER_1_0)))
+	{
+		CXMF_LOG(logger, "Invalid model size!");
+		return nullptr;
+	}
 
-	meshIndex = static_cast<uint32_t>(ctx.meshes.size());
-	ctx.importedMeshes.insert({assimpMesh, meshIndex});
-	mesh_t& mesh = ctx.meshes.emplace_back();
-	mesh.name = assimpMesh->mName.C_Str();
-	if (mesh.name.empty()) mesh.name = ctx.genDummyName();
+	uint32_t version;
+	if (!check_model_version(&legacyHeader, sizeof(HEADER_1_0), version, logger))	//
+		return nullptr;
 
-	mesh.aabb.min = assimpVectorToGLM(assimpMesh->mAABB.mMin);
-	mesh.aabb.max = assimpVectorToGLM(assimpMesh->mAABB.mMax);
-	ctx.modelAABB.min = glm::min(ctx.modelAABB.min, mesh.aabb.min);
-	ctx.modelAABB.max = glm::max(ctx.modelAABB.max, mesh.aabb.max);
+	if (is_legacy_version(version))	 //
+		return loadLegacyModel(reader, legacyHeader, resource, logger);
 
-	// Vertices
-	mesh.vertices.resize(assimpMesh->mNumVertices);
-	for (uint32_t i_vertex = 0; i_vertex < assimpMesh->mNumVertices; ++i_vertex)
+	HEADER header;
+	std::memcpy(&header, &legacyHeader, sizeof(HEADER_1_0));
+	if (!reader.read(reinterpret_cast<uint8_t*>(&header) + sizeof(HEADER_1_0), sizeof(HEADER) - sizeof(HEADER_1_0)))
 	{
-		vertex_t& vert = mesh.vertices[i_vertex];
-		vert.position = assimpVectorToGLM(assimpMesh->mVertices[i_vertex]);
-		vert.normal = assimpVectorToGLM(assimpMesh->mNormals[i_vertex]);
-		vert.tangent = assimpVectorToGLM(assimpMesh->mTangents[i_vertex]);
+		CXMF_LOG(logger, "Invalid model size!");
+		return nullptr;
+	}
 
-		if (hasTextureCoords)
-		{
-			const aiVector3D& uv = assimpMesh->mTextureCoords[0][i_vertex];
-			vert.uv[0] = uv[0];
-			vert.uv[1] = uv[1];
-		}
-		else
-		{
-			vert.uv[0] = 0.0F;
-			vert.uv[1] = 0.0F;
-		}
+	if (!check_header(header, logger)) return nullptr;
 
-		for (int i = 0; i < 4; ++i)
+	// Only the leading table is read, entries are read one by one so a broken count fails at the end of the stream
+	std::vector<SECTION> sections;
+	for (uint32_t i = 0; i < header.sectionCount; ++i)
+	{
+		if (!reader.read(&sections.emplace_back(), sizeof(SECTION)))
 		{
-			vert.boneID[i] = INVALID_INDEX;
-			vert.weight[i] = 0.0F;
+			CXMF_LOG(logger, "Invalid model size!");
+			return nullptr;
 		}
 	}
 
-	// Indices
-	mesh.indices.resize(static_cast<size_t>(assimpMesh->mNumFaces) * 3);
-	for (uint32_t i_face = 0; i_face < assimpMesh->mNumFaces; ++i_face)
+	std::unique_ptr<Model> model(allocate_model(static_cast<ModelType>(header.modelType), resource));
+	if (!streamModel(reader, header, sections, *model, options.threadCount, logger) ||
+		!selectMeshletSet(*model, options.meshletLimits, logger))
 	{
-		const aiFace& face = assimpMesh->mFaces[i_face];
-		const uint32_t offset = i_face * 3;
-		mesh.indices[offset + 0] = face.mIndices[0];
-		mesh.indices[offset + 1] = face.mIndices[1];
-		mesh.indices[offset + 2] = face.mIndices[2];
+		return nullptr;
 	}
+	return model.release();
+}
 
-	// Bones
-	if (assimpMesh->mNumBones > 0)
-	{
-		for (uint32_t i_bone = 0; i_bone < assimpMesh->mNumBones; ++i_bone)
-		{
-			parseAssimpBone(ctx, scene, *assimpMesh->mBones[i_bone]);
-		}
-
-		std::vector<uint32_t> influenceOnVerticies(mesh.vertices.size(), 0);
-		std::string boneName;
-		for (uint32_t i_bone = 0; i_bone < assimpMesh->mNumBones; ++i_bone)
-		{
-			const aiBone& bone = *assimpMesh->mBones[i_bone];
-			boneName = bone.mName.C_Str();
-			const uint32_t boneIndex = ctx.importedBones[boneName];
-
-			for (uint32_t i_weight = 0; i_weight < bone.mNumWeights; ++i_weight)
-			{
-				const aiVertexWeight& assimpWeight = bone.mWeights[i_weight];
-				vertex_t& vert = mesh.vertices[assimpWeight.mVertexId];
-				uint32_t& coord = influenceOnVerticies[assimpWeight.mVertexId];
-				if (coord < 4)
-				{
-					vert.boneID[coord] = boneIndex;
-					vert.weight[coord] = assimpWeight.mWeight;
-					++coord;
-				}
-			}
-		}
 
-		// Normalize weights
-		float goodWeights[4];
-		int maxGoodWeights;
-		for (uint32_t i_vertex = 0; i_vertex < assimpMesh->mNumVertices; ++i_vertex)
-		{
-			maxGoodWeights = 0;
-			vertex_t& vert = mesh.vertices[i_vertex];
-			for (int i = 0; i < 4; ++i)
-			{
-				if (vert.boneID[i] == INVALID_INDEX)  //
-					break;
 
-				goodWeights[maxGoodWeights++] = vert.weight[i];
-			}
+bool ProbeFile(const char* filePath, ModelInfo& info, Logger* logger)
+{
+	if (!filePath) return false;
 
-			if (maxGoodWeights > 0)
-			{
-				float mag = 0.0F;
-				for (int i = 0; i < maxGoodWeights; ++i)
-					mag += goodWeights[i];
+	const std::string str = trim_file_path(filePath);
+	if (!str.ends_with(".cxmf"))
+	{
+		CXMF_LOG(logger, "Invalid input file extension name '{}'", str.c_str());
+		return false;
+	}
 
-				if (mag > 0.00001F)
-				{
-					for (int i = 0; i < maxGoodWeights; ++i)
-						vert.weight[i] = goodWeights[i] / mag;
-				}
-			}
-		}
+	// Only the pages of the header and metadata sections are actually read
+	MappedFile file;
+	if (!file.open(str.c_str()))
+	{
+		CXMF_LOG(logger, "Can't open '{}'", str.c_str());
+		return false;
 	}
+	return ProbeMemory(file.data(), file.size(), info, logger);
+}
 
-	// Material
-	if (assimpMesh->mMaterialIndex < scene.mNumMaterials)
+template <typename _Ty>
+static void move_array(std::pmr::vector<_Ty>& from, std::vector<_Ty>& to)
+{
+	to.assign(std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+}
+
+// CXMF 1.0 layout has no separate geometry, so the info is taken from the whole model
+static void takeModelInfo(Model& model, ModelInfo& info)
+{
+	info.type = model.GetType();
+	info.vertexFormat = VertexFormat::FLOAT;
+	info.vertexLayout = VertexLayout::INTERLEAVED;
+	info.name = model.name;
+	move_array(model.textures, info.textures);
+	move_array(model.samplers, info.samplers);
+	move_array(model.materials, info.materials);
+	move_array(model.meshes, info.meshes);
+	move_array(model.meshNodes, info.meshNodes);
+	move_array(model.meshLods, info.meshLods);
+	move_array(model.clusters, info.clusters);
+	move_array(model.clusterGroups, info.clusterGroups);
+	move_array(model.meshletSets, info.meshletSets);
+	move_array(model.meshletSetRanges, info.meshletSetRanges);
+	move_array(model.indexBatches, info.indexBatches);
+	move_array(model.meshStatistics, info.meshStatistics);
+	info.bounds = model.bounds;
+	info.copyright = model.copyright;
+	info.generator = model.generator;
+	info.flags = model.flags;
+	info.version = model.version;
+	info.meshletCount = model.meshlets.size();
+	info.meshletVertexCount = model.meshletVertices.size();
+	info.meshletTriangleCount = model.meshletTriangles.size();
+	info.indexCount = model.indices.size();
+	info.indexCount16 = model.indices16.size();
+
+	if (StaticModel* const staticModel = model.StaticModelCast())
 	{
-		mesh.materialIndex = parseAssimpMaterial(ctx, scene.mMaterials[assimpMesh->mMaterialIndex]);
+		info.vertexCount = staticModel->vertices.size();
 	}
-	else
+	else if (SkinnedModel* const skinnedModel = model.SkinnedModelCast())
 	{
-		mesh.materialIndex = INVALID_INDEX;
+		info.vertexCount = skinnedModel->vertices.size();
+		move_array(skinnedModel->bones, info.bones);
 	}
-	return meshIndex;
 }
 
-static void parseAssimpMeshNode(ImportContext& ctx, const aiScene& scene, aiNode* root, uint32_t parentIndex)
+static bool readModelInfo(const Container& container, ModelInfo& info, Logger* logger);
+
+bool ProbeMemory(const void* data, size_t dataSize, ModelInfo& info, Logger* logger)
 {
-	if (!root || ctx.hasNode(root))	 //
-		return;
+	info = ModelInfo();
 
-	ctx.importedNodes.push_back(root);
+	uint32_t version;
+	if (!check_model_version(data, dataSize, version, logger))	//
+		return false;
 
-	if (root->mNumMeshes == 0)
+	if (is_legacy_version(version))
 	{
-		for (uint32_t i_node = 0; i_node < root->mNumChildren; ++i_node)
-		{
-			parseAssimpMeshNode(ctx, scene, root->mChildren[i_node], parentIndex);
-		}
-		return;
-	}
+		Model* const model = loadLegacyModel(data, dataSize, std::pmr::get_default_resource(), logger);
+		if (!model) return false;
 
-	if (root->mNumMeshes != 1)
-	{
-		CXMF_LOG(ctx.logger, "FATAL ERROR: Node '{}' has more than one mesh!", root->mName.C_Str());
-		std::abort();
+		takeModelInfo(*model, info);
+		delete model;
+		return true;
 	}
 
-	const uint32_t currentIndex = static_cast<uint32_t>(ctx.nodes.size());
-	MeshHierarchy& node = ctx.nodes.emplace_back();
+	Container container;
+	if (!open_container(container, data, dataSize, logger))	 //
+		return false;
 
-	node.name = root->mName.C_Str();
-	if (node.name.empty()) node.name = ctx.genDummyName();
-	convertAssimpMatrixToCXMF(node.localTransform, root->mTransformation);
-	node.parentIndex = parentIndex;
+	return readModelInfo(container, info, logger);
+}
 
-	aiMesh* const assimpMesh = scene.mMeshes[root->mMeshes[0]];
-	node.meshIndex = parseAssimpMesh(ctx, scene, assimpMesh);
+static bool readModelInfo(const Container& container, ModelInfo& info, Logger* logger)
+{
+	info.type = static_cast<ModelType>(container.header.modelType);
+	info.vertexFormat = static_cast<VertexFormat>(container.header.vertexFormat);
+	info.vertexLayout = static_cast<VertexLayout>(container.header.vertexLayout);
+	info.flags = container.header.flags;
+	info.version = container.header.version;
+	if (!readMetadataSections(container, info, info.type == ModelType::SKINNED ? &info.bones : nullptr, logger))  //
+		return false;
 
-	for (uint32_t i_node = 0; i_node < root->mNumChildren; ++i_node)
-	{
-		parseAssimpMeshNode(ctx, scene, root->mChildren[i_node], currentIndex);
-	}
+	size_t vertexSize;
+	if (info.type == ModelType::STATIC)
+		vertexSize = info.vertexFormat == VertexFormat::PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+	else
+		vertexSize = info.vertexFormat == VertexFormat::PACKED ? sizeof(PackedWeightedVertex) : sizeof(WeightedVertex);
+
+	// Counts come from the decoded sizes in the section table, geometry is not touched
+	info.vertexCount = vertex_count(container, vertexSize);
+	info.meshletCount = section_element_count(container, SectionID::MESHLETS, sizeof(Meshlet));
+	info.meshletVertexCount = section_element_count(container, SectionID::MESHLET_VERTICES, sizeof(uint32_t));
+	info.meshletTriangleCount = section_element_count(container, SectionID::MESHLET_TRIANGLES, sizeof(uint8_t));
+	info.indexCount = section_element_count(container, SectionID::INDICES, sizeof(uint32_t));
+	info.indexCount16 = section_element_count(container, SectionID::INDICES16, sizeof(uint16_t));
+	return check_index_batches(info.indexBatches, info.indexCount, info.indexCount16, logger);
 }
 
-static void parseAssimpMetaData(ImportContext& ctx, const aiScene& scene)
+
+
+struct ModelView::Storage
 {
-	ctx.modelCopyright.clear();
-	ctx.modelGenerator.clear();
+	MappedFile file;
+};
 
-	bool hasCopyright = false;
-	bool hasGenerator = false;
-	for (uint32_t i = 0; i < scene.mMetaData->mNumProperties; ++i)
+ModelView* OpenViewFromFile(const char* filePath, Logger* logger)
+{
+	if (!filePath) return nullptr;
+
+	const std::string str = trim_file_path(filePath);
+	if (str.empty()) return nullptr;
+
+	ModelView::Storage* const storage = new ModelView::Storage();
+	if (!storage->file.open(str.c_str()))
 	{
-		const aiString& key = scene.mMetaData->mKeys[i];
-		const aiMetadataEntry& entry = scene.mMetaData->mValues[i];
-		if (std::strcmp(key.C_Str(), AI_METADATA_SOURCE_COPYRIGHT) == 0)
-		{
-			hasCopyright = true;
-			if (entry.mType == AI_AISTRING)
-			{
-				const aiString& copyright = *static_cast<aiString*>(entry.mData);
-				if (copyright.length > 0)
-				{
-					ctx.modelCopyright = copyright.C_Str();
-				}
-			}
-		}
-		else if (std::strcmp(key.C_Str(), AI_METADATA_SOURCE_GENERATOR) == 0)
-		{
-			hasGenerator = true;
-			if (entry.mType == AI_AISTRING)
-			{
-				const aiString& generator = *static_cast<aiString*>(entry.mData);
-				if (generator.length > 0)
-				{
-					ctx.modelGenerator = generator.C_Str();
-				}
-			}
-		}
+		CXMF_LOG(logger, "Can't open '{}'", str.c_str());
+		delete storage;
+		return nullptr;
+	}
 
-		if (hasCopyright && hasGenerator)  //
-			break;
+	ModelView* const view = new ModelView();
+	view->m_Storage = storage;
+	if (!view->init(storage->file.data(), storage->file.size(), logger))
+	{
+		delete view;
+		return nullptr;
 	}
+	return view;
 }
 
-static bool parseAssimp(const char* filename, ImportContext& ctx)
+ModelView* OpenViewFromMemory(const void* data, size_t dataSize, Logger* logger)
 {
-	if (Assimp::DefaultLogger::isNullLogger())
+	ModelView* const view = new ModelView();
+	if (!view->init(data, dataSize, logger))
 	{
-		Assimp::DefaultLogger::create(nullptr, Assimp::Logger::LogSeverity::NORMAL, 0, nullptr);
+		delete view;
+		return nullptr;
 	}
+	return view;
+}
 
-	CXMFAssimpScopeLogStream logStream(ctx.logger);
-	Assimp::Importer importer;
-	importer.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
-	importer.SetPropertyInteger(AI_CONFIG_PP_LBW_MAX_WEIGHTS, 4);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
-	constexpr uint32_t importFlags = aiProcess_CalcTangentSpace |		//
-									 aiProcess_JoinIdenticalVertices |	//
-									 aiProcess_Triangulate |			//
-									 aiProcess_GenNormals |				//
-									 aiProcess_LimitBoneWeights |		//
-									 aiProcess_ValidateDataStructure |	//
-									 // aiProcess_ImproveCacheLocality |		 //
-									 aiProcess_RemoveRedundantMaterials |  //
-									 aiProcess_PopulateArmatureData |	   //
-									 aiProcess_SortByPType |			   //
-									 // aiProcess_OptimizeMeshes |			   //
-									 // aiProcess_OptimizeGraph |			   //
-									 aiProcess_FlipUVs |  //
-									 aiProcess_GenBoundingBoxes;
-
-	const aiScene* const scene = importer.ReadFile(filename, importFlags);
-	if (!scene)
+ModelView::ModelView()
+	: m_Storage(nullptr),
+	  m_Type(ModelType::STATIC),
+	  m_VertexFormat(VertexFormat::FLOAT),
+	  m_VertexLayout(VertexLayout::INTERLEAVED),
+	  m_Flags(0),
+	  m_Version(0),
+	  m_Strings(),
+	  m_Name(),
+	  m_Copyright(),
+	  m_Generator(),
+	  m_Bounds(),
+	  m_Textures(),
+	  m_Samplers(),
+	  m_Materials(),
+	  m_Meshes(),
+	  m_MeshNodes(),
+	  m_Bones(),
+	  m_Vertices(),
+	  m_WeightedVertices(),
+	  m_PackedVertices(),
+	  m_PackedWeightedVertices(),
+	  m_VertexStreams(),
+	  m_QuantizationErrors(),
+	  m_Meshlets(),
+	  m_MeshletCones(),
+	  m_MeshLods(),
+	  m_Clusters(),
+	  m_ClusterGroups(),
+	  m_MeshletSets(),
+	  m_MeshletSetRanges(),
+	  m_IndexBatches(),
+	  m_Indices(),
+	  m_Indices16(),
+	  m_MeshStatistics(),
+	  m_MeshletVertices(),
+	  m_MeshletTriangles()
+{
+	//
+}
+
+ModelView::~ModelView()
+{
+	delete m_Storage;
+}
+
+// Point the streams right into their sections, every stream must have an element per vertex
+static bool view_vertex_streams(const Container& container, std::span<const uint8_t> (&streams)[VERTEX_STREAM_COUNT], Logger* logger)
+{
+	const ModelType type = static_cast<ModelType>(container.header.modelType);
+	const VertexFormat format = static_cast<VertexFormat>(container.header.vertexFormat);
+	const uint64_t vertexCount = section_element_count(container, SectionID::VERTEX_POSITIONS,  //
+													   vertex_stream_fields(type, format, VertexStream::POSITION).stride());
+	for (uint32_t i = 0; i < VERTEX_STREAM_COUNT; ++i)
 	{
-		CXMF_LOG(ctx.logger, "Failed to import '{}' | {}", filename, importer.GetErrorString());
+		const VertexStreamFields fields = vertex_stream_fields(type, format, static_cast<VertexStream>(i));
+		if (fields.count == 0) continue;
+
+		if (!view_section(container, vertex_stream_section(i), streams[i], logger)) return false;
+
+		if (streams[i].size() != vertexCount * fields.stride())
+		{
+			CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(vertex_stream_section(i)));
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ModelView::init(const void* data, size_t dataSize, Logger* logger)
+{
+	uint32_t version;
+	if (!check_model_version(data, dataSize, version, logger))	//
+		return false;
+
+	if (is_legacy_version(version))
+	{
+		CXMF_LOG(logger, "Model is saved in CXMF 1.0 layout, re-save it to open as view!");
 		return false;
 	}
 
-	if (!scene->HasMeshes())
+	if (reinterpret_cast<uintptr_t>(data) % VIEW_ALIGNMENT != 0)
 	{
-		CXMF_LOG(ctx.logger, "Scene no meshes '{}'", filename);
+		CXMF_LOG(logger, "Model buffer must be aligned to {} bytes to open as view!", VIEW_ALIGNMENT);
 		return false;
 	}
 
-	parseAssimpMetaData(ctx, *scene);
+	Container container;
+	if (!open_container(container, data, dataSize, logger))	 //
+		return false;
 
-	if (scene->mName.length > 0)
+	std::span<const char> strings;
+	std::span<const MODEL_RECORD> modelRecord;
+	if (!view_section(container, SectionID::STRINGS, strings, logger) ||  //
+		!view_section(container, SectionID::MODEL, modelRecord, logger))
 	{
-		ctx.modelName = scene->mName.C_Str();
+		return false;
 	}
-	else
+
+	if (modelRecord.size() != 1)
 	{
-		ctx.modelName = ctx.genDummyName();
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MODEL));
+		return false;
 	}
 
-	parseAssimpMeshNode(ctx, *scene, scene->mRootNode, INVALID_INDEX);
-	return true;
-}
-
-static uint32_t makeCXMFGeneral(Model& model, ImportContext& ctx)
-{
-	model.name = ctx.modelName;
-	model.bounds = ctx.modelAABB.getSphere();
-	model.copyright = ctx.modelCopyright;
-	model.generator = ctx.modelGenerator;
-	model.flags = 0;
-	model.version = GetVersion();
-
-	model.textures = std::move(ctx.textures);
-	model.samplers = std::move(ctx.samplers);
-	model.materials = std::move(ctx.materials);
-	model.meshNodes = std::move(ctx.nodes);
+	m_Strings = std::string_view(strings.data(), strings.size());
+	m_Type = static_cast<ModelType>(container.header.modelType);
+	m_VertexFormat = static_cast<VertexFormat>(container.header.vertexFormat);
+	m_VertexLayout = static_cast<VertexLayout>(container.header.vertexLayout);
+	m_Flags = container.header.flags;
+	m_Version = container.header.version;
+	m_Name = GetString(modelRecord[0].name);
+	m_Copyright = GetString(modelRecord[0].copyright);
+	m_Generator = GetString(modelRecord[0].generator);
+	m_Bounds = modelRecord[0].bounds;
+
+	const bool result = view_section(container, SectionID::TEXTURES, m_Textures, logger) &&
+						view_section(container, SectionID::SAMPLERS, m_Samplers, logger) &&
+						view_section(container, SectionID::MATERIALS, m_Materials, logger) &&
+						view_section(container, SectionID::MESHES, m_Meshes, logger) &&
+						view_section(container, SectionID::MESH_NODES, m_MeshNodes, logger) &&
+						view_section(container, SectionID::MESHLETS, m_Meshlets, logger) &&
+						view_section(container, SectionID::MESHLET_CONES, m_MeshletCones, logger) &&
+						view_section(container, SectionID::MESH_LODS, m_MeshLods, logger) &&
+						view_section(container, SectionID::CLUSTERS, m_Clusters, logger) &&
+						view_section(container, SectionID::CLUSTER_GROUPS, m_ClusterGroups, logger) &&
+						view_section(container, SectionID::MESHLET_SETS, m_MeshletSets, logger) &&
+						view_section(container, SectionID::MESHLET_SET_RANGES, m_MeshletSetRanges, logger) &&
+						view_section(container, SectionID::INDEX_BATCHES, m_IndexBatches, logger) &&
+						view_section(container, SectionID::INDICES, m_Indices, logger) &&
+						view_section(container, SectionID::INDICES16, m_Indices16, logger) &&
+						view_section(container, SectionID::MESH_STATISTICS, m_MeshStatistics, logger) &&
+						view_section(container, SectionID::MESHLET_VERTICES, m_MeshletVertices, logger) &&
+						view_section(container, SectionID::MESHLET_TRIANGLES, m_MeshletTriangles, logger);
+	if (!result || !check_index_batches(m_IndexBatches, m_Indices.size(), m_Indices16.size(), logger)) return false;
+
+	if (!m_MeshStatistics.empty() && m_MeshStatistics.size() != m_Meshes.size())
+	{
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESH_STATISTICS));
+		return false;
+	}
 
-	size_t totalMeshlets = 0;
-	size_t totalMeshletVertices = 0;
-	size_t totalMeshletTriangles = 0;
-	model.meshes.reserve(ctx.meshes.size());
-	for (const ImportContext::IntermediateMesh& m : ctx.meshes)
+	if (!m_MeshletCones.empty() && m_MeshletCones.size() != m_Meshlets.size())
 	{
-		Mesh& mesh = model.meshes.emplace_back();
-		mesh.name = m.name;
-		mesh.bounds = m.aabb.getSphere();
-		mesh.meshletOffset = static_cast<uint32_t>(totalMeshlets);
-		mesh.meshletCount = static_cast<uint32_t>(m.meshlets.size());
-		mesh.materialIndex = m.materialIndex;
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESHLET_CONES));
+		return false;
+	}
 
-		totalMeshlets += m.meshlets.size();
-		totalMeshletVertices += m.meshletVertices.size();
-		totalMeshletTriangles += m.meshletTriangles.size();
+	const size_t extraSets = m_MeshletSets.empty() ? 0 : m_MeshletSets.size() - 1;
+	if (m_MeshletSetRanges.size() != extraSets * m_Meshes.size())
+	{
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESHLET_SET_RANGES));
+		return false;
 	}
 
-	model.meshlets.reserve(totalMeshlets);
-	model.meshletVertices.reserve(totalMeshletVertices);
-	model.meshletTriangles.reserve(totalMeshletTriangles);
-	uint32_t totalVertices = 0;
-	uint32_t meshletVerticesOffset = 0;
-	uint32_t meshletTrianglesOffset = 0;
-	std::vector<uint32_t> tempMeshletVertices;
-	const uint32_t meshesCount = static_cast<uint32_t>(ctx.meshes.size());
-	for (uint32_t i_mesh = 0; i_mesh < meshesCount; ++i_mesh)
+	if (m_VertexFormat == VertexFormat::PACKED)
 	{
-		const ImportContext::IntermediateMesh& m = ctx.meshes[i_mesh];
-		model.meshes[i_mesh].vertexOffset = totalVertices;
-		model.meshes[i_mesh].vertexCount = static_cast<uint32_t>(m.vertices.size());
+		if (!view_section(container, SectionID::MESH_QUANTIZATION, m_QuantizationErrors, logger)) return false;
 
-		tempMeshletVertices = m.meshletVertices;
-		for (uint32_t& v : tempMeshletVertices)
+		if (m_QuantizationErrors.size() != m_Meshes.size())
 		{
-			v += totalVertices;
+			CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESH_QUANTIZATION));
+			return false;
 		}
+	}
 
-		model.meshletVertices.insert(model.meshletVertices.end(), tempMeshletVertices.begin(), tempMeshletVertices.end());
-		model.meshletTriangles.insert(model.meshletTriangles.end(), m.meshletTriangles.begin(), m.meshletTriangles.end());
-		for (const Meshlet& mt : m.meshlets)
-		{
-			Meshlet& meshlet = model.meshlets.emplace_back();
-			meshlet.bounds = mt.bounds;
-			meshlet.vertexOffset = meshletVerticesOffset + mt.vertexOffset;
-			meshlet.triangleOffset = meshletTrianglesOffset + mt.triangleOffset;
-			meshlet.vertexCount = mt.vertexCount;
-			meshlet.triangleCount = mt.triangleCount;
-		}
+	if (m_Type == ModelType::SKINNED && !view_section(container, SectionID::BONES, m_Bones, logger))  //
+		return false;
 
-		totalVertices += static_cast<uint32_t>(m.vertices.size());
-		meshletVerticesOffset += static_cast<uint32_t>(m.meshletVertices.size());
-		meshletTrianglesOffset += static_cast<uint32_t>(m.meshletTriangles.size());
+	if (m_VertexLayout == VertexLayout::STREAMS)  //
+		return view_vertex_streams(container, m_VertexStreams, logger);
+
+	if (m_Type == ModelType::STATIC)
+	{
+		return m_VertexFormat == VertexFormat::PACKED ? view_section(container, SectionID::VERTICES, m_PackedVertices, logger)
+													  : view_section(container, SectionID::VERTICES, m_Vertices, logger);
+	}
+	else
+	{
+		return m_VertexFormat == VertexFormat::PACKED ? view_section(container, SectionID::VERTICES, m_PackedWeightedVertices, logger)
+													  : view_section(container, SectionID::VERTICES, m_WeightedVertices, logger);
 	}
-	return totalVertices;
 }
 
-template <typename _VertTy>
-requires (std::is_same_v<_VertTy, Vertex> || std::is_same_v<_VertTy, WeightedVertex>)
-static void makeCXMFVertices(std::vector<_VertTy>& outVertices,	 //
-							 const std::vector<ImportContext::IntermediateMesh>& ctxMeshes)
+std::string_view ModelView::GetString(const StringRef& ref) const
 {
-	uint32_t vertexOffset = 0;
-	for (const ImportContext::IntermediateMesh& m : ctxMeshes)
+	std::string_view str;
+	if (!find_string(m_Strings, ref, str))	//
+		return std::string_view();
+	return str;
+}
+
+
+
+// Decoded sections without random access, by section ID
+using SectionCache = std::unordered_map<uint32_t, std::vector<uint8_t>>;
+
+struct ModelStream::Storage
+{
+	MappedFile file;
+	Container container;
+	SectionCache cache;
+};
+
+// Copy [offset, offset + size) of the decoded section content, inflating only the blocks it overlaps
+static bool read_section_range(const Container& container, SectionCache& cache, SectionID id, uint64_t offset, size_t size, void* dst,
+							   Logger* logger)
+{
+	const SECTION* const section = container.find(id);
+	const uint64_t baseSize = section ? section->baseSize : 0;
+	if (offset + size > baseSize)
 	{
-		const uint32_t meshVertexCount = static_cast<uint32_t>(m.vertices.size());
-		for (uint32_t i = 0; i < meshVertexCount; ++i)
+		CXMF_LOG(logger, "Invalid model section {} range!", static_cast<uint32_t>(id));
+		return false;
+	}
+
+	if (size == 0) return true;
+
+	switch (section->encoding)
+	{
+		case SectionEncoding::RAW:
 		{
-			const ImportContext::IntermediateVertex& inV = m.vertices[i];
-			_VertTy& outV = outVertices[vertexOffset + i];
-			for (int i = 0; i < 3; ++i)
+			if (section->size != section->baseSize)
 			{
-				outV.position[i] = inV.position[i];
-				outV.normal[i] = inV.normal[i];
-				outV.tangent[i] = inV.tangent[i];
+				CXMF_LOG(logger, "Invalid model section {} size!", static_cast<uint32_t>(id));
+				return false;
 			}
-			for (int i = 0; i < 2; ++i)
+			std::memcpy(dst, container.data + section->offset + offset, size);
+			return true;
+		}
+		case SectionEncoding::DEFLATE_BLOCKS:
+		{
+			return inflate_blocks(container, *section, offset, size, dst, logger);
+		}
+		default:
+		{
+			auto it = cache.find(static_cast<uint32_t>(id));
+			if (it == cache.end())
 			{
-				outV.uv[i] = inV.uv[i];
-			}
+				if (!check_decoded_size(container, *section, logger)) return false;
 
-			if constexpr (std::is_same_v<_VertTy, WeightedVertex>)
-			{
-				for (int i = 0; i < 4; ++i)
-				{
-					outV.boneID[i] = inV.boneID[i];
-					outV.weight[i] = inV.weight[i];
-				}
+				std::vector<uint8_t> content(static_cast<size_t>(section->baseSize));
+				if (!decode_section(container, *section, content.data(), content.size(), logger))	//
+					return false;
+
+				it = cache.emplace(static_cast<uint32_t>(id), std::move(content)).first;
 			}
+			std::memcpy(dst, it->second.data() + offset, size);
+			return true;
 		}
-		vertexOffset += meshVertexCount;
 	}
 }
 
-static SkinnedModel* makeCXMFSkinned(ImportContext& ctx)
+// Copy 'count' interleaved vertices from 'first', merged from the stream ranges for 'VertexLayout::STREAMS'
+template <typename _Ty>
+static bool read_vertex_range(const Container& container, SectionCache& cache, uint64_t first, size_t count, _Ty* dst, Logger* logger)
 {
-	SkinnedModel* const model = new SkinnedModel();
-	const uint32_t totalVertices = makeCXMFGeneral(*model, ctx);
-	constexpr uint32_t maxVerticesLimit = std::numeric_limits<uint32_t>::max() / aligned_size(sizeof(WeightedVertex), 16);
-	if (totalVertices >= maxVerticesLimit)
+	if (static_cast<VertexLayout>(container.header.vertexLayout) == VertexLayout::INTERLEAVED)  //
+		return read_section_range(container, cache, SectionID::VERTICES, first * sizeof(_Ty), count * sizeof(_Ty), dst, logger);
+
+	std::vector<uint8_t> stream;
+	for (uint32_t i = 0; i < VERTEX_STREAM_COUNT; ++i)
 	{
-		CXMF_LOG(ctx.logger, "Overflow of the maximum number of vertices in model!");
-		delete model;
-		return nullptr;
-	}
+		const VertexStreamFields fields = vertex_stream_fields<_Ty>(static_cast<VertexStream>(i));
+		if (fields.count == 0) continue;
 
-	model->vertices.resize(totalVertices);
-	makeCXMFVertices(model->vertices, ctx.meshes);
+		stream.resize(count * fields.stride());
+		if (!read_section_range(container, cache, vertex_stream_section(i), first * fields.stride(), stream.size(), stream.data(), logger))
+			return false;
 
-	model->bones.reserve(ctx.bones.size());
-	for (Bone& bone : ctx.bones)
-	{
-		model->bones.push_back(std::move(bone));
+		merge_vertex_stream(stream.data(), sizeof(_Ty), count, fields, reinterpret_cast<uint8_t*>(dst));
 	}
-	return model;
+	return true;
 }
 
-static StaticModel* makeCXMFStatic(ImportContext& ctx)
+template <typename _VertexTy, typename _PackedTy>
+static bool read_mesh_vertices(const Container& container, SectionCache& cache, const ModelInfo& info, const Mesh& mesh,
+							   std::vector<_VertexTy>& out, Logger* logger)
 {
-	StaticModel* const model = new StaticModel();
-	const uint32_t totalVertices = makeCXMFGeneral(*model, ctx);
-	constexpr uint32_t maxVerticesLimit = std::numeric_limits<uint32_t>::max() / aligned_size(sizeof(Vertex), 16);
-	if (totalVertices >= maxVerticesLimit)
+	// Vertex count of the model comes from the section sizes, so the range is checked before it is allocated
+	if (mesh.vertexOffset > info.vertexCount || mesh.vertexCount > info.vertexCount - mesh.vertexOffset)
 	{
-		CXMF_LOG(ctx.logger, "Overflow of the maximum number of vertices in model!");
-		delete model;
-		return nullptr;
+		CXMF_LOG(logger, "Invalid model section {}!", static_cast<uint32_t>(SectionID::MESHES));
+		return false;
 	}
 
-	model->vertices.resize(totalVertices);
-	makeCXMFVertices(model->vertices, ctx.meshes);
-	return model;
+	if (info.vertexFormat == VertexFormat::FLOAT)
+	{
+		out.resize(mesh.vertexCount);
+		return read_vertex_range(container, cache, mesh.vertexOffset, out.size(), out.data(), logger);
+	}
+
+	std::vector<_PackedTy> packed(mesh.vertexCount);
+	if (!read_vertex_range(container, cache, mesh.vertexOffset, packed.size(), packed.data(), logger))	//
+		return false;
+
+	dequantize_vertices(std::span<const _PackedTy>(packed), mesh.vertexOffset, std::span<const Mesh>(info.meshes), info.bounds,
+						container.threadCount, out);
+	return true;
 }
 
-static Model* importModel(const char* filename, Logger* logger)
+ModelStream* OpenStreamFromFile(const char* filePath, Logger* logger)
 {
-	ImportContext ctx;
-	ctx.logger = logger;
-	if (!parseAssimp(filename, ctx))  //
-		return nullptr;
+	return OpenStreamFromFile(filePath, LoadOptions(), logger);
+}
+
+ModelStream* OpenStreamFromFile(const char* filePath, const LoadOptions& options, Logger* logger)
+{
+	if (!filePath) return nullptr;
 
-	for (ImportContext::IntermediateMesh& mesh : ctx.meshes)
+	const std::string str = trim_file_path(filePath);
+	ModelStream* const stream = new ModelStream();
+	stream->m_Storage = new ModelStream::Storage();
+	if (!stream->m_Storage->file.open(str.c_str()))
 	{
-		optimizeMesh(mesh);
+		CXMF_LOG(logger, "Can't open '{}'", str.c_str());
+		delete stream;
+		return nullptr;
 	}
 
-	if (ctx.hasBones())
+	if (!stream->init(stream->m_Storage->file.data(), stream->m_Storage->file.size(), options, logger))
 	{
-		return makeCXMFSkinned(ctx);
+		delete stream;
+		return nullptr;
 	}
-	else
+	return stream;
+}
+
+ModelStream* OpenStreamFromMemory(const void* data, size_t dataSize, const LoadOptions& options, Logger* logger)
+{
+	ModelStream* const stream = new ModelStream();
+	stream->m_Storage = new ModelStream::Storage();
+	if (!stream->init(data, dataSize, options, logger))
 	{
-		return makeCXMFStatic(ctx);
+		delete stream;
+		return nullptr;
 	}
+	return stream;
 }
 
-#endif	// CXMF_INCLUDE_IMPORTER
+ModelStream::ModelStream()
+	: m_Storage(nullptr),
+	  m_Info()
+{
+	//
+}
 
-Model* LoadFromFile(const char* filePath, Logger* logger)
+ModelStream::~ModelStream()
 {
-	if (!filePath) return nullptr;
+	delete m_Storage;
+}
 
-	std::string str = filePath;
-	while (!str.empty() && std::isspace(static_cast<unsigned char>(str.back())))
-		str.pop_back();
+bool ModelStream::init(const void* data, size_t dataSize, const LoadOptions& options, Logger* logger)
+{
+	uint32_t version;
+	if (!check_model_version(data, dataSize, version, logger))	//
+		return false;
 
-	if (str.empty()) return nullptr;
+	if (is_legacy_version(version))
+	{
+		CXMF_LOG(logger, "Model is saved in CXMF 1.0 layout, re-save it to open as stream!");
+		return false;
+	}
 
-	if (str.ends_with(".cxmf"))
+	Container& container = m_Storage->container;
+	if (!open_container(container, data, dataSize, logger))	 //
+		return false;
+
+	container.threadCount = options.threadCount;
+	return readModelInfo(container, m_Info, logger) && selectMeshletRanges(m_Info, options.meshletLimits, logger);
+}
+
+// Batches of the mesh are packed one after another, their base vertices stay relative to the mesh
+template <typename _IndexTy>
+static bool read_mesh_indices(const Container& container, SectionCache& cache, SectionID id, const Mesh& mesh, uint32_t meshIndex,
+							  std::vector<IndexBatch>& batches, std::vector<_IndexTy>& indices, Logger* logger)
+{
+	for (IndexBatch& batch : batches)
 	{
-		const std::optional<std::string> content = load_file_content(str.c_str());
-		if (!content.has_value())
+		if (!check_section_range(container, id, batch.indexOffset, batch.indexCount, sizeof(_IndexTy), logger))  //
+			return false;
+
+		const size_t first = indices.size();
+		indices.resize(first + batch.indexCount);
+		if (!read_section_range(container, cache, id, batch.indexOffset * sizeof(_IndexTy), batch.indexCount * sizeof(_IndexTy),
+								indices.data() + first, logger))
 		{
-			CXMF_LOG(logger, "Can't open '{}'", str.c_str());
-			return nullptr;
+			return false;
 		}
-		const std::string& buf = content.value();
-		return LoadFromMemory(buf.c_str(), buf.length(), logger);
-	}
-#ifdef CXMF_INCLUDE_IMPORTER
-	else if (str.ends_with(".gltf") || str.ends_with(".glb"))
-	{
-		return importModel(str.c_str(), logger);
-	}
-#endif
-	else
-	{
-		CXMF_LOG(logger, "Invalid input file extension name '{}'", str.c_str());
-		return nullptr;
+
+		for (size_t i = first; i < indices.size(); ++i)
+		{
+			if (batch.baseVertex >= mesh.vertexCount || indices[i] >= mesh.vertexCount - batch.baseVertex)
+			{
+				CXMF_LOG(logger, "Index batches of mesh {} reference vertices of other meshes!", meshIndex);
+				return false;
+			}
+		}
+		batch.indexOffset = first;
 	}
+	return true;
 }
 
-Model* LoadFromMemory(const void* data, size_t dataSize, Logger* logger)
+bool ModelStream::LoadMesh(uint32_t meshIndex, MeshGeometry& geometry, Logger* logger)
 {
-	if (!data || dataSize <= (sizeof(HEADER) + 1))	//
-		return nullptr;
+	if (meshIndex >= m_Info.meshes.size())
+	{
+		CXMF_LOG(logger, "Invalid mesh index {}!", meshIndex);
+		return false;
+	}
 
-	const uint8_t* pointer = static_cast<const uint8_t*>(data);
-	const HEADER& header = *reinterpret_cast<const HEADER*>(pointer);
-	pointer += sizeof(HEADER);
+	const Container& container = m_Storage->container;
+	SectionCache& cache = m_Storage->cache;
+	const Mesh& mesh = m_Info.meshes[meshIndex];
 
-	if (header.magic != MAGIC)
+	geometry.meshIndex = meshIndex;
+	geometry.vertices.clear();
+	geometry.weightedVertices.clear();
+
+	const bool vertexResult = m_Info.type == ModelType::STATIC
+								  ? read_mesh_vertices<Vertex, PackedVertex>(container, cache, m_Info, mesh, geometry.vertices, logger)
+								  : read_mesh_vertices<WeightedVertex, PackedWeightedVertex>(container, cache, m_Info, mesh,
+																							 geometry.weightedVertices, logger);
+	if (!vertexResult) return false;
+
+	// Cones of the fetched meshlets come from the same ranges of their own section
+	const bool hasCones = section_element_count(container, SectionID::MESHLET_CONES, sizeof(MeshletCone)) != 0;
+	const auto appendMeshlets = [&](uint64_t first, size_t count)
 	{
-		CXMF_LOG(logger, "Invalid model magic!");
-		return nullptr;
-	}
+		if (!check_section_range(container, SectionID::MESHLETS, first, count, sizeof(Meshlet), logger) ||
+			(hasCones && !check_section_range(container, SectionID::MESHLET_CONES, first, count, sizeof(MeshletCone), logger)))
+		{
+			return false;
+		}
 
-	if (header.baseSize == 0 ||		   //
-		header.compressedSize == 0 ||  //
-		static_cast<size_t>(header.compressedSize) > (dataSize - (sizeof(HEADER) + 1)))
+		const size_t begin = geometry.meshlets.size();
+		geometry.meshlets.resize(begin + count);
+		if (!read_section_range(container, cache, SectionID::MESHLETS, first * sizeof(Meshlet), count * sizeof(Meshlet),
+								geometry.meshlets.data() + begin, logger))
+		{
+			return false;
+		}
+
+		if (!hasCones) return true;
+
+		geometry.meshletCones.resize(begin + count);
+		return read_section_range(container, cache, SectionID::MESHLET_CONES, first * sizeof(MeshletCone), count * sizeof(MeshletCone),
+								  geometry.meshletCones.data() + begin, logger);
+	};
+
+	// The full-detail meshlets come first, the levels may be anywhere in the section, so each range is fetched on its own
+	geometry.meshlets.clear();
+	geometry.meshletCones.clear();
+	if (!appendMeshlets(mesh.meshletOffset, mesh.meshletCount)) return false;
+
+	geometry.lods.assign(m_Info.meshLods.begin() + mesh.lodOffset, m_Info.meshLods.begin() + mesh.lodOffset + mesh.lodCount);
+	for (MeshLod& lod : geometry.lods)
 	{
-		CXMF_LOG(logger, "Invalid model size!");
-		return nullptr;
+		const size_t first = geometry.meshlets.size();
+		if (!appendMeshlets(lod.meshletOffset, lod.meshletCount)) return false;
+
+		lod.meshletOffset = static_cast<uint32_t>(first);
 	}
 
-	uint32_t major, minor, patch;
-	DecodeVersion(header.version, major, minor, patch);
-	if (major != CXMF_VERSION_MAJOR || minor != CXMF_VERSION_MINOR)
+	// Coarser meshlets of the cluster hierarchy are fetched as one span, the hierarchy is rebased to the returned arrays
+	geometry.clusters.assign(m_Info.clusters.begin() + mesh.clusterOffset,
+							 m_Info.clusters.begin() + mesh.clusterOffset + mesh.clusterCount);
+	geometry.clusterGroups.assign(m_Info.clusterGroups.begin() + mesh.clusterGroupOffset,
+								  m_Info.clusterGroups.begin() + mesh.clusterGroupOffset + mesh.clusterGroupCount);
+
+	const auto isDetailMeshlet = [&](uint32_t meshletIndex)
+	{ return meshletIndex >= mesh.meshletOffset && meshletIndex - mesh.meshletOffset < mesh.meshletCount; };
+
+	uint32_t clustersBegin = std::numeric_limits<uint32_t>::max(), clustersEnd = 0;
+	for (const Cluster& cluster : geometry.clusters)
 	{
-		CXMF_LOG(logger, "Incorrect model version {}.{}.{} | Supported: {}.{}.X",  //
-				 major, minor, patch, CXMF_VERSION_MAJOR, CXMF_VERSION_MINOR);
-		return nullptr;
+		if (isDetailMeshlet(cluster.meshletIndex)) continue;
+
+		clustersBegin = std::min(clustersBegin, cluster.meshletIndex);
+		clustersEnd = std::max(clustersEnd, cluster.meshletIndex + 1);
 	}
 
-	const ModelType modelTyp = static_cast<ModelType>(*pointer);
-	pointer += 1;
+	const size_t clustersFirst = geometry.meshlets.size();
+	if (clustersBegin < clustersEnd && !appendMeshlets(clustersBegin, clustersEnd - clustersBegin))	 //
+		return false;
 
-	switch (modelTyp)
+	for (Cluster& cluster : geometry.clusters)
 	{
-		case ModelType::STATIC:
-		case ModelType::SKINNED:
-			break;
-		default:
-		{
-			CXMF_LOG(logger, "Invalid model type!");
-			return nullptr;
-		}
+		cluster.meshletIndex = isDetailMeshlet(cluster.meshletIndex)
+								   ? cluster.meshletIndex - mesh.meshletOffset
+								   : static_cast<uint32_t>(clustersFirst) + (cluster.meshletIndex - clustersBegin);
+		if (cluster.group != INVALID_INDEX) cluster.group -= mesh.clusterGroupOffset;
+		if (cluster.parentGroup != INVALID_INDEX) cluster.parentGroup -= mesh.clusterGroupOffset;
 	}
 
-	z_stream zlibStream;
-	std::memset(&zlibStream, 0, sizeof(z_stream));
-	int err = inflateInit(&zlibStream);
-	if (err != Z_OK)
+	// Meshlet offsets are relative to the ranges of the mesh, so only the covered part of each range is fetched
+	uint64_t verticesEnd = 0, trianglesEnd = 0;
+	for (const Meshlet& meshlet : geometry.meshlets)
 	{
-		CXMF_LOG(logger, "ERROR: inflateInit ({})", err);
-		return nullptr;
+		verticesEnd = std::max<uint64_t>(verticesEnd, static_cast<uint64_t>(meshlet.vertexOffset) + meshlet.vertexCount);
+		trianglesEnd = std::max<uint64_t>(trianglesEnd, meshlet.triangleOffset + static_cast<uint64_t>(meshlet.triangleCount) * 3);
 	}
 
-	std::string modelContent(header.baseSize, '\0');
-
-	zlibStream.next_in = reinterpret_cast<Bytef*>(const_cast<uint8_t*>(pointer));
-	zlibStream.avail_in = header.compressedSize;
-	zlibStream.next_out = reinterpret_cast<Bytef*>(modelContent.data());
-	zlibStream.avail_out = header.baseSize;
-
-	do
+	if (!check_section_range(container, SectionID::MESHLET_VERTICES, mesh.meshletVertexOffset, verticesEnd, sizeof(uint32_t), logger) ||
+		!check_section_range(container, SectionID::MESHLET_TRIANGLES, mesh.meshletTriangleOffset, trianglesEnd, sizeof(uint8_t), logger))
 	{
-		err = inflate(&zlibStream, Z_NO_FLUSH);
-	} while (err == Z_OK);
-
-	inflateEnd(&zlibStream);
+		return false;
+	}
 
-	if (err != Z_STREAM_END)
+	geometry.meshletVertices.resize(static_cast<size_t>(verticesEnd));
+	geometry.meshletTriangles.resize(static_cast<size_t>(trianglesEnd));
+	if (!read_section_range(container, cache, SectionID::MESHLET_VERTICES, mesh.meshletVertexOffset * sizeof(uint32_t),
+							geometry.meshletVertices.size() * sizeof(uint32_t), geometry.meshletVertices.data(), logger) ||
+		!read_section_range(container, cache, SectionID::MESHLET_TRIANGLES, mesh.meshletTriangleOffset, geometry.meshletTriangles.size(),
+							geometry.meshletTriangles.data(), logger))
 	{
-		CXMF_LOG(logger, "ERROR: inflate ({})", err);
-		return nullptr;
+		return false;
 	}
 
-	std::stringstream modelStream(std::move(modelContent));
-
-	Model* outModel = nullptr;
-	if (modelTyp == ModelType::STATIC)
+	for (const uint32_t vertex : geometry.meshletVertices)
 	{
-		StaticModel* const model = new StaticModel();
-		modelStream >> *model;
-		outModel = model;
+		if (vertex >= mesh.vertexCount)
+		{
+			CXMF_LOG(logger, "Meshlets of mesh {} reference vertices of other meshes!", meshIndex);
+			return false;
+		}
 	}
-	else if (modelTyp == ModelType::SKINNED)
+
+	geometry.indexBatches.assign(m_Info.indexBatches.begin() + mesh.indexBatchOffset,
+								 m_Info.indexBatches.begin() + mesh.indexBatchOffset + mesh.indexBatchCount);
+	geometry.indices.clear();
+	geometry.indices16.clear();
+	if (m_Info.indexCount16 != 0)
 	{
-		SkinnedModel* const model = new SkinnedModel();
-		modelStream >> *model;
-		outModel = model;
+		return read_mesh_indices(container, cache, SectionID::INDICES16, mesh, meshIndex, geometry.indexBatches,
+								 geometry.indices16, logger);
 	}
+	return read_mesh_indices(container, cache, SectionID::INDICES, mesh, meshIndex, geometry.indexBatches, geometry.indices,
+							 logger);
+}
 
-	if (outModel)
+bool ModelStream::LoadMeshes(std::span<const uint32_t> meshIndices, std::vector<MeshGeometry>& geometries, Logger* logger)
+{
+	geometries.resize(meshIndices.size());
+	for (size_t i = 0; i < meshIndices.size(); ++i)
 	{
-		outModel->flags = header.flags;
-		outModel->version = header.version;
+		if (!LoadMesh(meshIndices[i], geometries[i], logger))  //
+			return false;
 	}
-	return outModel;
+	return true;
 }
 
 
 
-class DefaultOutputStream final : public OutputStream
+bool SaveToFile(const Model& model, const char* directoryPath, CompressionLevel level, Logger* logger)
 {
-private:
-	std::ostream& m_Stream;
-
-public:
-	explicit DefaultOutputStream(std::ostream& stream)
-		: m_Stream(stream)
-	{}
-
-	~DefaultOutputStream() override = default;
-
-	bool write(const void* data, size_t sizeBytes) override
-	{
-		m_Stream.write(static_cast<const char*>(data), sizeBytes);
-		return m_Stream.good();
-	}
-};
+	SaveOptions options;
+	options.level = level;
+	return SaveToFile(model, directoryPath, options, logger);
+}
 
-bool SaveToFile(const Model& model, const char* directoryPath, CompressionLevel level, Logger* logger)
+// Create 'model.name'.cxmf in the directory
+static bool open_model_file(const Model& model, const char* directoryPath, std::ofstream& file, Logger* logger)
 {
 	std::filesystem::path pathToFile;
 	if (!directoryPath || directoryPath[0] == '\0')
@@ -1811,57 +5813,232 @@ bool SaveToFile(const Model& model, const char* directoryPath, CompressionLevel
 	else
 		pathToFile /= (model.name + ".cxmf");
 
-	std::ofstream file(pathToFile, std::ios::binary | std::ios::trunc);
+	file.open(pathToFile, std::ios::binary | std::ios::trunc);
 	if (!file.is_open())
 	{
 		CXMF_LOG(logger, "Can't open '{}'", pathToFile.string());
 		return false;
 	}
+	return true;
+}
+
+bool SaveToFile(const Model& model, const char* directoryPath, const SaveOptions& options, Logger* logger)
+{
+	std::ofstream file;
+	if (!open_model_file(model, directoryPath, file, logger))  //
+		return false;
 
 	DefaultOutputStream stream(file);
-	return SaveToStream(model, stream, level, logger);
+	return SaveToStream(model, stream, options, logger);
 }
 
-bool SaveToStream(const Model& model, OutputStream& stream, CompressionLevel level, Logger* logger)
+// Compress the buffer into a single zlib stream, return zlib result code
+static int deflate_block(const uint8_t* src, size_t srcSize, int compLevel, std::vector<uint8_t>& out)
+{
+	uLongf outSize = compressBound(static_cast<uLong>(srcSize));
+	out.resize(outSize);
+
+	const int err = compress2(out.data(), &outSize, src, static_cast<uLong>(srcSize), compLevel);
+	out.resize(outSize);
+	return err;
+}
+
+// Triangle lists of 16 or 32-bit indices, empty if they are not triangle lists
+template <typename _IndexTy>
+static void encode_index_buffer(const _IndexTy* indices, size_t count, std::vector<uint8_t>& out)
+{
+	if (count % 3 != 0) return out.clear();
+
+	out.resize(meshopt_encodeIndexBufferBound(count, static_cast<size_t>(*std::max_element(indices, indices + count)) + 1));
+	out.resize(meshopt_encodeIndexBuffer(out.data(), out.size(), indices, count));
+}
+
+// Encode vertices, 16 or 32-bit indices with meshoptimizer codec, return false if encoding failed
+static bool encode_geometry(SectionID id, const void* data, size_t size, size_t elementSize, CODEC_HEADER& codec,
+							std::vector<uint8_t>& out)
 {
-	int compLevel;
-	switch (level)
+	std::memset(&codec, 0, sizeof(CODEC_HEADER));
+	codec.elementSize = static_cast<uint32_t>(elementSize);
+
+	const size_t count = size / elementSize;
+	if (id == SectionID::INDICES)
 	{
-		case CompressionLevel::NONE:
-		{
-			compLevel = Z_NO_COMPRESSION;
-			break;
-		}
-		case CompressionLevel::SPEED:
+		codec.codec = SectionCodec::INDEX_BUFFER;
+		encode_index_buffer(static_cast<const uint32_t*>(data), count, out);
+	}
+	else if (id == SectionID::INDICES16)
+	{
+		codec.codec = SectionCodec::INDEX_BUFFER;
+		encode_index_buffer(static_cast<const uint16_t*>(data), count, out);
+	}
+	else if (id != SectionID::MESHLET_VERTICES)
+	{
+		// Version 1 of the vertex codec compresses noticeably better under deflate than the default version 0
+		codec.codec = SectionCodec::VERTEX_BUFFER;
+		out.resize(meshopt_encodeVertexBufferBound(count, elementSize));
+		out.resize(meshopt_encodeVertexBufferLevel(out.data(), out.size(), data, count, elementSize, 2, 1));
+	}
+	else
+	{
+		const uint32_t* const indices = static_cast<const uint32_t*>(data);
+		codec.codec = SectionCodec::INDEX_SEQUENCE;
+		out.resize(meshopt_encodeIndexSequenceBound(count, static_cast<size_t>(*std::max_element(indices, indices + count)) + 1));
+		out.resize(meshopt_encodeIndexSequence(out.data(), out.size(), indices, count));
+	}
+
+	codec.encodedSize = out.size();
+	return !out.empty();
+}
+
+// Saving is split in stages: section sources with packed vertices, geometry codecs, then compression and output
+// of each section. 'SaveToStream' runs them at once, 'SaveAsync' suspends between them.
+class ModelWriter
+{
+private:
+	struct SectionSource
+	{
+		SectionID id;
+		const void* data;
+		size_t size;
+		size_t elementSize;	 // Vertex or index size for geometry codecs, 0 if the section has no codec
+	};
+
+	static constexpr uint32_t SECTION_COUNT = static_cast<uint32_t>(SectionID::INDICES16) + 1;
+
+private:
+	const Model& m_Model;
+	const SaveOptions m_Options;
+
+	StringTableWriter m_Strings;
+	MODEL_RECORD m_ModelRecord;
+	std::vector<TextureRecord> m_Textures;
+	std::vector<SamplerRecord> m_Samplers;
+	std::vector<MaterialRecord> m_Materials;
+	std::vector<MeshRecord> m_Meshes;
+	std::vector<MeshHierarchyRecord> m_MeshNodes;
+	std::vector<BoneRecord> m_Bones;
+	std::vector<PackedVertex> m_PackedVertices;
+	std::vector<PackedWeightedVertex> m_PackedWeightedVertices;
+	std::vector<QuantizationError> m_QuantizationErrors;
+	std::vector<uint8_t> m_VertexStreams[VERTEX_STREAM_COUNT];
+
+	SectionSource m_Sources[SECTION_COUNT];
+	SECTION m_Sections[SECTION_COUNT];
+	CODEC_HEADER m_Codecs[SECTION_COUNT];
+	std::vector<uint8_t> m_Encoded[SECTION_COUNT];
+
+	int m_CompLevel;
+	uint64_t m_Written;	 // Bytes written to the stream
+
+public:
+	ModelWriter(const Model& model, const SaveOptions& options)
+		: m_Model(model),
+		  m_Options(options),
+		  m_CompLevel(Z_DEFAULT_COMPRESSION),
+		  m_Written(0)
+	{
+		switch (options.level)
 		{
-			compLevel = Z_BEST_SPEED;
-			break;
+			case CompressionLevel::NONE:
+			{
+				m_CompLevel = Z_NO_COMPRESSION;
+				break;
+			}
+			case CompressionLevel::SPEED:
+			{
+				m_CompLevel = Z_BEST_SPEED;
+				break;
+			}
+			case CompressionLevel::MIN_SIZE:
+			{
+				m_CompLevel = Z_BEST_COMPRESSION;
+				break;
+			}
+			default:
+			{
+				m_CompLevel = Z_DEFAULT_COMPRESSION;
+				break;
+			}
 		}
-		case CompressionLevel::MIN_SIZE:
+	}
+
+	ModelWriter(const ModelWriter&) = delete;
+	ModelWriter& operator=(const ModelWriter&) = delete;
+
+	bool prepare(Logger* logger)
+	{
+		bool isPacked;
+		switch (m_Options.vertexFormat)
 		{
-			compLevel = Z_BEST_COMPRESSION;
-			break;
+			case VertexFormat::FLOAT:
+			case VertexFormat::PACKED:
+			{
+				isPacked = m_Options.vertexFormat == VertexFormat::PACKED;
+				break;
+			}
+			default:
+			{
+				CXMF_LOG(logger, "Invalid vertex format!");
+				return false;
+			}
 		}
-		default:
+
+		if (m_Options.vertexLayout != VertexLayout::INTERLEAVED && m_Options.vertexLayout != VertexLayout::STREAMS)
 		{
-			compLevel = Z_DEFAULT_COMPRESSION;
-			break;
+			CXMF_LOG(logger, "Invalid vertex layout!");
+			return false;
 		}
-	}
 
-	std::string modelContent;
-	{
-		std::stringstream modelStream;
-		switch (model.GetType())
+		const void* vertices = nullptr;
+		size_t verticesSize = 0;
+		size_t vertexSize = 0;
+		switch (m_Model.GetType())
 		{
 			case ModelType::STATIC:
 			{
-				modelStream << static_cast<const StaticModel&>(model);
+				const StaticModel& staticModel = static_cast<const StaticModel&>(m_Model);
+				if (isPacked)
+				{
+					quantize_vertices(staticModel.vertices, m_Model, m_PackedVertices, m_QuantizationErrors);
+					vertices = m_PackedVertices.data();
+					vertexSize = sizeof(PackedVertex);
+				}
+				else
+				{
+					vertices = staticModel.vertices.data();
+					vertexSize = sizeof(Vertex);
+				}
+				verticesSize = staticModel.vertices.size() * vertexSize;
 				break;
 			}
 			case ModelType::SKINNED:
 			{
-				modelStream << static_cast<const SkinnedModel&>(model);
+				const SkinnedModel& skinnedModel = static_cast<const SkinnedModel&>(m_Model);
+				if (isPacked)
+				{
+					for (const WeightedVertex& vertex : skinnedModel.vertices)
+					{
+						for (const uint32_t boneID : vertex.boneID)
+						{
+							if (boneID != INVALID_INDEX && boneID >= INVALID_INDEX16)
+							{
+								CXMF_LOG(logger, "Too many bones for 'VertexFormat::PACKED'!");
+								return false;
+							}
+						}
+					}
+
+					quantize_vertices(skinnedModel.vertices, m_Model, m_PackedWeightedVertices, m_QuantizationErrors);
+					vertices = m_PackedWeightedVertices.data();
+					vertexSize = sizeof(PackedWeightedVertex);
+				}
+				else
+				{
+					vertices = skinnedModel.vertices.data();
+					vertexSize = sizeof(WeightedVertex);
+				}
+				verticesSize = skinnedModel.vertices.size() * vertexSize;
+				m_Bones = pack_records(skinnedModel.bones, m_Strings);
 				break;
 			}
 			default:
@@ -1870,97 +6047,424 @@ bool SaveToStream(const Model& model, OutputStream& stream, CompressionLevel lev
 				return false;
 			}
 		}
-		modelContent = modelStream.str();
+
+		// Every field of the vertex goes to exactly one stream
+		VertexStreamFields streamFields[VERTEX_STREAM_COUNT] = {};
+		if (m_Options.vertexLayout == VertexLayout::STREAMS)
+		{
+			const size_t vertexCount = verticesSize / vertexSize;
+			for (uint32_t i = 0; i < VERTEX_STREAM_COUNT; ++i)
+			{
+				streamFields[i] = vertex_stream_fields(m_Model.GetType(), m_Options.vertexFormat, static_cast<VertexStream>(i));
+				m_VertexStreams[i].resize(vertexCount * streamFields[i].stride());
+				split_vertex_stream(static_cast<const uint8_t*>(vertices), vertexSize, vertexCount, streamFields[i],
+									m_VertexStreams[i].data());
+			}
+			verticesSize = 0;
+		}
+
+		m_ModelRecord.name = m_Strings.add(m_Model.name);
+		m_ModelRecord.copyright = m_Strings.add(m_Model.copyright);
+		m_ModelRecord.generator = m_Strings.add(m_Model.generator);
+		m_ModelRecord.bounds = m_Model.bounds;
+
+		if (!m_Model.indices.empty() && !m_Model.indices16.empty())
+		{
+			CXMF_LOG(logger, "Model has both 32-bit and 16-bit indices!");
+			return false;
+		}
+
+		m_Textures = pack_records(m_Model.textures, m_Strings);
+		m_Samplers = pack_records(m_Model.samplers, m_Strings);
+		m_Materials = pack_records(m_Model.materials, m_Strings);
+		m_Meshes = pack_records(m_Model.meshes, m_Strings);
+		m_MeshNodes = pack_records(m_Model.meshNodes, m_Strings);
+
+		if (m_Strings.length() >= static_cast<size_t>(std::numeric_limits<uint32_t>::max()))
+		{
+			CXMF_LOG(logger, "Model size is too large!");
+			return false;
+		}
+
+		const std::string& strings = m_Strings.content();
+		const SectionSource sources[] = {
+			{SectionID::MODEL, &m_ModelRecord, sizeof(m_ModelRecord), 0},
+			{SectionID::STRINGS, strings.data(), strings.length(), 0},
+			{SectionID::TEXTURES, m_Textures.data(), m_Textures.size() * sizeof(TextureRecord), 0},
+			{SectionID::SAMPLERS, m_Samplers.data(), m_Samplers.size() * sizeof(SamplerRecord), 0},
+			{SectionID::MATERIALS, m_Materials.data(), m_Materials.size() * sizeof(MaterialRecord), 0},
+			{SectionID::MESHES, m_Meshes.data(), m_Meshes.size() * sizeof(MeshRecord), 0},
+			{SectionID::MESH_NODES, m_MeshNodes.data(), m_MeshNodes.size() * sizeof(MeshHierarchyRecord), 0},
+			{SectionID::BONES, m_Bones.data(), m_Bones.size() * sizeof(BoneRecord), 0},
+			{SectionID::VERTICES, vertices, verticesSize, vertexSize},
+			{SectionID::MESHLETS, m_Model.meshlets.data(), m_Model.meshlets.size() * sizeof(Meshlet), 0},
+			{SectionID::MESHLET_VERTICES, m_Model.meshletVertices.data(), m_Model.meshletVertices.size() * sizeof(uint32_t),
+			 sizeof(uint32_t)},
+			{SectionID::MESHLET_TRIANGLES, m_Model.meshletTriangles.data(), m_Model.meshletTriangles.size() * sizeof(uint8_t), 0},
+			{SectionID::MESH_QUANTIZATION, m_QuantizationErrors.data(), m_QuantizationErrors.size() * sizeof(QuantizationError), 0},
+			{SectionID::VERTEX_POSITIONS, m_VertexStreams[0].data(), m_VertexStreams[0].size(), streamFields[0].stride()},
+			{SectionID::VERTEX_NORMALS_TANGENTS, m_VertexStreams[1].data(), m_VertexStreams[1].size(), streamFields[1].stride()},
+			{SectionID::VERTEX_UVS, m_VertexStreams[2].data(), m_VertexStreams[2].size(), streamFields[2].stride()},
+			{SectionID::VERTEX_BONE_WEIGHTS, m_VertexStreams[3].data(), m_VertexStreams[3].size(), streamFields[3].stride()},
+			{SectionID::MESH_LODS, m_Model.meshLods.data(), m_Model.meshLods.size() * sizeof(MeshLod), 0},
+			{SectionID::CLUSTERS, m_Model.clusters.data(), m_Model.clusters.size() * sizeof(Cluster), 0},
+			{SectionID::CLUSTER_GROUPS, m_Model.clusterGroups.data(), m_Model.clusterGroups.size() * sizeof(ClusterGroup), 0},
+			{SectionID::MESHLET_CONES, m_Model.meshletCones.data(), m_Model.meshletCones.size() * sizeof(MeshletCone), 0},
+			{SectionID::MESHLET_SETS, m_Model.meshletSets.data(), m_Model.meshletSets.size() * sizeof(MeshletLimits), 0},
+			{SectionID::MESHLET_SET_RANGES, m_Model.meshletSetRanges.data(),
+			 m_Model.meshletSetRanges.size() * sizeof(MeshletRanges), 0},
+			{SectionID::INDEX_BATCHES, m_Model.indexBatches.data(), m_Model.indexBatches.size() * sizeof(IndexBatch), 0},
+			{SectionID::INDICES, m_Model.indices.data(), m_Model.indices.size() * sizeof(uint32_t), sizeof(uint32_t)},
+			{SectionID::MESH_STATISTICS, m_Model.meshStatistics.data(), m_Model.meshStatistics.size() * sizeof(MeshStatistics), 0},
+			{SectionID::INDICES16, m_Model.indices16.data(), m_Model.indices16.size() * sizeof(uint16_t), sizeof(uint16_t)},
+		};
+		static_assert(std::size(sources) == SECTION_COUNT);
+		std::copy(std::begin(sources), std::end(sources), m_Sources);
+		return true;
+	}
+
+	// Geometry is passed through meshoptimizer codecs first, then the codec stream is stored instead of the section
+	bool encode(Logger* logger)
+	{
+		for (uint32_t i = 0; i < SECTION_COUNT; ++i)
+		{
+			const SectionSource& source = m_Sources[i];
+			SECTION& section = m_Sections[i];
+			section.id = source.id;
+			section.offset = 0;
+			section.size = 0;
+			section.baseSize = source.size;
+
+			if (!m_Options.encodeGeometry || source.elementSize == 0 || source.size == 0)
+			{
+				section.encoding = storedEncoding(source.size);
+				continue;
+			}
+
+			if (!encode_geometry(source.id, source.data, source.size, source.elementSize, m_Codecs[i], m_Encoded[i]))
+			{
+				CXMF_LOG(logger, "ERROR: meshopt encode of model section {}", static_cast<uint32_t>(source.id));
+				return false;
+			}
+			section.encoding = SectionEncoding::MESHOPT;
+			m_Codecs[i].encoding = storedEncoding(m_Encoded[i].size());
+		}
+		return true;
 	}
 
-	if (modelContent.length() >= static_cast<size_t>(std::numeric_limits<uint32_t>::max()))
+	// Content is written section by section, sections bigger than a block are split in independent blocks
+	// and compressed in parallel windows, so at most one window of compressed blocks is kept in memory
+	bool writeHeader(OutputStream& stream)
 	{
-		CXMF_LOG(logger, "Model size is too large!");
-		return false;
+		HEADER header;
+		std::memset(&header, 0, sizeof(header));
+		header.magic = MAGIC;
+		header.version = GetVersion();
+		header.flags = m_Model.flags;
+		header.sectionCount = SECTION_COUNT;
+		header.modelType = static_cast<uint8_t>(m_Model.GetType());
+		header.vertexFormat = static_cast<uint8_t>(m_Options.vertexFormat);
+		header.vertexLayout = static_cast<uint8_t>(m_Options.vertexLayout);
+
+		// Leading table gives sequential readers the order and encodings, placement is only in the trailing one
+		m_Written = 0;
+		return put(stream, &header, sizeof(HEADER)) && put(stream, m_Sections, sizeof(m_Sections));
 	}
 
-	z_stream zlibStream;
-	std::memset(&zlibStream, 0, sizeof(z_stream));
-	int err = deflateInit(&zlibStream, compLevel);
-	if (err != Z_OK)
+	bool writeSection(uint32_t index, OutputStream& stream, Logger* logger)
 	{
-		CXMF_LOG(logger, "ERROR: deflateInit ({})", err);
-		return false;
+		SECTION& section = m_Sections[index];
+		if (!pad(stream)) return false;
+		section.offset = m_Written;
+
+		const bool isEncoded = section.encoding == SectionEncoding::MESHOPT;
+		const uint8_t* const data = isEncoded ? m_Encoded[index].data() : static_cast<const uint8_t*>(m_Sources[index].data);
+		const size_t size = isEncoded ? m_Encoded[index].size() : m_Sources[index].size;
+
+		if (isEncoded && !put(stream, &m_Codecs[index], sizeof(CODEC_HEADER))) return false;
+
+		const SectionEncoding encoding = isEncoded ? m_Codecs[index].encoding : section.encoding;
+		const bool result = encoding == SectionEncoding::RAW
+								? put(stream, data, size)
+								: writeDeflate(stream, data, size, encoding == SectionEncoding::DEFLATE_BLOCKS, logger);
+		if (!result) return false;
+
+		// Codec stream is not needed after it is written
+		std::vector<uint8_t>().swap(m_Encoded[index]);
+
+		section.size = m_Written - section.offset;
+		return true;
 	}
 
-	const uint32_t sourceSize = static_cast<uint32_t>(modelContent.length());
-	const uint32_t compressBoundSize = static_cast<uint32_t>(compressBound(sourceSize));
+	bool writeTable(OutputStream& stream)
+	{
+		return pad(stream) && put(stream, m_Sections, sizeof(m_Sections));
+	}
 
-	void* const tempContent = malloc(compressBoundSize);
-	if (!tempContent)
+	static constexpr uint32_t sectionCount()
 	{
-		deflateEnd(&zlibStream);
-		return false;
+		return SECTION_COUNT;
 	}
 
-	zlibStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(modelContent.c_str()));
-	zlibStream.avail_in = sourceSize;
-	zlibStream.next_out = static_cast<Bytef*>(tempContent);
-	zlibStream.avail_out = compressBoundSize;
+private:
+	bool put(OutputStream& stream, const void* data, size_t size)
+	{
+		if (size > 0 && !stream.write(data, size)) return false;
+
+		m_Written += size;
+		return true;
+	}
 
-	do
+	SectionEncoding storedEncoding(size_t size) const
 	{
-		err = deflate(&zlibStream, Z_FINISH);
-	} while (err == Z_OK);
+		if (m_Options.level == CompressionLevel::NONE || size == 0) return SectionEncoding::RAW;
+		return size > DEFLATE_BLOCK_SIZE ? SectionEncoding::DEFLATE_BLOCKS : SectionEncoding::DEFLATE;
+	}
 
-	deflateEnd(&zlibStream);
+	bool pad(OutputStream& stream)
+	{
+		static constexpr uint8_t padding[SECTION_ALIGNMENT] = {};
+		return put(stream, padding, static_cast<size_t>(aligned_offset(m_Written, SECTION_ALIGNMENT) - m_Written));
+	}
 
-	if (err != Z_STREAM_END)
+	bool writeDeflate(OutputStream& stream, const uint8_t* data, size_t size, bool isBlocks, Logger* logger)
 	{
-		free(tempContent);
-		CXMF_LOG(logger, "ERROR: deflate ({})", err);
+		const size_t blockCount = (size + DEFLATE_BLOCK_SIZE - 1) / DEFLATE_BLOCK_SIZE;
+		if (blockCount > std::numeric_limits<uint32_t>::max())
+		{
+			CXMF_LOG(logger, "Model size is too large!");
+			return false;
+		}
+
+		if (isBlocks)
+		{
+			BLOCK_TABLE table;
+			table.blockSize = DEFLATE_BLOCK_SIZE;
+			table.blockCount = static_cast<uint32_t>(blockCount);
+			if (!put(stream, &table, sizeof(BLOCK_TABLE))) return false;
+		}
+
+		const size_t windowSize = std::min<size_t>(blockCount, resolve_thread_count(m_Options.threadCount));
+		std::vector<std::vector<uint8_t>> outputs(windowSize);
+		std::vector<int> errors(windowSize);
+		std::vector<uint32_t> blockSizes;
+		blockSizes.reserve(isBlocks ? blockCount : 0);
+		for (size_t firstBlock = 0; firstBlock < blockCount; firstBlock += windowSize)
+		{
+			const size_t count = std::min(windowSize, blockCount - firstBlock);
+			parallel_for(count, m_Options.threadCount,
+						 [&](size_t i)
+						 {
+							 const size_t offset = (firstBlock + i) * DEFLATE_BLOCK_SIZE;
+							 errors[i] = deflate_block(data + offset, std::min<size_t>(DEFLATE_BLOCK_SIZE, size - offset), m_CompLevel,
+													   outputs[i]);
+						 });
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (errors[i] != Z_OK)
+				{
+					CXMF_LOG(logger, "ERROR: deflate ({})", errors[i]);
+					return false;
+				}
+
+				if (!put(stream, outputs[i].data(), outputs[i].size())) return false;
+				if (isBlocks) blockSizes.push_back(static_cast<uint32_t>(outputs[i].size()));
+			}
+		}
+		return put(stream, blockSizes.data(), blockSizes.size() * sizeof(uint32_t));
+	}
+};
+
+bool SaveToStream(const Model& model, OutputStream& stream, CompressionLevel level, Logger* logger)
+{
+	SaveOptions options;
+	options.level = level;
+	return SaveToStream(model, stream, options, logger);
+}
+
+bool SaveToStream(const Model& model, OutputStream& stream, const SaveOptions& options, Logger* logger)
+{
+	ModelWriter writer(model, options);
+	if (!writer.prepare(logger) || !writer.encode(logger) || !writer.writeHeader(stream))  //
 		return false;
+
+	for (uint32_t i = 0; i < ModelWriter::sectionCount(); ++i)
+	{
+		if (!writer.writeSection(i, stream, logger))  //
+			return false;
 	}
+	return writer.writeTable(stream);
+}
 
-	const uint32_t compressedSize = static_cast<uint32_t>(zlibStream.total_out);
-	const uint8_t modelTyp = static_cast<uint8_t>(model.GetType());
-	HEADER header;
-	header.magic = MAGIC;
-	header.version = model.version;
-	header.compressedSize = compressedSize;
-	header.baseSize = sourceSize;
-	header.flags = model.flags;
 
-	const bool writeHeaderResult = stream.write(&header, sizeof(HEADER));
-	if (!writeHeaderResult)
+
+// Suspend the coroutine and continue it as a new job of the executor
+struct ScheduleAwaiter
+{
+	Executor& executor;
+
+	bool await_ready() const noexcept
 	{
-		free(tempContent);
 		return false;
 	}
 
-	const bool writeTypeResult = stream.write(&modelTyp, 1);
-	if (!writeTypeResult)
+	void await_suspend(std::coroutine_handle<> handle) const
 	{
-		free(tempContent);
-		return false;
+		executor.post(handle);
+	}
+
+	void await_resume() const noexcept {}
+};
+
+static ScheduleAwaiter schedule(Executor& executor)
+{
+	return ScheduleAwaiter{executor};
+}
+
+// The task starts on the executor after the call returns, so the options referencing caller memory
+// are rebound to the copies kept in the coroutine frame
+static Task<Model*> loadFileAsync(std::string filePath, Executor& executor, LoadOptions options, std::string cacheDirectory,
+								  std::vector<MeshletLimits> meshletSets, Logger* logger)
+{
+	if (options.importCacheDirectory) options.importCacheDirectory = cacheDirectory.c_str();
+	options.meshletSets = meshletSets;
+	co_await schedule(executor);
+
+	const std::string str = trim_file_path(filePath.c_str());
+	if (str.empty()) co_return nullptr;
+
+	if (str.ends_with(".cxmf"))
+	{
+		MappedFile file;
+		if (!file.open(str.c_str()))
+		{
+			CXMF_LOG(logger, "Can't open '{}'", str.c_str());
+			co_return nullptr;
+		}
+
+		// The file is read by the system while the task waits for the next stage
+		file.prefetch();
+		co_return co_await LoadAsync(file.data(), file.size(), executor, options, logger);
+	}
+#ifdef CXMF_INCLUDE_IMPORTER
+	else if (str.ends_with(".gltf") || str.ends_with(".glb"))
+	{
+		co_return importCachedModel(str, options, logger);
+	}
+#endif
+	else
+	{
+		CXMF_LOG(logger, "Invalid input file extension name '{}'", str.c_str());
+		co_return nullptr;
+	}
+}
+
+Task<Model*> LoadAsync(std::string filePath, Executor& executor, LoadOptions options, Logger* logger)
+{
+	std::string cacheDirectory = options.importCacheDirectory ? options.importCacheDirectory : std::string();
+	std::vector<MeshletLimits> meshletSets(options.meshletSets.begin(), options.meshletSets.end());
+	return loadFileAsync(std::move(filePath), executor, options, std::move(cacheDirectory), std::move(meshletSets), logger);
+}
+
+Task<Model*> LoadAsync(const void* data, size_t dataSize, Executor& executor, LoadOptions options, Logger* logger)
+{
+	co_await schedule(executor);
+
+	uint32_t version;
+	if (!check_model_version(data, dataSize, version, logger))	//
+		co_return nullptr;
+
+	// CXMF 1.0 layout is a single zlib stream, it can't be split in stages
+	if (is_legacy_version(version))	 //
+		co_return loadLegacyModel(data, dataSize, resolve_memory_resource(options.memoryResource), logger);
+
+	Container container;
+	if (!open_container(container, data, dataSize, logger))	 //
+		co_return nullptr;
+
+	container.threadCount = options.threadCount;
+
+	Model* const model = createModel(container, resolve_memory_resource(options.memoryResource), logger);
+	if (!model) co_return nullptr;
+
+	co_await schedule(executor);
+	bool result = readVertexSections(container, *model, logger);
+	if (result)
+	{
+		co_await schedule(executor);
+		result = readMeshletSections(container, *model, logger) && readIndexSection(container, *model, logger) &&
+				 selectMeshletSet(*model, options.meshletLimits, logger);
+	}
+
+	if (!result)
+	{
+		delete model;
+		co_return nullptr;
 	}
+	co_return model;
+}
+
+Task<bool> SaveAsync(const Model& model, std::string directoryPath, Executor& executor, SaveOptions options, Logger* logger)
+{
+	co_await schedule(executor);
+
+	std::ofstream file;
+	if (!open_model_file(model, directoryPath.c_str(), file, logger))  //
+		co_return false;
+
+	DefaultOutputStream stream(file);
+	co_return co_await SaveAsync(model, stream, executor, options, logger);
+}
+
+Task<bool> SaveAsync(const Model& model, OutputStream& stream, Executor& executor, SaveOptions options, Logger* logger)
+{
+	co_await schedule(executor);
+
+	ModelWriter writer(model, options);
+	if (!writer.prepare(logger)) co_return false;
 
-	const bool writeContentResult = stream.write(tempContent, compressedSize);
-	free(tempContent);
-	return writeContentResult;
+	co_await schedule(executor);
+	if (!writer.encode(logger)) co_return false;
+
+	if (!writer.writeHeader(stream)) co_return false;
+
+	for (uint32_t i = 0; i < ModelWriter::sectionCount(); ++i)
+	{
+		co_await schedule(executor);
+		if (!writer.writeSection(i, stream, logger)) co_return false;
+	}
+	co_return writer.writeTable(stream);
 }
 
 
 
 
 
-Model::Model(ModelType type)
+Model::Model(ModelType type, std::pmr::memory_resource* resource)
 	: c_type(type),
-	  name(),
-	  textures(),
-	  samplers(),
-	  materials(),
-	  meshes(),
-	  meshNodes(),
-	  meshlets(),
+	  name(resource),
+	  textures(resource),
+	  samplers(resource),
+	  materials(resource),
+	  meshes(resource),
+	  meshNodes(resource),
+	  meshletVertices(resource),
+	  meshletTriangles(resource),
+	  meshlets(resource),
+	  meshletCones(resource),
+	  meshLods(resource),
+	  clusters(resource),
+	  clusterGroups(resource),
+	  meshletSets(resource),
+	  meshletSetRanges(resource),
+	  indices(resource),
+	  indices16(resource),
+	  indexBatches(resource),
+	  meshStatistics(resource),
 	  bounds(),
-	  copyright(),
-	  generator(),
+	  copyright(resource),
+	  generator(resource),
 	  flags(0),
 	  version(0)
 {
@@ -1998,13 +6502,25 @@ const SkinnedModel* Model::SkinnedModelCast() const
 
 
 StaticModel::StaticModel()
-	: Model(ModelType::STATIC), vertices()
+	: StaticModel(std::pmr::get_default_resource())
+{
+	//
+}
+
+StaticModel::StaticModel(std::pmr::memory_resource* resource)
+	: Model(ModelType::STATIC, resource), vertices(resource)
 {
 	//
 }
 
 SkinnedModel::SkinnedModel()
-	: Model(ModelType::SKINNED), vertices(), bones()
+	: SkinnedModel(std::pmr::get_default_resource())
+{
+	//
+}
+
+SkinnedModel::SkinnedModel(std::pmr::memory_resource* resource)
+	: Model(ModelType::SKINNED, resource), vertices(resource), bones(resource)
 {
 	//
 }
@@ -300,7 +300,7 @@ static void option_changeTexturePath()
 		bool exists = false;
 		for (const cxmf::Texture& tex : currentModel->textures)
 		{
-			if (tex.path == newName)
+			if (tex.path == std::string_view(newName))
 			{
 				exists = true;
 				break;
@@ -312,7 +312,7 @@ static void option_changeTexturePath()
 	const std::string newName = processSelectString("path", pathValidator);
 	if (newName.empty()) return;
 
-	std::string& oldName = currentModel->textures[index].path;
+	std::pmr::string& oldName = currentModel->textures[index].path;
 	cmd::cout << cmd::clr_green << std::format("Changed: \"{}\" >> \"{}\"", oldName, newName);
 	oldName = newName;
 
@@ -329,7 +329,7 @@ static void option_RenameSampler()
 		bool exists = false;
 		for (const cxmf::Sampler& sampler : currentModel->samplers)
 		{
-			if (sampler.name == newName)
+			if (sampler.name == std::string_view(newName))
 			{
 				exists = true;
 				break;
@@ -341,7 +341,7 @@ static void option_RenameSampler()
 	const std::string newName = processSelectString("name", pathValidator);
 	if (newName.empty()) return;
 
-	std::string& oldName = currentModel->samplers[index].name;
+	std::pmr::string& oldName = currentModel->samplers[index].name;
 	cmd::cout << cmd::clr_green << std::format("Changed: \"{}\" >> \"{}\"", oldName, newName);
 	oldName = newName;
 
@@ -358,7 +358,7 @@ static void option_RenameMaterial()
 		bool exists = false;
 		for (const cxmf::Material& mat : currentModel->materials)
 		{
-			if (mat.name == newName)
+			if (mat.name == std::string_view(newName))
 			{
 				exists = true;
 				break;
@@ -370,7 +370,7 @@ static void option_RenameMaterial()
 	const std::string newName = processSelectString("name", pathValidator);
 	if (newName.empty()) return;
 
-	std::string& oldName = currentModel->materials[index].name;
+	std::pmr::string& oldName = currentModel->materials[index].name;
 	cmd::cout << cmd::clr_green << std::format("Changed: \"{}\" >> \"{}\"", oldName, newName);
 	oldName = newName;
 
@@ -387,7 +387,7 @@ static void option_RenameMesh()
 		bool exists = false;
 		for (const cxmf::Mesh& mesh : currentModel->meshes)
 		{
-			if (mesh.name == newName)
+			if (mesh.name == std::string_view(newName))
 			{
 				exists = true;
 				break;
@@ -399,7 +399,7 @@ static void option_RenameMesh()
 	const std::string newName = processSelectString("name", pathValidator);
 	if (newName.empty()) return;
 
-	std::string& oldName = currentModel->meshes[index].name;
+	std::pmr::string& oldName = currentModel->meshes[index].name;
 	cmd::cout << cmd::clr_green << std::format("Changed: \"{}\" >> \"{}\"", oldName, newName);
 	oldName = newName;
 
@@ -416,7 +416,7 @@ static void option_RenameNode()
 		bool exists = false;
 		for (const cxmf::MeshHierarchy& node : currentModel->meshNodes)
 		{
-			if (node.name == newName)
+			if (node.name == std::string_view(newName))
 			{
 				exists = true;
 				break;
@@ -428,7 +428,7 @@ static void option_RenameNode()
 	const std::string newName = processSelectString("name", pathValidator);
 	if (newName.empty()) return;
 
-	std::string& oldName = currentModel->meshNodes[index].name;
+	std::pmr::string& oldName = currentModel->meshNodes[index].name;
 	cmd::cout << cmd::clr_green << std::format("Changed: \"{}\" >> \"{}\"", oldName, newName);
 	oldName = newName;
 
@@ -447,7 +447,7 @@ static void option_RenameBone()
 		bool exists = false;
 		for (const cxmf::Bone& bone : model.bones)
 		{
-			if (bone.name == newName)
+			if (bone.name == std::string_view(newName))
 			{
 				exists = true;
 				break;
@@ -459,7 +459,7 @@ static void option_RenameBone()
 	const std::string newName = processSelectString("name", pathValidator);
 	if (newName.empty()) return;
 
-	std::string& oldName = model.bones[index].name;
+	std::pmr::string& oldName = model.bones[index].name;
 	cmd::cout << cmd::clr_green << std::format("Changed: \"{}\" >> \"{}\"", oldName, newName);
 	oldName = newName;
 
@@ -649,6 +649,20 @@ static void option_showModelMeshes()
 
 		cmd::cout << "\tMeshlets: " << mesh.meshletCount << '\n';
 
+		cmd::cout << "\tLODs: " << mesh.lodCount << '\n';
+
+		cmd::cout << "\tClusters: " << mesh.clusterCount << '\n';
+
+		cmd::cout << "\tIndex batches: " << mesh.indexBatchCount << '\n';
+
+		if (!currentModel->meshStatistics.empty())
+		{
+			const cxmf::MeshStatistics& statistics = currentModel->meshStatistics[i];
+			cmd::cout << "\tACMR: " << statistics.source.acmr << " -> " << statistics.vertexFetch.acmr;
+			cmd::cout << ", Overfetch: " << statistics.source.overfetch << " -> " << statistics.vertexFetch.overfetch;
+			cmd::cout << ", Overdraw: " << statistics.source.overdraw << " -> " << statistics.vertexFetch.overdraw << '\n';
+		}
+
 		cmd::cout << "\tMaterial ID: ";
 		if (mesh.HasMaterial())
 			cmd::cout << mesh.materialIndex << " \"" << currentModel->materials[mesh.materialIndex].name << '\"';
@@ -830,6 +844,13 @@ static void showModelMainMenu()
 	{
 		cmd::cout << "Generator: " << currentModel->generator << cmd::endl;
 	}
+	if (!currentModel->meshletSets.empty())
+	{
+		cmd::cout << "Meshlet sets:";
+		for (const cxmf::MeshletLimits& limits : currentModel->meshletSets)
+			cmd::cout << ' ' << limits.maxVertices << '/' << limits.maxTriangles;
+		cmd::cout << cmd::endl;
+	}
 
 	cmd::cout << cmd::clr_gray;
 
@@ -0,0 +1,453 @@
+#include "CXMF.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+
+
+// Regression tests of the CXMF container, each test returns false on the first failed check
+
+#define CHECK(Condition) \
+if (!(Condition)) \
+{ \
+	std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Condition); \
+	return false; \
+}
+
+// Mirror of the trailing table entries of CXMF 1.1+, see 'SECTION' in CXMF.cpp
+struct SectionEntry
+{
+	uint32_t id;
+	uint32_t encoding;
+	uint64_t offset;
+	uint64_t size;
+	uint64_t baseSize;
+};
+
+constexpr inline uint32_t SECTION_STRINGS = 1;
+constexpr inline uint32_t SECTION_MATERIALS = 4;
+constexpr inline uint32_t SECTION_MESHES = 5;
+constexpr inline uint32_t SECTION_VERTICES = 8;
+constexpr inline uint32_t SECTION_INDICES = 24;
+constexpr inline uint32_t SECTION_INDICES16 = 26;
+constexpr inline uint32_t ENCODING_RAW = 0;
+constexpr inline uint32_t ENCODING_MESHOPT = 3;
+constexpr inline size_t HEADER_SIZE = 24;
+constexpr inline size_t HEADER_SECTION_COUNT_OFFSET = 12;
+constexpr inline size_t CODEC_ELEMENT_SIZE_OFFSET = 8;
+
+class MemoryOutputStream : public cxmf::OutputStream
+{
+public:
+	std::vector<uint8_t> data;
+
+	bool write(const void* src, size_t sizeBytes) override
+	{
+		const uint8_t* const bytes = static_cast<const uint8_t*>(src);
+		data.insert(data.end(), bytes, bytes + sizeBytes);
+		return true;
+	}
+};
+
+class MemoryInputStream : public cxmf::InputStream
+{
+private:
+	const std::vector<uint8_t>& m_Data;
+	size_t m_Offset = 0;
+
+public:
+	explicit MemoryInputStream(const std::vector<uint8_t>& data) : m_Data(data) {}
+
+	size_t read(void* dst, size_t sizeBytes) override
+	{
+		const size_t size = std::min(sizeBytes, m_Data.size() - m_Offset);
+		std::memcpy(dst, m_Data.data() + m_Offset, size);
+		m_Offset += size;
+		return size;
+	}
+};
+
+class SilentLogger : public cxmf::Logger
+{
+public:
+	void write(const char*) override {}
+};
+
+// One mesh of a triangle strip over 'vertexCount' vertices
+static std::unique_ptr<cxmf::StaticModel> make_static_model(uint32_t vertexCount)
+{
+	std::unique_ptr<cxmf::StaticModel> model = std::make_unique<cxmf::StaticModel>();
+	model->name = "test";
+	model->vertices.resize(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		cxmf::Vertex& vertex = model->vertices[i];
+		std::memset(&vertex, 0, sizeof(cxmf::Vertex));
+		vertex.position[0] = static_cast<float>(i / 2);
+		vertex.position[1] = static_cast<float>(i % 2);
+		vertex.normal[2] = 1.0F;
+	}
+
+	cxmf::Mesh& mesh = model->meshes.emplace_back();
+	mesh.name = "mesh";
+	mesh.vertexOffset = 0;
+	mesh.vertexCount = vertexCount;
+	mesh.materialIndex = cxmf::INVALID_INDEX;
+	return model;
+}
+
+static std::vector<uint8_t> save_to_memory(const cxmf::Model& model, const cxmf::SaveOptions& options)
+{
+	MemoryOutputStream stream;
+	if (!cxmf::SaveToStream(model, stream, options)) stream.data.clear();
+	return stream.data;
+}
+
+// Trailing table entry of the section, nullptr if the file has no such section
+static SectionEntry* find_section(std::vector<uint8_t>& file, uint32_t id)
+{
+	uint32_t sectionCount = 0;
+	std::memcpy(&sectionCount, file.data() + HEADER_SECTION_COUNT_OFFSET, sizeof(sectionCount));
+
+	SectionEntry* const table = reinterpret_cast<SectionEntry*>(file.data() + file.size() - sectionCount * sizeof(SectionEntry));
+	for (uint32_t i = 0; i < sectionCount; ++i)
+	{
+		if (table[i].id == id) return &table[i];
+	}
+	return nullptr;
+}
+
+// Leading table entry of the section, read by 'LoadFromStream', nullptr if the file has no such section
+static SectionEntry* find_leading_section(std::vector<uint8_t>& file, uint32_t id)
+{
+	uint32_t sectionCount = 0;
+	std::memcpy(&sectionCount, file.data() + HEADER_SECTION_COUNT_OFFSET, sizeof(sectionCount));
+
+	SectionEntry* const table = reinterpret_cast<SectionEntry*>(file.data() + HEADER_SIZE);
+	for (uint32_t i = 0; i < sectionCount; ++i)
+	{
+		if (table[i].id == id) return &table[i];
+	}
+	return nullptr;
+}
+
+// Every loader must reject the file by return value
+static bool is_rejected(const std::vector<uint8_t>& file)
+{
+	SilentLogger logger;
+	MemoryInputStream stream(file);
+	const std::unique_ptr<cxmf::Model> fromMemory(cxmf::LoadFromMemory(file.data(), file.size(), &logger));
+	const std::unique_ptr<cxmf::Model> fromStream(cxmf::LoadFromStream(stream, &logger));
+	return !fromMemory && !fromStream;
+}
+
+
+
+// Tests
+
+// Vertices come back unchanged from memory and stream with every section encoding,
+// the vertex section spans several decode windows of the stream
+static bool test_round_trip()
+{
+	const std::unique_ptr<cxmf::StaticModel> model = make_static_model(400'000);
+	for (const cxmf::CompressionLevel level : {cxmf::CompressionLevel::NONE, cxmf::CompressionLevel::DEFAULT})
+	{
+		for (const bool encodeGeometry : {false, true})
+		{
+			cxmf::SaveOptions options;
+			options.level = level;
+			options.encodeGeometry = encodeGeometry;
+
+			const std::vector<uint8_t> file = save_to_memory(*model, options);
+			CHECK(!file.empty());
+
+			MemoryInputStream stream(file);
+			const std::unique_ptr<cxmf::Model> fromMemory(cxmf::LoadFromMemory(file.data(), file.size()));
+			const std::unique_ptr<cxmf::Model> fromStream(cxmf::LoadFromStream(stream));
+			for (const cxmf::Model* loaded : {fromMemory.get(), fromStream.get()})
+			{
+				CHECK(loaded && loaded->StaticModelCast() && loaded->meshes.size() == 1 && loaded->meshes[0].name == "mesh");
+
+				const std::pmr::vector<cxmf::Vertex>& vertices = loaded->StaticModelCast()->vertices;
+				CHECK(vertices.size() == model->vertices.size());
+				CHECK(std::memcmp(vertices.data(), model->vertices.data(), vertices.size() * sizeof(cxmf::Vertex)) == 0);
+			}
+		}
+	}
+	return true;
+}
+
+static bool test_codec_zero_element_size()
+{
+	cxmf::SaveOptions options;
+	options.level = cxmf::CompressionLevel::NONE;
+	options.encodeGeometry = true;
+
+	std::vector<uint8_t> file = save_to_memory(*make_static_model(256), options);
+	CHECK(!file.empty());
+
+	const SectionEntry* const vertices = find_section(file, SECTION_VERTICES);
+	CHECK(vertices && vertices->encoding == ENCODING_MESHOPT);
+
+	const uint32_t elementSize = 0;
+	std::memcpy(file.data() + vertices->offset + CODEC_ELEMENT_SIZE_OFFSET, &elementSize, sizeof(elementSize));
+	CHECK(is_rejected(file));
+	return true;
+}
+
+
+// Streamed sections grow with the content, a huge decoded size fails at the end of the stream
+static bool test_stream_corrupt_base_size()
+{
+	for (const cxmf::CompressionLevel level : {cxmf::CompressionLevel::NONE, cxmf::CompressionLevel::DEFAULT})
+	{
+		for (const uint32_t id : {SECTION_STRINGS, SECTION_VERTICES})
+		{
+			cxmf::SaveOptions options;
+			options.level = level;
+
+			std::vector<uint8_t> file = save_to_memory(*make_static_model(256), options);
+			CHECK(!file.empty());
+
+			SectionEntry* const section = find_leading_section(file, id);
+			CHECK(section);
+			section->baseSize = sizeof(cxmf::Vertex) << 34;
+
+			SilentLogger logger;
+			MemoryInputStream stream(file);
+			const std::unique_ptr<cxmf::Model> model(cxmf::LoadFromStream(stream, &logger));
+			CHECK(!model);
+		}
+	}
+	return true;
+}
+// Decoded size of a section in memory is bounded by its stored size before it is allocated
+static bool test_memory_corrupt_base_size()
+{
+	for (const cxmf::CompressionLevel level : {cxmf::CompressionLevel::NONE, cxmf::CompressionLevel::DEFAULT})
+	{
+		for (const bool encodeGeometry : {false, true})
+		{
+			cxmf::SaveOptions options;
+			options.level = level;
+			options.encodeGeometry = encodeGeometry;
+
+			std::vector<uint8_t> file = save_to_memory(*make_static_model(256), options);
+			CHECK(!file.empty());
+
+			SectionEntry* const section = find_section(file, SECTION_VERTICES);
+			CHECK(section);
+			section->baseSize = sizeof(cxmf::Vertex) << 34;
+
+			SilentLogger logger;
+			const std::unique_ptr<cxmf::Model> model(cxmf::LoadFromMemory(file.data(), file.size(), &logger));
+			CHECK(!model);
+		}
+	}
+	return true;
+}
+
+// Ranges of a corrupt mesh record are checked before the geometry of the mesh is allocated
+static bool test_stream_mesh_corrupt_ranges()
+{
+	cxmf::SaveOptions options;
+	options.level = cxmf::CompressionLevel::NONE;
+
+	const std::vector<uint8_t> source = save_to_memory(*make_static_model(256), options);
+	CHECK(!source.empty());
+
+	const size_t fields[] = {offsetof(cxmf::MeshRecord, vertexCount), offsetof(cxmf::MeshRecord, meshletCount),
+							 offsetof(cxmf::MeshRecord, meshletVertexOffset)};
+	for (const size_t field : fields)
+	{
+		std::vector<uint8_t> file = source;
+		const SectionEntry* const meshes = find_section(file, SECTION_MESHES);
+		CHECK(meshes && meshes->encoding == ENCODING_RAW && meshes->size == sizeof(cxmf::MeshRecord));
+
+		const uint32_t value = 0x7FFFFFFF;
+		std::memcpy(file.data() + meshes->offset + field, &value, sizeof(value));
+
+		SilentLogger logger;
+		const std::unique_ptr<cxmf::ModelStream> stream(cxmf::OpenStreamFromMemory(file.data(), file.size(), cxmf::LoadOptions(), &logger));
+		CHECK(stream);
+
+		cxmf::MeshGeometry geometry;
+		CHECK(!stream->LoadMesh(0, geometry, &logger));
+	}
+	return true;
+}
+// Models load from buffers at any address, views need 8-byte alignment since their sections are used in place
+static bool test_unaligned_buffers()
+{
+	cxmf::SaveOptions options;
+	options.level = cxmf::CompressionLevel::NONE;
+
+	const std::unique_ptr<cxmf::StaticModel> model = make_static_model(256);
+	const std::vector<uint8_t> file = save_to_memory(*model, options);
+	CHECK(!file.empty());
+
+	// Heap blocks are aligned to 16 bytes, so the copy lies at exactly the offset alignment
+	for (const size_t offset : {size_t(1), size_t(4), size_t(8)})
+	{
+		std::vector<uint8_t> buffer(offset + file.size());
+		std::memcpy(buffer.data() + offset, file.data(), file.size());
+		const uint8_t* const data = buffer.data() + offset;
+
+		SilentLogger logger;
+		const std::unique_ptr<cxmf::Model> loaded(cxmf::LoadFromMemory(data, file.size(), &logger));
+		CHECK(loaded && loaded->StaticModelCast() && loaded->StaticModelCast()->vertices.size() == model->vertices.size());
+
+		cxmf::ModelInfo info;
+		CHECK(cxmf::ProbeMemory(data, file.size(), info, &logger) && info.meshes.size() == 1);
+
+		const std::unique_ptr<cxmf::ModelStream> stream(cxmf::OpenStreamFromMemory(data, file.size(), cxmf::LoadOptions(), &logger));
+		cxmf::MeshGeometry geometry;
+		CHECK(stream && stream->LoadMesh(0, geometry, &logger) && geometry.vertices.size() == model->vertices.size());
+
+		const std::unique_ptr<cxmf::ModelView> view(cxmf::OpenViewFromMemory(data, file.size(), &logger));
+		CHECK(!view == (offset % 8 != 0));
+	}
+	return true;
+}
+
+// Flags of material records are bytes, any nonzero value loads as set
+static bool test_material_flag_bytes()
+{
+	cxmf::SaveOptions options;
+	options.level = cxmf::CompressionLevel::NONE;
+
+	const std::unique_ptr<cxmf::StaticModel> model = make_static_model(256);
+	cxmf::Material& material = model->materials.emplace_back();
+	std::memset(material.baseColorFactor, 0, sizeof(material.baseColorFactor));
+	std::memset(material.emissiveFactor, 0, sizeof(material.emissiveFactor));
+	material.name = "material";
+	material.roughnessFactor = 1.0F;
+	material.metallicFactor = 0.0F;
+	material.ambientOcclusionFactor = 1.0F;
+	material.textureIndex = cxmf::INVALID_INDEX;
+	material.alphaMode = cxmf::Material::AlphaMode::OPAQUE;
+	material.alphaCutoff = 0.5F;
+	material.doubleSided = false;
+	material.shadeless = true;
+	model->meshes[0].materialIndex = 0;
+
+	std::vector<uint8_t> file = save_to_memory(*model, options);
+	const SectionEntry* const materials = find_section(file, SECTION_MATERIALS);
+	CHECK(materials && materials->encoding == ENCODING_RAW && materials->size == sizeof(cxmf::MaterialRecord));
+
+	uint8_t* const record = file.data() + materials->offset;
+	CHECK(record[offsetof(cxmf::MaterialRecord, doubleSided)] == 0 && record[offsetof(cxmf::MaterialRecord, shadeless)] == 1);
+	record[offsetof(cxmf::MaterialRecord, doubleSided)] = 0xFF;
+
+	SilentLogger logger;
+	const std::unique_ptr<cxmf::Model> loaded(cxmf::LoadFromMemory(file.data(), file.size(), &logger));
+	CHECK(loaded && loaded->materials.size() == 1);
+	CHECK(loaded->materials[0].doubleSided && loaded->materials[0].shadeless);
+	return true;
+}
+
+// The same batches stored as 16-bit indices take half the section and load back into the 16-bit arrays
+static bool test_indices16()
+{
+	const std::unique_ptr<cxmf::StaticModel> model = make_static_model(258);
+	for (uint32_t i = 0; i < 258; ++i) model->indices.push_back(257 - i);
+	model->indexBatches.push_back({0, 258, 0});
+	model->meshes[0].indexBatchOffset = 0;
+	model->meshes[0].indexBatchCount = 1;
+
+	cxmf::SaveOptions options;
+	options.level = cxmf::CompressionLevel::NONE;
+	std::vector<uint8_t> file32 = save_to_memory(*model, options);
+	const SectionEntry* const indices = find_section(file32, SECTION_INDICES);
+	CHECK(indices && indices->baseSize == 258 * sizeof(uint32_t));
+
+	model->indices16.assign(model->indices.begin(), model->indices.end());
+	SilentLogger logger;
+	MemoryOutputStream rejected;
+	CHECK(!cxmf::SaveToStream(*model, rejected, options, &logger));
+	model->indices.clear();
+
+	std::vector<uint8_t> file16 = save_to_memory(*model, options);
+	const SectionEntry* const indices16 = find_section(file16, SECTION_INDICES16);
+	CHECK(indices16 && indices16->baseSize * 2 == indices->baseSize);
+	CHECK(find_section(file16, SECTION_INDICES)->baseSize == 0);
+
+	const std::unique_ptr<cxmf::ModelView> view(cxmf::OpenViewFromMemory(file16.data(), file16.size(), &logger));
+	CHECK(view && view->GetIndices().empty());
+	CHECK(std::equal(view->GetIndices16().begin(), view->GetIndices16().end(), model->indices16.begin(), model->indices16.end()));
+
+	for (const bool encodeGeometry : {false, true})
+	{
+		options.level = cxmf::CompressionLevel::DEFAULT;
+		options.encodeGeometry = encodeGeometry;
+		const std::vector<uint8_t> file = save_to_memory(*model, options);
+		CHECK(!file.empty());
+
+		const std::unique_ptr<cxmf::Model> loaded(cxmf::LoadFromMemory(file.data(), file.size(), &logger));
+		CHECK(loaded && loaded->indices.empty() && loaded->indices16.size() == model->indices16.size());
+
+		MemoryInputStream stream(file);
+		const std::unique_ptr<cxmf::Model> streamed(cxmf::LoadFromStream(stream, &logger));
+		CHECK(streamed && streamed->indices16.size() == model->indices16.size());
+
+		const std::unique_ptr<cxmf::ModelStream> meshes(
+			cxmf::OpenStreamFromMemory(file.data(), file.size(), cxmf::LoadOptions(), &logger));
+		cxmf::MeshGeometry geometry;
+		CHECK(meshes && meshes->GetInfo().indexCount16 == 258 && meshes->LoadMesh(0, geometry, &logger));
+		CHECK(geometry.indices.empty() && geometry.indices16.size() == 258);
+
+		// The index codec may rotate triangles, their winding is kept
+		for (size_t i = 0; i < 258; i += 3)
+		{
+			const uint16_t* const triangle = &geometry.indices16[i];
+			const uint16_t* const expected = &model->indices16[i];
+			CHECK(std::equal(triangle, triangle + 3, expected) || (triangle[0] == expected[1] && triangle[1] == expected[2]) ||
+				  (triangle[0] == expected[2] && triangle[1] == expected[0]));
+		}
+	}
+
+	// Batches address either the 32-bit or the 16-bit indices, a file with both is rejected
+	SectionEntry* const both = find_section(file32, SECTION_INDICES16);
+	CHECK(both && both->baseSize == 0);
+	both->encoding = ENCODING_RAW;
+	both->offset = indices->offset;
+	both->size = 6 * sizeof(uint16_t);
+	both->baseSize = both->size;
+	const std::unique_ptr<cxmf::Model> mixed(cxmf::LoadFromMemory(file32.data(), file32.size(), &logger));
+	CHECK(!mixed);
+	return true;
+}
+
+struct Test
+{
+	const char* name;
+	bool (*function)();
+};
+
+constexpr inline Test TESTS[] = {
+	{"round_trip", test_round_trip},
+	{"codec_zero_element_size", test_codec_zero_element_size},
+	{"stream_corrupt_base_size", test_stream_corrupt_base_size},
+	{"memory_corrupt_base_size", test_memory_corrupt_base_size},
+	{"stream_mesh_corrupt_ranges", test_stream_mesh_corrupt_ranges},
+	{"unaligned_buffers", test_unaligned_buffers},
+	{"material_flag_bytes", test_material_flag_bytes},
+	{"indices16", test_indices16},
+};
+
+int main()
+{
+	uint32_t failedCount = 0;
+	for (const Test& test : TESTS)
+	{
+		const bool isPassed = test.function();
+		std::printf("%s %s\n", isPassed ? "PASS" : "FAIL", test.name);
+		if (!isPassed) ++failedCount;
+	}
+	return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}